@@ -0,0 +1,150 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+/*
+Compares the dispatch strategies (see `maki::dispatch_strategy`) for regions of
+various sizes.
+
+For each region size, two scenarios are measured:
+- "internal action": the active state is the last state of the region and
+  processes the event with an internal action;
+- "transition": the event makes the region go from one state to the next, in
+  a loop.
+
+Build in release mode to get meaningful results.
+*/
+
+#include <maki.hpp>
+#include <chrono>
+#include <cstdio>
+#include <utility>
+
+namespace
+{
+    constexpr auto event_count = 10'000'000;
+
+    struct context
+    {
+        long long tick_count = 0;
+    };
+
+    namespace events
+    {
+        struct tick{};
+        struct next{};
+        struct go_to_last{};
+    }
+
+    template<int Index>
+    inline constexpr auto state = maki::state_mold{}
+        .internal_action_c<events::tick>
+        (
+            [](context& ctx)
+            {
+                ++ctx.tick_count;
+            }
+        )
+    ;
+
+    template<int Index, int StateCount, class TransitionTable>
+    constexpr auto add_transitions(TransitionTable table)
+    {
+        if constexpr(Index == StateCount)
+        {
+            //Explicit copy, as transition tables can't be moved (which
+            //`return table;` would do since C++20)
+            return TransitionTable{table};
+        }
+        else
+        {
+            constexpr auto next_index = (Index + 1) % StateCount;
+            return add_transitions<Index + 1, StateCount>
+            (
+                table
+                    (state<Index>, state<next_index>,      maki::event<events::next>)
+                    (state<Index>, state<StateCount - 1>, maki::event<events::go_to_last>)
+            );
+        }
+    }
+
+    template<int StateCount>
+    constexpr auto transition_table = add_transitions<0, StateCount>
+    (
+        maki::transition_table{}(maki::ini, state<0>)
+    );
+
+    template<int StateCount, maki::dispatch_strategy Strategy>
+    constexpr auto machine_conf = maki::machine_conf{}
+        .context_a<context>()
+        .transition_tables(transition_table<StateCount>)
+        .dispatch_strategy(Strategy)
+    ;
+
+    template<int StateCount, maki::dispatch_strategy Strategy, class Event>
+    double measure(const Event& event, const bool go_to_last)
+    {
+        auto machine = maki::machine<machine_conf<StateCount, Strategy>>{};
+
+        if(go_to_last)
+        {
+            machine.process_event(events::go_to_last{});
+        }
+
+        const auto start_time = std::chrono::steady_clock::now();
+        for(auto i = 0; i < event_count; ++i)
+        {
+            machine.process_event(event);
+        }
+        const auto end_time = std::chrono::steady_clock::now();
+
+        //Make sure the work isn't optimized away
+        if(machine.context().tick_count == -1)
+        {
+            std::puts("");
+        }
+
+        const auto duration = std::chrono::duration<double, std::nano>{end_time - start_time};
+        return duration.count() / event_count;
+    }
+
+    template<int StateCount>
+    void run()
+    {
+        constexpr auto linear = maki::dispatch_strategy::linear;
+        constexpr auto jump_table = maki::dispatch_strategy::jump_table;
+
+        std::printf
+        (
+            "%6d  %-15s  %14.2f  %14.2f\n",
+            StateCount,
+            "internal action",
+            measure<StateCount, linear>(events::tick{}, true),
+            measure<StateCount, jump_table>(events::tick{}, true)
+        );
+
+        std::printf
+        (
+            "%6d  %-15s  %14.2f  %14.2f\n",
+            StateCount,
+            "transition",
+            measure<StateCount, linear>(events::next{}, false),
+            measure<StateCount, jump_table>(events::next{}, false)
+        );
+    }
+
+    template<int... StateCounts>
+    void run_all(std::integer_sequence<int, StateCounts...> /*state_counts*/)
+    {
+        std::printf("%6s  %-15s  %14s  %14s\n", "states", "scenario", "linear (ns)", "jump_table (ns)");
+        (run<StateCounts>(), ...);
+    }
+}
+
+int main()
+{
+    run_all(std::integer_sequence<int, 2, 4, 8, 16, 32, 64>{});
+    return 0;
+}
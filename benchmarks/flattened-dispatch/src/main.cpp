@@ -0,0 +1,139 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+/*
+Measures the effect of `maki::machine_conf::flattened_dispatch()` on a machine
+made of nested composite states.
+
+Every level of the hierarchy is a region made of the composite state of the next
+level (which is active) and a few simple states. The active state of the deepest
+level processes the event with an internal action.
+
+Build in release mode to get meaningful results.
+*/
+
+#include <maki.hpp>
+#include <chrono>
+#include <cstdio>
+
+namespace
+{
+    constexpr auto event_count = 10'000'000;
+    constexpr auto depth = 4;
+
+    struct context
+    {
+        long long tick_count = 0;
+    };
+
+    namespace events
+    {
+        struct tick{};
+        struct leave{};
+    }
+
+    template<int Level, int Index>
+    constexpr auto sibling = maki::state_mold{};
+
+    constexpr auto leaf = maki::state_mold{}
+        .internal_action_c<events::tick>
+        (
+            [](context& ctx)
+            {
+                ++ctx.tick_count;
+            }
+        )
+    ;
+
+    template<int Level>
+    constexpr auto level_transition_table();
+
+    template<int Level>
+    constexpr auto level = maki::state_mold{}
+        .transition_tables(level_transition_table<Level>())
+    ;
+
+    template<int Level>
+    constexpr const auto& child()
+    {
+        if constexpr(Level == depth)
+        {
+            return leaf;
+        }
+        else
+        {
+            return level<Level + 1>;
+        }
+    }
+
+    template<int Level>
+    constexpr auto level_transition_table()
+    {
+        /*
+        The active state is the child. Note that, being the initial state, it's
+        also the first state of the region, which is the best case of the
+        linear strategy.
+        */
+        return maki::transition_table{}
+            (maki::ini,         child<Level>())
+            (child<Level>(),    sibling<Level, 0>, maki::event<events::leave>)
+            (sibling<Level, 0>, sibling<Level, 1>, maki::event<events::tick>)
+            (sibling<Level, 1>, sibling<Level, 2>, maki::event<events::tick>)
+            (sibling<Level, 2>, sibling<Level, 3>, maki::event<events::tick>)
+            (sibling<Level, 3>, child<Level>(),    maki::event<events::tick>)
+        ;
+    }
+
+    template<bool Flattened, maki::dispatch_strategy Strategy>
+    constexpr auto machine_conf = maki::machine_conf{}
+        .context_a<context>()
+        .transition_tables(level_transition_table<1>())
+        .flattened_dispatch(Flattened)
+        .dispatch_strategy(Strategy)
+    ;
+
+    template<bool Flattened, maki::dispatch_strategy Strategy>
+    double measure()
+    {
+        auto machine = maki::machine<machine_conf<Flattened, Strategy>>{};
+
+        const auto start_time = std::chrono::steady_clock::now();
+        for(auto i = 0; i < event_count; ++i)
+        {
+            machine.process_event(events::tick{});
+        }
+        const auto end_time = std::chrono::steady_clock::now();
+
+        //Make sure the work isn't optimized away
+        if(machine.context().tick_count != event_count)
+        {
+            std::puts("Unexpected tick count");
+        }
+
+        const auto duration = std::chrono::duration<double, std::nano>{end_time - start_time};
+        return duration.count() / event_count;
+    }
+
+    template<maki::dispatch_strategy Strategy>
+    void run(const char* const strategy_name)
+    {
+        std::printf
+        (
+            "%-10s  %14.2f  %14.2f\n",
+            strategy_name,
+            measure<false, Strategy>(),
+            measure<true, Strategy>()
+        );
+    }
+}
+
+int main()
+{
+    std::printf("%-10s  %14s  %14s\n", "strategy", "default (ns)", "flattened (ns)");
+    run<maki::dispatch_strategy::linear>("linear");
+    run<maki::dispatch_strategy::jump_table>("jump_table");
+    return 0;
+}
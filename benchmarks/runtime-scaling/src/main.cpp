@@ -0,0 +1,163 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+/*
+Measures how the event throughput of `maki::runtime` scales with its number of
+worker threads, from one to the number of hardware threads.
+
+The runtime owns a ring of machines. Each machine is seeded with a few tokens.
+Whenever a machine receives a token, it does some work and passes the token on
+to the next machine of the ring, until the token has made a given number of
+hops. Every machine is therefore both a consumer and a producer of events, as
+in a typical actor system.
+
+Build in release mode to get meaningful results.
+*/
+
+#include <maki.hpp>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <cstdio>
+#include <cstdint>
+
+namespace
+{
+    constexpr auto machine_count = 1024;
+    constexpr auto token_count_per_machine = 8;
+    constexpr auto hop_count = 200;
+    constexpr auto work_iteration_count = 200;
+
+    namespace events
+    {
+        struct token
+        {
+            int remaining_hop_count = 0;
+        };
+    }
+
+    /*
+    We need to define a class that inherits from the machine type, as the
+    context has to refer to the machine type before it's defined.
+    */
+    struct machine_wrapper;
+
+    struct context
+    {
+        std::vector<maki::runtime::handle<machine_wrapper>>* phandles = nullptr;
+        int index = 0;
+        std::uint64_t state = 0;
+    };
+
+    void on_token(context& ctx, const events::token& event);
+
+    constexpr auto on = maki::state_mold{}
+        .internal_action_ce<events::token>(&on_token)
+    ;
+
+    constexpr auto transition_table = maki::transition_table{}
+        (maki::ini, on)
+    ;
+
+    constexpr auto machine_conf = maki::machine_conf{}
+        .transition_tables(transition_table)
+        .context_a<context>()
+        .post_event_enabled(true)
+    ;
+
+    struct machine_wrapper: maki::machine<machine_conf>
+    {
+        using maki::machine<machine_conf>::machine;
+    };
+
+    using handle_t = maki::runtime::handle<machine_wrapper>;
+
+    void on_token(context& ctx, const events::token& event)
+    {
+        //Simulate some work
+        for(auto i = 0; i < work_iteration_count; ++i)
+        {
+            ctx.state = ctx.state * 6364136223846793005ULL + 1442695040888963407ULL;
+        }
+
+        if(event.remaining_hop_count != 0)
+        {
+            const auto next_index = static_cast<std::size_t>((ctx.index + 1) % machine_count);
+            while(!(*ctx.phandles)[next_index].post_event(events::token{event.remaining_hop_count - 1}))
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    //Returns the number of processed events per second
+    double measure(const std::size_t worker_count)
+    {
+        auto handles = std::vector<handle_t>{};
+        auto rt = maki::runtime{worker_count};
+
+        for(auto i = 0; i < machine_count; ++i)
+        {
+            handles.push_back(rt.add_machine<machine_wrapper>(context{&handles, i}));
+        }
+
+        const auto start_time = std::chrono::steady_clock::now();
+        for(auto& hdl: handles)
+        {
+            for(auto i = 0; i < token_count_per_machine; ++i)
+            {
+                while(!hdl.post_event(events::token{hop_count}))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }
+        rt.wait_idle();
+        const auto end_time = std::chrono::steady_clock::now();
+
+        //Make sure the work isn't optimized away
+        auto state = std::uint64_t{0};
+        for(auto& hdl: handles)
+        {
+            state ^= hdl.machine().context().state;
+        }
+        if(state == 1)
+        {
+            std::puts("Unlikely state");
+        }
+
+        constexpr auto event_count = 1.0 * machine_count * token_count_per_machine * (hop_count + 1);
+        const auto duration = std::chrono::duration<double>{end_time - start_time};
+        return event_count / duration.count();
+    }
+}
+
+int main()
+{
+    const auto max_worker_count = std::thread::hardware_concurrency() == 0 ?
+        1 :
+        std::thread::hardware_concurrency()
+    ;
+
+    std::printf("%-8s  %16s  %8s\n", "workers", "events/s", "speedup");
+    auto single_worker_throughput = 0.0;
+    for(auto worker_count = std::size_t{1}; worker_count <= max_worker_count; ++worker_count)
+    {
+        const auto throughput = measure(worker_count);
+        if(worker_count == 1)
+        {
+            single_worker_throughput = throughput;
+        }
+        std::printf
+        (
+            "%-8zu  %16.0f  %8.2f\n",
+            worker_count,
+            throughput,
+            throughput / single_worker_throughput
+        );
+    }
+    return 0;
+}
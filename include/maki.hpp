@@ -15,23 +15,34 @@
 */
 
 #include "maki/action.hpp" //NOLINT misc-include-cleaner
+#include "maki/chrome_trace.hpp" //NOLINT misc-include-cleaner
+#include "maki/coalescing_policy.hpp" //NOLINT misc-include-cleaner
 #include "maki/context.hpp" //NOLINT misc-include-cleaner
+#include "maki/dispatch_strategy.hpp" //NOLINT misc-include-cleaner
 #include "maki/event.hpp" //NOLINT misc-include-cleaner
 #include "maki/event_set.hpp" //NOLINT misc-include-cleaner
 #include "maki/events.hpp" //NOLINT misc-include-cleaner
 #include "maki/fin.hpp" //NOLINT misc-include-cleaner
 #include "maki/guard.hpp" //NOLINT misc-include-cleaner
 #include "maki/ini.hpp" //NOLINT misc-include-cleaner
+#include "maki/latency_profile.hpp" //NOLINT misc-include-cleaner
 #include "maki/machine.hpp" //NOLINT misc-include-cleaner
 #include "maki/machine_conf.hpp" //NOLINT misc-include-cleaner
 #include "maki/machine_ref.hpp" //NOLINT misc-include-cleaner
 #include "maki/machine_ref_conf.hpp" //NOLINT misc-include-cleaner
+#include "maki/metrics_registry.hpp" //NOLINT misc-include-cleaner
 #include "maki/null.hpp" //NOLINT misc-include-cleaner
+#include "maki/overflow_policy.hpp" //NOLINT misc-include-cleaner
 #include "maki/path.hpp" //NOLINT misc-include-cleaner
 #include "maki/region.hpp" //NOLINT misc-include-cleaner
+#include "maki/runtime.hpp" //NOLINT misc-include-cleaner
 #include "maki/state.hpp" //NOLINT misc-include-cleaner
 #include "maki/state_mold.hpp" //NOLINT misc-include-cleaner
 #include "maki/state_set.hpp" //NOLINT misc-include-cleaner
 #include "maki/states.hpp" //NOLINT misc-include-cleaner
+#include "maki/task.hpp" //NOLINT misc-include-cleaner
+#include "maki/timer_service.hpp" //NOLINT misc-include-cleaner
+#include "maki/trace_buffer.hpp" //NOLINT misc-include-cleaner
+#include "maki/trace_decoder.hpp" //NOLINT misc-include-cleaner
 #include "maki/transition_table.hpp" //NOLINT misc-include-cleaner
 #include "maki/version.hpp" //NOLINT misc-include-cleaner
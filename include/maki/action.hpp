@@ -14,6 +14,7 @@
 
 #include "detail/signature_macros.hpp"
 #include "detail/call.hpp"
+#include "task.hpp"
 #include "null.hpp"
 
 namespace maki
@@ -121,12 +122,19 @@ namespace detail
         const Event& event
     )
     {
-        call_callable<action_signature, Action::signature>
+        call_maybe_async_action
         (
-            act.callable,
-            ctx,
             mach,
-            event
+            [&]
+            {
+                return call_callable<action_signature, Action::signature>
+                (
+                    act.callable,
+                    ctx,
+                    mach,
+                    event
+                );
+            }
         );
     }
 }
@@ -0,0 +1,83 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+/**
+@file
+@brief Defines the maki::write_chrome_trace() and
+maki::write_chrome_trace_file() functions
+*/
+
+#ifndef MAKI_CHROME_TRACE_HPP
+#define MAKI_CHROME_TRACE_HPP
+
+#include "detail/chrome_trace.hpp"
+#include "trace_decoder.hpp"
+#include "trace_buffer.hpp"
+#include <fstream>
+#include <ios>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace maki
+{
+
+/**
+@brief Writes the given trace records (see `maki::machine_conf::tracing()`) as
+a timeline, in the JSON trace event format of Chrome, which can be opened by
+trace viewers such as Perfetto or `chrome://tracing`.
+
+The records can come from any number of machines (which `decoder` must know
+of, see `maki::trace_decoder::add_machine()`) and from any number of
+`maki::trace_buffer` objects, in any order.
+
+Every machine appears as a process named `machine#<machine id>`, made of the
+following tracks:
+- one track per region, named after the path of the region (see
+`maki::region::path()`), where every active state appears as a slice, from its
+entry to its exit, labelled with the event that caused its entry;
+- an `events` track, where every processed event appears as an instant marker,
+and every drain of the run-to-completion queue appears as a slice.
+
+Slices whose beginning (or end) isn't part of the records begin at the first
+record (or end at the last record).
+*/
+inline void write_chrome_trace
+(
+    std::ostream& stream,
+    const trace_decoder& decoder,
+    const std::vector<trace_record>& records
+)
+{
+    detail::chrome_trace_export::write(stream, decoder, records);
+}
+
+/**
+@brief Like `maki::write_chrome_trace()`, but writes into the file at
+`file_path`, which is overwritten if it exists.
+@return `true` on success
+*/
+inline bool write_chrome_trace_file
+(
+    const std::string& file_path,
+    const trace_decoder& decoder,
+    const std::vector<trace_record>& records
+)
+{
+    auto stream = std::ofstream{file_path, std::ios::binary | std::ios::trunc};
+    if(!stream)
+    {
+        return false;
+    }
+
+    write_chrome_trace(stream, decoder, records);
+    stream.close();
+    return !stream.fail();
+}
+
+} //namespace
+
+#endif
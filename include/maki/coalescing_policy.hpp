@@ -0,0 +1,40 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+/**
+@file
+@brief Defines the maki::coalescing_policy enum
+*/
+
+#ifndef MAKI_COALESCING_POLICY_HPP
+#define MAKI_COALESCING_POLICY_HPP
+
+namespace maki
+{
+
+/**
+@brief What a machine does with an event that is queued while an event of the
+same type is already pending.
+
+@see maki::machine_conf::coalesce()
+*/
+enum class coalescing_policy: char
+{
+    /**
+    The new event replaces the pending event, which keeps its position in the
+    queue.
+    */
+    keep_latest,
+
+    /**
+    The new event is dropped.
+    */
+    keep_oldest
+};
+
+} //namespace
+
+#endif
@@ -0,0 +1,183 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#ifndef MAKI_DETAIL_ASYNC_ACTIONS_HPP
+#define MAKI_DETAIL_ASYNC_ACTIONS_HPP
+
+#include "event_action.hpp"
+#include "region_list.hpp"
+#include "type_list.hpp"
+#include "friendly_impl.hpp"
+#include "mix.hpp"
+#include "tuple.hpp"
+#include "../action.hpp"
+#include "../guard.hpp"
+#include "../transition_table.hpp"
+#include "../task.hpp"
+#include <type_traits>
+
+/*
+Utilities for knowing, at compile time, whether any action of a machine is
+asynchronous (i.e. returns a `maki::task`), so that machines without such
+actions don't pay for them.
+
+The return type of an action is read from the declaration of its callable,
+without instantiating it. Since a coroutine can't have a deduced return type,
+any asynchronous action declares `maki::task` as its return type. Generic
+callables (e.g. lambdas taking `auto&`) can't be inspected without being
+instantiated, though, which isn't possible while the type of the machine is
+incomplete. They're therefore assumed to be synchronous (see
+`maki::machine_conf::async_actions_enabled()`).
+*/
+
+namespace maki::detail
+{
+
+namespace async_actions_detail
+{
+    template<class MemberFunctionPtr>
+    struct member_function_result;
+
+    template<class R, class C, class... Args>
+    struct member_function_result<R(C::*)(Args...)>
+    {
+        using type = R;
+    };
+
+    template<class R, class C, class... Args>
+    struct member_function_result<R(C::*)(Args...) const>
+    {
+        using type = R;
+    };
+
+    template<class R, class C, class... Args>
+    struct member_function_result<R(C::*)(Args...) noexcept>
+    {
+        using type = R;
+    };
+
+    template<class R, class C, class... Args>
+    struct member_function_result<R(C::*)(Args...) const noexcept>
+    {
+        using type = R;
+    };
+
+    //`void` if the return type can't be known without instantiating the
+    //callable
+    template<class Callable, class = void>
+    struct declared_result
+    {
+        using type = void;
+    };
+
+    template<class Callable>
+    struct declared_result<Callable, std::void_t<decltype(&Callable::operator())>>
+    {
+        using type = typename member_function_result<decltype(&Callable::operator())>::type;
+    };
+
+    template<class R, class... Args>
+    struct declared_result<R(*)(Args...)>
+    {
+        using type = R;
+    };
+
+    template<class R, class... Args>
+    struct declared_result<R(*)(Args...) noexcept>
+    {
+        using type = R;
+    };
+
+    //Whether `T` (an action, a transition, or a mix or tuple of them) holds
+    //an asynchronous action
+    template<class T>
+    constexpr bool holds_async_action_v = false;
+
+    template<class EventTypeSet, class Action, action_signature Sig>
+    constexpr bool holds_async_action_v<event_action<EventTypeSet, Action, Sig>> =
+        is_task_v<typename declared_result<Action>::type>
+    ;
+
+    template
+    <
+        class SourceStateMold,
+        class TargetStateMold,
+        class Event,
+        action_signature ActionSignature,
+        class ActionCallable,
+        guard_signature GuardSignature,
+        class GuardCallable
+    >
+    constexpr bool holds_async_action_v
+    <
+        transition
+        <
+            SourceStateMold,
+            TargetStateMold,
+            Event,
+            ActionSignature,
+            ActionCallable,
+            GuardSignature,
+            GuardCallable
+        >
+    > = is_task_v<typename declared_result<ActionCallable>::type>;
+
+    template<class... Ts>
+    constexpr bool holds_async_action_v<mix<Ts...>> = (holds_async_action_v<Ts> || ...);
+
+    template<class... Ts>
+    constexpr bool holds_async_action_v<tuple<Ts...>> = (holds_async_action_v<Ts> || ...);
+
+    template<class StateIdConstant>
+    constexpr bool state_has_async_actions()
+    {
+        using option_set_type = std::decay_t<decltype(impl_of(*StateIdConstant::value))>;
+        return
+            holds_async_action_v<std::decay_t<decltype(option_set_type::entry_actions)>> ||
+            holds_async_action_v<std::decay_t<decltype(option_set_type::internal_actions)>> ||
+            holds_async_action_v<std::decay_t<decltype(option_set_type::exit_actions)>>
+        ;
+    }
+
+    template<class StateIdConstantList>
+    constexpr bool states_have_async_actions_v = false;
+
+    template<class... StateIdConstants>
+    constexpr bool states_have_async_actions_v<type_list_t<StateIdConstants...>> =
+        (state_has_async_actions<StateIdConstants>() || ...)
+    ;
+
+    template<class Region>
+    constexpr bool region_has_async_actions_v =
+        holds_async_action_v<impl_of_t<typename Region::transition_table_type>> ||
+        states_have_async_actions_v<typename Region::state_id_constant_list_0>
+    ;
+
+    template<class RegionList>
+    constexpr bool regions_have_async_actions_v = false;
+
+    template<class... Regions>
+    constexpr bool regions_have_async_actions_v<type_list_t<Regions...>> =
+        (region_has_async_actions_v<Regions> || ...)
+    ;
+}
+
+/*
+Whether any action (including entry, internal and exit actions, and
+pre/post-processing hooks) of the machine defined by `Conf` and whose root
+composite state implementation is `RootImpl` is known to return a
+`maki::task`.
+*/
+template<class RootImpl, const auto& Conf>
+constexpr bool has_async_actions_v =
+    async_actions_detail::regions_have_async_actions_v<region_list_t<RootImpl>> ||
+    async_actions_detail::holds_async_action_v<std::decay_t<decltype(impl_of(Conf).pre_processing_hooks)>> ||
+    async_actions_detail::holds_async_action_v<std::decay_t<decltype(impl_of(Conf).post_processing_hooks)>>
+;
+
+} //namespace
+
+#endif
@@ -0,0 +1,105 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#ifndef MAKI_DETAIL_BITSET_HPP
+#define MAKI_DETAIL_BITSET_HPP
+
+#include <cstdint>
+#include <cstddef>
+
+namespace maki::detail
+{
+
+/*
+A minimal, `constexpr`-friendly equivalent of `std::bitset`.
+*/
+template<int Size>
+class bitset
+{
+public:
+    static constexpr auto size = Size;
+
+    constexpr void set(const int index)
+    {
+        words_[word_index(index)] |= bit_mask(index); //NOLINT
+    }
+
+    [[nodiscard]] constexpr bool test(const int index) const
+    {
+        return (words_[word_index(index)] & bit_mask(index)) != 0; //NOLINT
+    }
+
+    [[nodiscard]] constexpr bool none() const
+    {
+        for(const auto word: words_)
+        {
+            if(word != 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    //Index of the first set bit, or `size` if none.
+    [[nodiscard]] constexpr int first() const
+    {
+        for(auto i = 0; i < size; ++i)
+        {
+            if(test(i))
+            {
+                return i;
+            }
+        }
+        return size;
+    }
+
+    //Index of the last set bit, or -1 if none.
+    [[nodiscard]] constexpr int last() const
+    {
+        for(auto i = size - 1; i >= 0; --i)
+        {
+            if(test(i))
+            {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    //Whether the set bits (if any) form a single contiguous range.
+    [[nodiscard]] constexpr bool contiguous() const
+    {
+        for(auto i = first(); i <= last(); ++i)
+        {
+            if(!test(i))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    static constexpr auto word_size = 64;
+    static constexpr auto word_count = static_cast<std::size_t>(Size == 0 ? 1 : (Size + word_size - 1) / word_size);
+
+    static constexpr std::size_t word_index(const int index)
+    {
+        return static_cast<std::size_t>(index / word_size);
+    }
+
+    static constexpr std::uint64_t bit_mask(const int index)
+    {
+        return std::uint64_t{1} << (index % word_size);
+    }
+
+    std::uint64_t words_[word_count] = {}; //NOLINT
+};
+
+} //namespace
+
+#endif
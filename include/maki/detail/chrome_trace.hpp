@@ -0,0 +1,340 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#ifndef MAKI_DETAIL_CHROME_TRACE_HPP
+#define MAKI_DETAIL_CHROME_TRACE_HPP
+
+#include "trace.hpp"
+#include "../trace_decoder.hpp"
+#include "../trace_buffer.hpp"
+#include <algorithm>
+#include <iterator>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+namespace maki::detail
+{
+
+inline void write_chrome_trace_string(std::ostream& stream, const std::string_view str)
+{
+    stream << '"';
+    for(const auto c: str)
+    {
+        switch(c)
+        {
+            case '"':
+                stream << "\\\"";
+                break;
+            case '\\':
+                stream << "\\\\";
+                break;
+            case '\n':
+                stream << "\\n";
+                break;
+            case '\r':
+                stream << "\\r";
+                break;
+            case '\t':
+                stream << "\\t";
+                break;
+            default:
+                if(static_cast<unsigned char>(c) < 0x20U)
+                {
+                    constexpr auto digits = std::string_view{"0123456789abcdef"};
+                    const auto uc = static_cast<unsigned char>(c);
+                    stream << "\\u00" << digits[uc >> 4U] << digits[uc & 0xFU];
+                }
+                else
+                {
+                    stream << c;
+                }
+                break;
+        }
+    }
+    stream << '"';
+}
+
+//Writes a number of nanoseconds as a number of microseconds
+inline void write_chrome_trace_time(std::ostream& stream, const std::uint64_t ns)
+{
+    const auto fraction = ns % 1000U;
+    stream << ns / 1000U << '.' << fraction / 100U << fraction / 10U % 10U << fraction % 10U;
+}
+
+/*
+Turns trace records into the JSON object format of the trace event format
+of Chrome, as understood by chrome://tracing and Perfetto.
+
+Every machine is a process, whose identifier is the machine identifier. Within
+a process:
+- thread 0 holds the processed events (as instant events) and the drains of the
+  run-to-completion queue (as complete events);
+- thread N holds the active states (as complete events) of the region of index
+  N - 1, and is named after the path of that region.
+*/
+struct chrome_trace_export
+{
+    static void write
+    (
+        std::ostream& stream,
+        const trace_decoder& decoder,
+        const std::vector<trace_record>& records
+    )
+    {
+        /*
+        Records may come from several buffers (one per thread), and must
+        therefore be sorted to be paired.
+        */
+        auto sorted_records = records;
+        std::stable_sort
+        (
+            sorted_records.begin(),
+            sorted_records.end(),
+            [](const trace_record& lhs, const trace_record& rhs)
+            {
+                return lhs.timestamp < rhs.timestamp;
+            }
+        );
+
+        auto self = chrome_trace_export{stream, sorted_records};
+
+        stream << "{\"traceEvents\":[";
+        for(const auto& record: sorted_records)
+        {
+            self.on_record(record, decoder.names(record));
+        }
+        self.close_all_slices();
+        stream << "\n]}\n";
+    }
+
+private:
+    struct track
+    {
+        std::uint32_t machine_id;
+        std::uint32_t thread_id;
+    };
+
+    //A state that has been entered (or a drain that has begun) but hasn't
+    //been exited (or hasn't ended) yet
+    struct open_slice
+    {
+        std::uint32_t machine_id;
+        std::uint32_t thread_id;
+        std::uint64_t begin_timestamp;
+        std::string name;
+        std::string event_type;
+    };
+
+    static constexpr auto event_thread_id = std::uint32_t{0};
+
+    chrome_trace_export(std::ostream& stream, const std::vector<trace_record>& sorted_records):
+        stream_(stream)
+    {
+        if(!sorted_records.empty())
+        {
+            begin_timestamp_ = sorted_records.front().timestamp;
+            end_timestamp_ = sorted_records.back().timestamp;
+        }
+    }
+
+    static bool is_state_index(const std::uint16_t index)
+    {
+        return index != trace_record::none_index && index != trace_record::final_index;
+    }
+
+    void on_record(const trace_record& record, const trace_record_names& names)
+    {
+        switch(record.kind)
+        {
+            case trace_record_kind::external_transition:
+            {
+                const auto thread_id = static_cast<std::uint32_t>(record.region_index) + 1U;
+                declare_track(record.machine_id, thread_id, names.region_path);
+
+                if(!close_slice(record.machine_id, thread_id, record.timestamp))
+                {
+                    /*
+                    The entry of the source state has been overwritten in the
+                    ring buffer (or has happened while recording was paused).
+                    */
+                    if(is_state_index(record.source_state_index))
+                    {
+                        write_slice
+                        (
+                            "state",
+                            open_slice{record.machine_id, thread_id, begin_timestamp_, names.source_state, {}},
+                            record.timestamp
+                        );
+                    }
+                }
+
+                if(is_state_index(record.target_state_index))
+                {
+                    open_slices_.push_back
+                    (
+                        open_slice{record.machine_id, thread_id, record.timestamp, names.target_state, names.event_type}
+                    );
+                }
+                break;
+            }
+            case trace_record_kind::event:
+                declare_track(record.machine_id, event_thread_id, "events");
+                write_instant(record, names.event_type);
+                break;
+            case trace_record_kind::rtc_drain_begin:
+                declare_track(record.machine_id, event_thread_id, "events");
+                open_slices_.push_back
+                (
+                    open_slice{record.machine_id, event_thread_id, record.timestamp, "rtc queue drain", {}}
+                );
+                break;
+            case trace_record_kind::rtc_drain_end:
+                close_slice(record.machine_id, event_thread_id, record.timestamp);
+                break;
+        }
+    }
+
+    //Closes the most recently opened slice of the given track, if any
+    bool close_slice
+    (
+        const std::uint32_t machine_id,
+        const std::uint32_t thread_id,
+        const std::uint64_t end_timestamp
+    )
+    {
+        const auto it = std::find_if
+        (
+            open_slices_.rbegin(),
+            open_slices_.rend(),
+            [&](const open_slice& slice)
+            {
+                return slice.machine_id == machine_id && slice.thread_id == thread_id;
+            }
+        );
+
+        if(it == open_slices_.rend())
+        {
+            return false;
+        }
+
+        write_slice(thread_id == event_thread_id ? "rtc" : "state", *it, end_timestamp);
+        open_slices_.erase(std::next(it).base());
+        return true;
+    }
+
+    //Closes the slices that are still open at the end of the trace
+    void close_all_slices()
+    {
+        for(const auto& slice: open_slices_)
+        {
+            write_slice(slice.thread_id == event_thread_id ? "rtc" : "state", slice, end_timestamp_);
+        }
+        open_slices_.clear();
+    }
+
+    void declare_track
+    (
+        const std::uint32_t machine_id,
+        const std::uint32_t thread_id,
+        const std::string_view name
+    )
+    {
+        const auto machine_known = std::any_of
+        (
+            tracks_.begin(),
+            tracks_.end(),
+            [&](const track& trk)
+            {
+                return trk.machine_id == machine_id;
+            }
+        );
+
+        if(!machine_known)
+        {
+            begin_event();
+            stream_ << R"({"name":"process_name","ph":"M","pid":)" << machine_id;
+            stream_ << R"(,"tid":0,"args":{"name":"machine#)" << machine_id << "\"}}";
+        }
+        else
+        {
+            const auto track_known = std::any_of
+            (
+                tracks_.begin(),
+                tracks_.end(),
+                [&](const track& trk)
+                {
+                    return trk.machine_id == machine_id && trk.thread_id == thread_id;
+                }
+            );
+
+            if(track_known)
+            {
+                return;
+            }
+        }
+
+        tracks_.push_back(track{machine_id, thread_id});
+
+        begin_event();
+        stream_ << R"({"name":"thread_name","ph":"M","pid":)" << machine_id << R"(,"tid":)" << thread_id;
+        stream_ << R"(,"args":{"name":)";
+        write_chrome_trace_string(stream_, name);
+        stream_ << "}}";
+
+        begin_event();
+        stream_ << R"({"name":"thread_sort_index","ph":"M","pid":)" << machine_id << R"(,"tid":)" << thread_id;
+        stream_ << R"(,"args":{"sort_index":)" << thread_id << "}}";
+    }
+
+    void write_slice(const std::string_view category, const open_slice& slice, const std::uint64_t end_timestamp)
+    {
+        begin_event();
+        stream_ << R"({"name":)";
+        write_chrome_trace_string(stream_, slice.name);
+        stream_ << R"(,"cat":")" << category << R"(","ph":"X","ts":)";
+        write_chrome_trace_time(stream_, slice.begin_timestamp - begin_timestamp_);
+        stream_ << R"(,"dur":)";
+        write_chrome_trace_time(stream_, end_timestamp - slice.begin_timestamp);
+        stream_ << R"(,"pid":)" << slice.machine_id << R"(,"tid":)" << slice.thread_id;
+        if(!slice.event_type.empty())
+        {
+            stream_ << R"(,"args":{"event":)";
+            write_chrome_trace_string(stream_, slice.event_type);
+            stream_ << '}';
+        }
+        stream_ << '}';
+    }
+
+    void write_instant(const trace_record& record, const std::string_view name)
+    {
+        begin_event();
+        stream_ << R"({"name":)";
+        write_chrome_trace_string(stream_, name);
+        stream_ << R"(,"cat":"event","ph":"i","s":"t","ts":)";
+        write_chrome_trace_time(stream_, record.timestamp - begin_timestamp_);
+        stream_ << R"(,"pid":)" << record.machine_id << R"(,"tid":)" << event_thread_id << '}';
+    }
+
+    void begin_event()
+    {
+        stream_ << (first_event_ ? "\n" : ",\n");
+        first_event_ = false;
+    }
+
+    std::ostream& stream_; //NOLINT(cppcoreguidelines-avoid-const-or-ref-data-members)
+    std::uint64_t begin_timestamp_ = 0;
+    std::uint64_t end_timestamp_ = 0;
+    bool first_event_ = true;
+    std::vector<track> tracks_;
+    std::vector<open_slice> open_slices_;
+};
+
+} //namespace
+
+#endif
@@ -18,4 +18,14 @@ tests.
 #define MAKI_DETAIL_COMPILER_GCC 0 //NOLINT cppcoreguidelines-macro-usage
 #endif
 
+/*
+`MAKI_DETAIL_COROUTINES`
+Whether the compiler supports C++20 coroutines.
+*/
+#ifdef __cpp_impl_coroutine
+#define MAKI_DETAIL_COROUTINES 1 //NOLINT cppcoreguidelines-macro-usage
+#else
+#define MAKI_DETAIL_COROUTINES 0 //NOLINT cppcoreguidelines-macro-usage
+#endif
+
 #endif
@@ -11,6 +11,7 @@
 #include "type_set.hpp"
 #include "tlu/find_if.hpp"
 #include "../action.hpp"
+#include "../task.hpp"
 #include <type_traits>
 #include <utility>
 
@@ -73,13 +74,20 @@ void call_event_action
     [[maybe_unused]] ExtraArgs&&... extra_args
 )
 {
-    call_callable<action_signature, EventActionPtr->sig>
+    call_maybe_async_action
     (
-        EventActionPtr->action,
-        ctx,
         mach,
-        event,
-        std::forward<ExtraArgs>(extra_args)...
+        [&]
+        {
+            return call_callable<action_signature, EventActionPtr->sig>
+            (
+                EventActionPtr->action,
+                ctx,
+                mach,
+                event,
+                std::forward<ExtraArgs>(extra_args)...
+            );
+        }
     );
 }
 
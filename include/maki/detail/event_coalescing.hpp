@@ -0,0 +1,151 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#ifndef MAKI_DETAIL_EVENT_COALESCING_HPP
+#define MAKI_DETAIL_EVENT_COALESCING_HPP
+
+#include "mix.hpp"
+#include "type_set.hpp"
+#include "../coalescing_policy.hpp"
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace maki::detail
+{
+
+/*
+The coalescing of the pending events of type `Event`, given to
+`maki::machine_conf::coalesce()`. `merge(pending_event, new_event)` merges the
+new event into the pending one.
+*/
+template<class Event, class Merge>
+struct event_coalescing
+{
+    using event_type = Event;
+
+    Merge merge;
+};
+
+//The merge function of a `coalescing_policy`
+struct coalescing_policy_merge
+{
+    template<class Event>
+    void operator()(Event& pending_event, const Event& new_event) const
+    {
+        if(policy == coalescing_policy::keep_latest)
+        {
+            pending_event = new_event;
+        }
+    }
+
+    coalescing_policy policy;
+};
+
+//Finds the `event_coalescing` of `Event` among the bases of a `mix`
+template<class Event, class Merge>
+constexpr const event_coalescing<Event, Merge>& get_event_coalescing(const event_coalescing<Event, Merge>& coalescing)
+{
+    return coalescing;
+}
+
+template<class Event, class EventCoalescingMix, class = void>
+inline constexpr bool is_coalesced_event_v = false;
+
+template<class Event, class EventCoalescingMix>
+inline constexpr bool is_coalesced_event_v
+<
+    Event,
+    EventCoalescingMix,
+    std::void_t<decltype(get_event_coalescing<Event>(std::declval<const EventCoalescingMix&>()))>
+> = true;
+
+/*
+The data that the event queues hold in place of an event of type `Event` that
+is coalesced. The event itself is stored in a `coalesced_event_slot`.
+*/
+template<class Event>
+struct coalesced_event_marker
+{
+};
+
+template<class Event>
+struct coalesced_event_slot
+{
+    std::optional<Event> event;
+};
+
+template<class EventCoalescingMix>
+struct coalesced_event_slot_mix;
+
+template<class... EventCoalescings>
+struct coalesced_event_slot_mix<mix<EventCoalescings...>>
+{
+    using type = mix<coalesced_event_slot<typename EventCoalescings::event_type>...>;
+    using marker_type_set = type_set_inclusion_list
+    <
+        coalesced_event_marker<typename EventCoalescings::event_type>...
+    >;
+};
+
+//The storage of the coalesced events of a queue
+template<class EventCoalescingMix>
+using coalesced_event_slot_mix_t = typename coalesced_event_slot_mix<EventCoalescingMix>::type;
+
+//The set of the `coalesced_event_marker` types
+template<class EventCoalescingMix>
+using coalesced_event_marker_type_set_t = typename coalesced_event_slot_mix<EventCoalescingMix>::marker_type_set;
+
+/*
+Pushes `event` into `queue` by means of `push_marker(marker)`, unless an event
+of the same type is already pending, in which case `event` is merged into it.
+Returns `false` if `push_marker()` does (i.e. if the queue is full).
+*/
+template<const auto& EventCoalescings, class Event, class SlotMix, class PushMarker>
+bool push_coalesced_event(SlotMix& slots, const Event& event, const PushMarker& push_marker)
+{
+    auto& pending_event = get<coalesced_event_slot<Event>>(slots).event;
+    if(pending_event.has_value())
+    {
+        get_event_coalescing<Event>(EventCoalescings).merge(*pending_event, event);
+        return true;
+    }
+
+    /*
+    If the copy of the event throws, the marker is left alone in the queue,
+    and is skipped by `take_coalesced_event()`.
+    */
+    if(!push_marker(coalesced_event_marker<Event>{}))
+    {
+        return false;
+    }
+    pending_event.emplace(event);
+    return true;
+}
+
+//Returns the pending event of type `Event`, if any
+template<class Event, class SlotMix>
+const std::optional<Event>& pending_coalesced_event(const SlotMix& slots)
+{
+    return get<coalesced_event_slot<Event>>(slots).event;
+}
+
+/*
+Moves the pending event of type `Event` out of its slot, so that a new event
+of that type can be queued while it's being processed.
+*/
+template<class Event, class SlotMix>
+std::optional<Event> take_coalesced_event(SlotMix& slots)
+{
+    auto& pending_event = get<coalesced_event_slot<Event>>(slots).event;
+    auto event = std::move(pending_event);
+    pending_event.reset();
+    return event;
+}
+
+} //namespace
+
+#endif
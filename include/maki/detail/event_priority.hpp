@@ -0,0 +1,43 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#ifndef MAKI_DETAIL_EVENT_PRIORITY_HPP
+#define MAKI_DETAIL_EVENT_PRIORITY_HPP
+
+#include "mix.hpp"
+#include <type_traits>
+
+namespace maki::detail
+{
+
+/*
+The priority given to `Event` with `maki::machine_conf::event_priority()`.
+*/
+template<class Event>
+struct event_priority
+{
+    int value = 0;
+};
+
+/*
+Returns the priority given to `Event` in `priorities`, or 0 if there's none.
+*/
+template<class Event, class... Priorities>
+constexpr int event_priority_of(const mix<Priorities...>& priorities)
+{
+    if constexpr((std::is_same_v<Priorities, event_priority<Event>> || ...))
+    {
+        return get<event_priority<Event>>(priorities).value;
+    }
+    else
+    {
+        return 0;
+    }
+}
+
+} //namespace
+
+#endif
@@ -0,0 +1,34 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#ifndef MAKI_DETAIL_EXPIRING_EVENT_HPP
+#define MAKI_DETAIL_EXPIRING_EVENT_HPP
+
+#include <chrono>
+
+namespace maki::detail
+{
+
+/*
+What the event queues of a machine store for an event given to
+`maki::machine::push_event(event, deadline)`. The event is dropped if it's
+dequeued once the deadline is reached.
+*/
+template<class Event>
+struct expiring_event
+{
+    [[nodiscard]] bool expired() const
+    {
+        return std::chrono::steady_clock::now() >= deadline;
+    }
+
+    Event event;
+    std::chrono::steady_clock::time_point deadline;
+};
+
+} //namespace
+
+#endif
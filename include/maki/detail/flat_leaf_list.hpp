@@ -0,0 +1,224 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#ifndef MAKI_DETAIL_FLAT_LEAF_LIST_HPP
+#define MAKI_DETAIL_FLAT_LEAF_LIST_HPP
+
+#include "type_list.hpp"
+#include "mix.hpp"
+#include "friendly_impl.hpp"
+#include "tlu/apply.hpp"
+#include "tlu/contains.hpp"
+#include "tlu/front.hpp"
+#include <type_traits>
+#include <cstddef>
+
+/*
+Utilities for the flattened dispatch (see
+`maki::machine_conf::flattened_dispatch()`).
+
+The flattened hierarchy of a machine is made of the states that are reachable
+from the root region through composite states made of a single region. The leaf
+states of this hierarchy are the non-composite states and the composite states
+made of several regions.
+*/
+
+namespace maki::detail
+{
+
+inline constexpr auto unknown_flat_leaf_index = -1;
+
+/*
+A leaf state of the flattened hierarchy.
+- `RegionPath` is the `type_list_t` of the `region_impl` types to go through,
+from the root region down to the region that contains the leaf state
+(`Region`).
+- `StatePath` is the `type_list_t` of the state types to go through, from the
+state of the root region down to the leaf state (`State`) itself.
+*/
+template<class RegionPath, class Region, class StatePath, class State>
+struct flat_leaf
+{
+    using region_path = RegionPath;
+    using region_type = Region;
+    using state_path = StatePath;
+    using state_type = State;
+};
+
+namespace flat_leaf_list_detail
+{
+    template<class... TypeLists>
+    struct concat
+    {
+        using type = type_list_t<>;
+    };
+
+    template<class... Ts>
+    struct concat<type_list_t<Ts...>>
+    {
+        using type = type_list_t<Ts...>;
+    };
+
+    template<class... Ts, class... Us, class... TypeLists>
+    struct concat<type_list_t<Ts...>, type_list_t<Us...>, TypeLists...>
+    {
+        using type = typename concat<type_list_t<Ts..., Us...>, TypeLists...>::type;
+    };
+
+    template<class State>
+    inline constexpr auto is_single_region_composite_v =
+        impl_of(*impl_of_t<State>::identifier).transition_tables.size == 1
+    ;
+
+    template<class RegionPath, class Region, class StatePath>
+    struct of_region;
+
+    template<class RegionPath, class Region, class StatePath, class State, bool IsSingleRegionComposite>
+    struct of_state;
+
+    template<class RegionPath, class Region, class... PathStates, class State>
+    struct of_state<RegionPath, Region, type_list_t<PathStates...>, State, false>
+    {
+        using type = type_list_t
+        <
+            flat_leaf<RegionPath, Region, type_list_t<PathStates..., State>, State>
+        >;
+    };
+
+    template<class... PathRegions, class Region, class... PathStates, class State>
+    struct of_state<type_list_t<PathRegions...>, Region, type_list_t<PathStates...>, State, true>
+    {
+        using subregion_type = impl_of_t
+        <
+            tlu::front_t<typename impl_of_t<State>::region_mix_type>
+        >;
+
+        using type = typename of_region
+        <
+            type_list_t<PathRegions..., subregion_type>,
+            subregion_type,
+            type_list_t<PathStates..., State>
+        >::type;
+    };
+
+    template<class RegionPath, class Region, class StatePath, class StateMix>
+    struct of_state_mix;
+
+    template<class RegionPath, class Region, class StatePath, class... States>
+    struct of_state_mix<RegionPath, Region, StatePath, mix<States...>>
+    {
+        using type = typename concat
+        <
+            typename of_state
+            <
+                RegionPath,
+                Region,
+                StatePath,
+                States,
+                is_single_region_composite_v<States>
+            >::type...
+        >::type;
+    };
+
+    template<class RegionPath, class Region, class StatePath>
+    struct of_region
+    {
+        //Note: `state_id_constant_list_0` doesn't contain `maki::undefined`.
+        using state_mix_type = tlu::apply_t
+        <
+            typename Region::state_id_constant_list_0,
+            Region::template state_id_constant_pack_to_state_mix_t
+        >;
+
+        using type = typename of_state_mix<RegionPath, Region, StatePath, state_mix_type>::type;
+    };
+
+    template<class RegionMix>
+    struct of_region_mix
+    {
+        //Flattening only makes sense for single-region machines.
+        using type = type_list_t<>;
+    };
+
+    template<class Region>
+    struct of_region_mix<mix<Region>>
+    {
+        using type = typename of_region
+        <
+            type_list_t<impl_of_t<Region>>,
+            impl_of_t<Region>,
+            type_list_t<>
+        >::type;
+    };
+}
+
+/*
+The list of the `flat_leaf` types of the machine whose root composite state
+implementation (i.e. `composite_no_context`) is `RootImpl`.
+*/
+template<class RootImpl>
+using flat_leaf_list_t = typename flat_leaf_list_detail::of_region_mix
+<
+    typename RootImpl::region_mix_type
+>::type;
+
+/*
+The index of the `flat_leaf` of `FlatLeafList` whose region type is `Region`
+and whose state type is `State`, or `unknown_flat_leaf_index` if there's no such
+leaf.
+*/
+template<class FlatLeafList, class Region, class State>
+struct flat_leaf_index;
+
+template<class... FlatLeaves, class Region, class State>
+struct flat_leaf_index<type_list_t<FlatLeaves...>, Region, State>
+{
+    static constexpr int make_value()
+    {
+        constexpr bool matches[] = //NOLINT
+        {
+            false, //Avoids zero-size array
+            (
+                std::is_same_v<typename FlatLeaves::region_type, Region> &&
+                std::is_same_v<typename FlatLeaves::state_type, State>
+            )...
+        };
+
+        for(auto i = std::size_t{1}; i < sizeof...(FlatLeaves) + 1; ++i)
+        {
+            if(matches[i]) //NOLINT
+            {
+                return static_cast<int>(i) - 1;
+            }
+        }
+        return unknown_flat_leaf_index;
+    }
+
+    static constexpr auto value = make_value();
+};
+
+template<class FlatLeafList, class Region, class State>
+inline constexpr auto flat_leaf_index_v = flat_leaf_index<FlatLeafList, Region, State>::value;
+
+/*
+Whether `Region` belongs to the flattened hierarchy whose leaves are
+`FlatLeafList`.
+*/
+template<class FlatLeafList, class Region>
+struct flat_leaf_list_contains_region;
+
+template<class... FlatLeaves, class Region>
+struct flat_leaf_list_contains_region<type_list_t<FlatLeaves...>, Region>
+{
+    static constexpr auto value = (tlu::contains_v<typename FlatLeaves::region_path, Region> || ...);
+};
+
+template<class FlatLeafList, class Region>
+inline constexpr auto flat_leaf_list_contains_region_v = flat_leaf_list_contains_region<FlatLeafList, Region>::value;
+
+} //namespace
+
+#endif
@@ -7,150 +7,339 @@
 #ifndef MAKI_DETAIL_FUNCTION_QUEUE_HPP
 #define MAKI_DETAIL_FUNCTION_QUEUE_HPP
 
-#include <queue>
+#include "ring_buffer.hpp"
+#include "type_list.hpp"
+#include "large_data_storage.hpp"
+#include "../null.hpp"
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <cstdint>
 #include <cstddef>
 
 namespace maki::detail
 {
 
+namespace function_queue_detail
+{
+    template<class FunHolder, class Data, class Arg, class = void>
+    struct has_is_ready: std::false_type{};
+
+    template<class FunHolder, class Data, class Arg>
+    struct has_is_ready
+    <
+        FunHolder,
+        Data,
+        Arg,
+        std::void_t<decltype(FunHolder::is_ready(std::declval<const Data&>(), std::declval<Arg>()))>
+    >: std::true_type{};
+
+    template<class FunHolder, class Data, class Arg, class = void>
+    struct has_drop: std::false_type{};
+
+    template<class FunHolder, class Data, class Arg>
+    struct has_drop
+    <
+        FunHolder,
+        Data,
+        Arg,
+        std::void_t<decltype(FunHolder::drop(std::declval<const Data&>(), std::declval<Arg>()))>
+    >: std::true_type{};
+}
+
+/*
+Calls `FunHolder::is_ready(data, arg)` if it exists. Returns `true` otherwise.
+See `function_queue::invoke_or_rotate()`.
+*/
+template<class FunHolder, class Data, class Arg>
+bool fun_holder_is_ready([[maybe_unused]] const Data& data, [[maybe_unused]] Arg arg)
+{
+    if constexpr(function_queue_detail::has_is_ready<FunHolder, Data, Arg>::value)
+    {
+        return FunHolder::is_ready(data, arg);
+    }
+    else
+    {
+        return true;
+    }
+}
+
+/*
+Calls `FunHolder::drop(data, arg)` if it exists.
+See `function_queue::drop_front()`.
+*/
+template<class FunHolder, class Data, class Arg>
+void fun_holder_drop([[maybe_unused]] const Data& data, [[maybe_unused]] Arg arg)
+{
+    if constexpr(function_queue_detail::has_drop<FunHolder, Data, Arg>::value)
+    {
+        FunHolder::drop(data, arg);
+    }
+}
+
 /*
 A kind of std::queue<std::function<bool(Arg)>>, optimized for our needs
+
+The functions are stored in a `ring_buffer`. Once the buffer is large enough
+(see `reserve()`), pushing and popping functions doesn't allocate any memory
+(unless the data given to `push()` doesn't suit the small object
+optimization, in which case it's stored in a `large_data_storage`).
 */
 template
 <
     class Arg,
     std::size_t StaticStorageSize,
-    std::size_t StaticStorageAlignment = alignof(std::max_align_t)
+    std::size_t StaticStorageAlignment = alignof(std::max_align_t),
+    class LargeDataAllocator = null_t,
+    std::size_t LargeDataArenaSize = 0,
+    bool CountsLargeDataAllocations = false
 >
 class function_queue
 {
 public:
+    explicit function_queue(const LargeDataAllocator& large_data_alloc = LargeDataAllocator{}):
+        large_data_storage_(large_data_alloc)
+    {
+    }
+
+    function_queue(const function_queue&) = delete;
+    function_queue(function_queue&&) = delete;
+    function_queue& operator=(const function_queue&) = delete;
+    function_queue& operator=(function_queue&&) = delete;
+
+    ~function_queue()
+    {
+        while(!empty())
+        {
+            slots_.front().reset(large_data_storage_);
+            slots_.pop_front();
+        }
+    }
+
     //Push call to FunHolder::call(data, arg)
     template<class FunHolder, class Data>
     void push(const Data& data)
     {
-        if constexpr(std::is_nothrow_copy_constructible_v<Data>)
+        //If the Data copy constructor throws, the slot is left empty.
+        slots_.next_back().template emplace<Data, FunHolder>(data, large_data_storage_);
+        slots_.commit_back();
+    }
+
+    /*
+    Note: The function is moved out of the buffer before being called, so that
+    it's safe for the function to push new functions into this queue (which
+    can reallocate the buffer).
+    */
+    bool invoke_and_pop(Arg arg)
+    {
+        auto front = slot_guard{large_data_storage_};
+        slots_.front().relocate_to(front.slt);
+        slots_.pop_front();
+        return front.slt.call(arg);
+    }
+
+    /*
+    Like `invoke_and_pop()` if `FunHolder::is_ready(data, arg)` returns `true`
+    (or if FunHolder has no such function). Otherwise, moves the function to
+    the back of the queue without calling it, and returns `false`.
+    */
+    bool invoke_or_rotate(Arg arg)
+    {
+        if(!slots_.front().is_ready(arg))
         {
-            queue_.emplace(&call<Data, FunHolder>, &delete_data<Data>).set_data(data);
+            slots_.rotate();
+            return false;
         }
-        else
-        {
-            /*
-            First make pdelete point to dont_delete_data() (which doesn't do
-            anything) in case the Data copy constructor throws.
-            Once the data is copied, we can safely make pdelete point to
-            delete_data().
-            */
+        return invoke_and_pop(arg);
+    }
 
-            auto& cont = queue_.emplace(&call<Data, FunHolder>);
-            cont.set_data(data);
-            cont.set_delete(&delete_data<Data>);
-        }
+    //Move the front function to the back of the queue, without calling it
+    void rotate()
+    {
+        slots_.rotate();
     }
 
-    bool invoke_and_pop(Arg arg)
+    /*
+    Pops the front function without calling it. Calls
+    `FunHolder::drop(data, arg)` instead, if FunHolder has such a function.
+    */
+    void drop_front(Arg arg)
     {
-        const auto res = queue_.front().call(arg);
-        queue_.pop();
-        return res;
+        auto front = slot_guard{large_data_storage_};
+        slots_.front().relocate_to(front.slt);
+        slots_.pop_front();
+        front.slt.drop(arg);
+    }
+
+    /*
+    Removes the functions pushed by `push<FunHolder>(data)`, where `data` is of
+    any of the types of DataList (a `type_list_t`) and `pred(data)` returns
+    `true`, as if they were dropped by `drop_front()`. Keeps the order of the
+    other functions. Returns the number of removed functions.
+    */
+    template<class FunHolder, class DataList, class Pred>
+    std::size_t remove_if(const Pred& pred, Arg arg)
+    {
+        auto removed_count = std::size_t{0};
+        for(auto count = size(); count != 0; --count)
+        {
+            if(matches<FunHolder>(slots_.front(), pred, DataList{}))
+            {
+                drop_front(arg);
+                ++removed_count;
+            }
+            else
+            {
+                slots_.rotate();
+            }
+        }
+        return removed_count;
     }
 
     void invoke_and_pop_all(Arg arg)
     {
-        while(!queue_.empty())
+        while(!empty())
         {
-            queue_.front().call(arg);
-            queue_.pop();
+            invoke_and_pop(arg);
         }
     }
 
+    //Make sure `capacity` functions can be pushed without any reallocation.
+    void reserve(const std::size_t capacity)
+    {
+        slots_.reserve(capacity);
+    }
+
+    [[nodiscard]] std::size_t capacity() const
+    {
+        return slots_.capacity();
+    }
+
     [[nodiscard]] std::size_t size() const
     {
-        return queue_.size();
+        return slots_.size();
     }
 
     [[nodiscard]] bool empty() const
     {
-        return queue_.empty();
+        return slots_.empty();
+    }
+
+    //The number of data that couldn't be stored in place and have been
+    //allocated (see `large_data_storage::allocation_count()`)
+    [[nodiscard]] std::uint64_t large_data_allocation_count() const
+    {
+        return large_data_storage_.allocation_count();
     }
 
 private:
-    using call_fn_ptr_t = bool (*)(const void*, Arg);
-    using delete_fn_ptr_t = void (*)(const void*);
+    struct slot;
+
+    using large_data_storage_type = large_data_storage<LargeDataAllocator, LargeDataArenaSize, CountsLargeDataAllocations>;
+
+    struct slot_ops
+    {
+        bool (*call)(const void* pdata, Arg arg);
+        bool (*is_ready)(const void* pdata, Arg arg);
+        void (*drop)(const void* pdata, Arg arg);
+        void (*relocate)(slot& from, slot& to) noexcept;
+        void (*destroy)(slot& slt, large_data_storage_type& storage) noexcept;
+    };
 
     /*
     A container for an object of any type, with small object optimization.
 
-    The interface is designed so that the types of the arguments given to
-    queue_.emplace() don't change, whatever FunHolder and Data are.
-    This makes build time shorter and binary smaller.
+    Only objects that can be moved without throwing are stored in the static
+    storage, so that slots can be relocated without throwing.
     */
-    struct data_container
+    struct slot
     {
-        //To be called when Data copy constructor can throw
-        data_container //NOLINT
-        (
-            const call_fn_ptr_t pcall_
-        ):
-            pcall_(pcall_)
-        {
-        }
-
-        //To be called when Data copy constructor cannot throw
-        data_container //NOLINT
-        (
-            const call_fn_ptr_t pcall_,
-            const delete_fn_ptr_t pdelete_
-        ):
-            pcall_(pcall_),
-            pdelete_(pdelete_)
-        {
-        }
-
-        data_container(const data_container&) = delete;
-        data_container(data_container&& other) = delete;
+        slot() = default; //NOLINT(cppcoreguidelines-pro-type-member-init)
 
-        ~data_container()
-        {
-            pdelete_(pdata_);
-        }
+        slot(const slot&) = delete;
+        slot(slot&&) = delete;
+        slot& operator=(const slot&) = delete;
+        slot& operator=(slot&&) = delete;
 
-        void operator=(const data_container&) = delete;
-        void operator=(data_container&& other) = delete;
+        //Note: The slot must have been reset beforehand.
+        ~slot() = default;
 
-        template<class Data>
-        void set_data(const Data& data)
+        template<class Data, class FunHolder>
+        void emplace(const Data& data, large_data_storage_type& storage)
         {
-            //Copy data into the data_container
+            //Copy data into the slot
             if constexpr(suitable_for_static_storage<Data>())
             {
-                pdata_ = new(static_storage_) Data{data}; //NOLINT
+                pdata = new(static_storage) Data{data}; //NOLINT
             }
             else
             {
-                pdata_ = new Data{data}; //NOLINT
+                pdata = const_cast<Data*>(storage.create(data)); //NOLINT
             }
+
+            pops = &ops<Data, FunHolder>;
+        }
+
+        void relocate_to(slot& other) noexcept
+        {
+            pops->relocate(*this, other);
+            other.pops = pops;
+            pops = nullptr;
+        }
+
+        bool call(Arg arg) const
+        {
+            return pops->call(pdata, arg);
+        }
+
+        bool is_ready(Arg arg) const
+        {
+            return pops->is_ready(pdata, arg);
         }
 
-        void set_delete(const delete_fn_ptr_t pdelete)
+        void drop(Arg arg) const
         {
-            pdelete_ = pdelete;
+            pops->drop(pdata, arg);
         }
 
-        bool call(Arg arg)
+        void reset(large_data_storage_type& storage) noexcept
         {
-            return pcall_(pdata_, arg);
+            if(pops != nullptr)
+            {
+                pops->destroy(*this, storage);
+                pops = nullptr;
+            }
         }
 
-    private:
         //Storage for small object optimization, properly aligned for an object
         //whose alignment requirement is less than or equal to
         //StaticStorageAlignment
-        alignas(StaticStorageAlignment) char static_storage_[StaticStorageSize]; //NOLINT
+        alignas(StaticStorageAlignment) char static_storage[StaticStorageSize]; //NOLINT
 
-        void* pdata_; //NOLINT
-        call_fn_ptr_t pcall_ = nullptr;
-        delete_fn_ptr_t pdelete_ = &dont_delete_data;
+        void* pdata = nullptr;
+        const slot_ops* pops = nullptr;
+    };
+
+    //Resets the slot it holds on destruction
+    struct slot_guard
+    {
+        explicit slot_guard(large_data_storage_type& storage):
+            storage(storage)
+        {
+        }
+
+        slot_guard(const slot_guard&) = delete;
+        slot_guard(slot_guard&&) = delete;
+        slot_guard& operator=(const slot_guard&) = delete;
+        slot_guard& operator=(slot_guard&&) = delete;
+
+        ~slot_guard()
+        {
+            slt.reset(storage);
+        }
+
+        large_data_storage_type& storage; //NOLINT(cppcoreguidelines-avoid-const-or-ref-data-members)
+        slot slt;
     };
 
     template<class Data>
@@ -158,10 +347,23 @@ private:
     {
         return
             sizeof(Data) <= StaticStorageSize &&
-            alignof(Data) <= StaticStorageAlignment
+            alignof(Data) <= StaticStorageAlignment &&
+            std::is_nothrow_move_constructible_v<Data>
         ;
     }
 
+    template<class FunHolder, class Pred, class... Datas>
+    static bool matches(const slot& slt, const Pred& pred, type_list_t<Datas...> /*tag*/)
+    {
+        return
+        (
+            (
+                slt.pops == &ops<Datas, FunHolder> &&
+                pred(*reinterpret_cast<const Datas*>(slt.pdata)) //NOLINT
+            ) || ...
+        );
+    }
+
     template<class Data, class FunHolder>
     static bool call(const void* const pdata, Arg arg)
     {
@@ -169,24 +371,60 @@ private:
         return FunHolder::call(data, arg);
     }
 
-    static void dont_delete_data(const void* const /*pdata*/)
+    template<class Data, class FunHolder>
+    static bool is_ready(const void* const pdata, Arg arg)
+    {
+        const Data& data = *reinterpret_cast<const Data*>(pdata); //NOLINT
+        return fun_holder_is_ready<FunHolder, Data, Arg>(data, arg);
+    }
+
+    template<class Data, class FunHolder>
+    static void drop(const void* const pdata, Arg arg)
+    {
+        const Data& data = *reinterpret_cast<const Data*>(pdata); //NOLINT
+        fun_holder_drop<FunHolder, Data, Arg>(data, arg);
+    }
+
+    template<class Data>
+    static void relocate(slot& from, slot& to) noexcept
     {
+        if constexpr(suitable_for_static_storage<Data>())
+        {
+            auto& data = *reinterpret_cast<Data*>(from.pdata); //NOLINT
+            to.pdata = new(to.static_storage) Data{std::move(data)}; //NOLINT
+            data.~Data();
+        }
+        else
+        {
+            to.pdata = from.pdata;
+        }
     }
 
     template<class Data>
-    static void delete_data(const void* const pdata)
+    static void destroy(slot& slt, large_data_storage_type& storage) noexcept
     {
         if constexpr(suitable_for_static_storage<Data>())
         {
-            reinterpret_cast<const Data*>(pdata)->~Data(); //NOLINT
+            reinterpret_cast<const Data*>(slt.pdata)->~Data(); //NOLINT
         }
         else
         {
-            delete reinterpret_cast<const Data*>(pdata); //NOLINT
+            storage.destroy(reinterpret_cast<const Data*>(slt.pdata)); //NOLINT
         }
     }
 
-    std::queue<data_container> queue_;
+    template<class Data, class FunHolder>
+    static constexpr auto ops = slot_ops
+    {
+        &call<Data, FunHolder>,
+        &is_ready<Data, FunHolder>,
+        &drop<Data, FunHolder>,
+        &relocate<Data>,
+        &destroy<Data>
+    };
+
+    ring_buffer<slot> slots_;
+    large_data_storage_type large_data_storage_;
 };
 
 } //namespace
@@ -0,0 +1,229 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#ifndef MAKI_DETAIL_LARGE_DATA_STORAGE_HPP
+#define MAKI_DETAIL_LARGE_DATA_STORAGE_HPP
+
+#include "../null.hpp"
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <cstdint>
+#include <cstddef>
+
+namespace maki::detail
+{
+
+/*
+The count of the data allocated by a `large_data_storage` without its arena.
+Empty if Enabled is false, so that it takes no space as a base class (a
+member would take the size of the pointer that follows it).
+*/
+template<bool Enabled>
+struct large_data_allocation_counter
+{
+    std::uint64_t count = 0;
+};
+
+template<>
+struct large_data_allocation_counter<false>
+{
+};
+
+/*
+The storage of the data that the function queues can't store in place (see
+`maki::machine_conf::large_event_allocator()` and
+`maki::machine_conf::large_event_arena_size()`).
+
+Data is allocated by Allocator, or with a plain `new` if Allocator is `null_t`.
+
+If ArenaSize isn't 0, data is first bump-allocated from an arena of ArenaSize
+bytes (which itself is allocated on first use and kept until destruction).
+Deallocating from the arena is a no-op, except that the arena is reset
+whenever the last data it holds is deallocated. Data that doesn't fit into the
+remaining space of the arena is allocated as if there were no arena.
+
+If CountAllocations is true, the data allocated without the arena is counted
+(see `allocation_count()`).
+*/
+template<class Allocator, std::size_t ArenaSize, bool CountAllocations = false>
+class large_data_storage: private large_data_allocation_counter<CountAllocations>
+{
+public:
+    explicit large_data_storage(const Allocator& alloc = Allocator{}):
+        alloc_(alloc)
+    {
+    }
+
+    large_data_storage(const large_data_storage&) = delete;
+    large_data_storage(large_data_storage&&) = delete;
+    large_data_storage& operator=(const large_data_storage&) = delete;
+    large_data_storage& operator=(large_data_storage&&) = delete;
+
+    ~large_data_storage()
+    {
+        if(arena_ != nullptr)
+        {
+            deallocate_raw(arena_, ArenaSize, arena_alignment);
+        }
+    }
+
+    template<class Data>
+    const Data* create(const Data& data)
+    {
+        if constexpr(ArenaSize != 0)
+        {
+            if(auto pmem = allocate_from_arena(sizeof(Data), alignof(Data)))
+            {
+                try
+                {
+                    return new(pmem) Data{data};
+                }
+                catch(...)
+                {
+                    deallocate_from_arena();
+                    throw;
+                }
+            }
+        }
+
+        if constexpr(CountAllocations)
+        {
+            ++this->count;
+        }
+
+        if constexpr(is_null_v<Allocator>)
+        {
+            return new Data{data}; //NOLINT(cppcoreguidelines-owning-memory)
+        }
+        else
+        {
+            auto pmem = allocate_raw(sizeof(Data), alignof(Data));
+            try
+            {
+                return new(pmem) Data{data};
+            }
+            catch(...)
+            {
+                deallocate_raw(pmem, sizeof(Data), alignof(Data));
+                throw;
+            }
+        }
+    }
+
+    template<class Data>
+    void destroy(const Data* const pdata) noexcept
+    {
+        if constexpr(ArenaSize != 0)
+        {
+            if(arena_owns(pdata))
+            {
+                pdata->~Data();
+                deallocate_from_arena();
+                return;
+            }
+        }
+
+        if constexpr(is_null_v<Allocator>)
+        {
+            delete pdata; //NOLINT(cppcoreguidelines-owning-memory)
+        }
+        else
+        {
+            pdata->~Data();
+            deallocate_raw(const_cast<Data*>(pdata), sizeof(Data), alignof(Data)); //NOLINT(cppcoreguidelines-pro-type-const-cast)
+        }
+    }
+
+    //The number of data allocated without the arena so far
+    [[nodiscard]] std::uint64_t allocation_count() const
+    {
+        static_assert(CountAllocations);
+        return this->count;
+    }
+
+private:
+    static constexpr auto arena_alignment = alignof(std::max_align_t);
+
+    void* allocate_from_arena(const std::size_t size, const std::size_t alignment)
+    {
+        if(arena_ == nullptr)
+        {
+            arena_ = static_cast<char*>(allocate_raw(ArenaSize, arena_alignment));
+        }
+
+        void* pmem = arena_ + arena_offset_; //NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        auto space = ArenaSize - arena_offset_;
+        if(std::align(alignment, size, pmem, space) == nullptr)
+        {
+            return nullptr;
+        }
+
+        arena_offset_ = ArenaSize - space + size;
+        ++arena_allocation_count_;
+        return pmem;
+    }
+
+    void deallocate_from_arena() noexcept
+    {
+        --arena_allocation_count_;
+        if(arena_allocation_count_ == 0)
+        {
+            arena_offset_ = 0;
+        }
+    }
+
+    [[nodiscard]] bool arena_owns(const void* const ptr) const noexcept
+    {
+        const auto pbyte = static_cast<const char*>(ptr);
+        return
+            arena_ != nullptr &&
+            pbyte >= arena_ &&
+            pbyte < arena_ + ArenaSize //NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        ;
+    }
+
+    void* allocate_raw([[maybe_unused]] const std::size_t size, [[maybe_unused]] const std::size_t alignment)
+    {
+        if constexpr(is_null_v<Allocator>)
+        {
+            return ::operator new(size, std::align_val_t{alignment});
+        }
+        else if constexpr(std::is_pointer_v<Allocator>)
+        {
+            return alloc_->allocate(size, alignment);
+        }
+        else
+        {
+            return alloc_.allocate(size, alignment);
+        }
+    }
+
+    void deallocate_raw(void* const ptr, [[maybe_unused]] const std::size_t size, [[maybe_unused]] const std::size_t alignment) noexcept
+    {
+        if constexpr(is_null_v<Allocator>)
+        {
+            ::operator delete(ptr, std::align_val_t{alignment});
+        }
+        else if constexpr(std::is_pointer_v<Allocator>)
+        {
+            alloc_->deallocate(ptr, size, alignment);
+        }
+        else
+        {
+            alloc_.deallocate(ptr, size, alignment);
+        }
+    }
+
+    Allocator alloc_;
+    char* arena_ = nullptr;
+    std::size_t arena_offset_ = 0;
+    std::size_t arena_allocation_count_ = 0;
+};
+
+} //namespace
+
+#endif
@@ -0,0 +1,219 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#ifndef MAKI_DETAIL_LATENCY_PROFILING_HPP
+#define MAKI_DETAIL_LATENCY_PROFILING_HPP
+
+#include "pretty_name.hpp"
+#include "equals.hpp"
+#include "../null.hpp"
+#include "../latency_profile.hpp"
+#include "../states.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <cstddef>
+
+namespace maki::detail
+{
+
+enum class profiled_phase: char
+{
+    guard,
+    exit_action,
+    transition_action,
+    entry_action
+};
+
+/*
+Whether `StateId` identifies an actual state, as opposed to the initial
+pseudostate, to the final state, or to the absence of target state of internal
+transitions.
+*/
+template<auto StateId>
+constexpr bool is_profiled_state_id()
+{
+    if constexpr(is_null_v<std::decay_t<decltype(StateId)>>)
+    {
+        return false;
+    }
+    else
+    {
+        return
+            !ptr_equals(StateId, &state_molds::null) &&
+            !ptr_equals(StateId, &state_molds::fin)
+        ;
+    }
+}
+
+template<auto StateId>
+std::string profiled_state_name()
+{
+    if constexpr(ptr_equals(StateId, &state_molds::null))
+    {
+        return "null";
+    }
+    else if constexpr(ptr_equals(StateId, &state_molds::fin))
+    {
+        return "fin";
+    }
+    else
+    {
+        return std::string{pretty_name<*StateId>()};
+    }
+}
+
+/*
+A piece of user code called by a region, identified at compile time.
+For exit actions, only `SourceStateId` is relevant; for entry actions, only
+`TargetStateId` is. Entry and exit actions are therefore profiled per state,
+whatever the transition.
+*/
+template<class Region, profiled_phase Phase, auto SourceStateId, auto TargetStateId>
+struct profiled_site
+{
+    static std::string describe()
+    {
+        const auto region_path = Region::path().to_string();
+
+        if constexpr(Phase == profiled_phase::guard)
+        {
+            return "guard of " + region_path + ": " + profiled_state_name<SourceStateId>() + " -> " + profiled_state_name<TargetStateId>();
+        }
+        else if constexpr(Phase == profiled_phase::transition_action && is_null_v<std::decay_t<decltype(TargetStateId)>>)
+        {
+            return "internal transition action of " + region_path + ": " + profiled_state_name<SourceStateId>();
+        }
+        else if constexpr(Phase == profiled_phase::transition_action)
+        {
+            return "transition action of " + region_path + ": " + profiled_state_name<SourceStateId>() + " -> " + profiled_state_name<TargetStateId>();
+        }
+        else if constexpr(Phase == profiled_phase::exit_action)
+        {
+            return "exit action of " + region_path + ": " + profiled_state_name<SourceStateId>();
+        }
+        else
+        {
+            return "entry action of " + region_path + ": " + profiled_state_name<TargetStateId>();
+        }
+    }
+};
+
+/*
+Gives each profiled site of machines of type `Machine` a unique index, on
+first use.
+*/
+template<class Machine>
+inline std::atomic<std::size_t> profiled_site_count{0};
+
+template<class Machine, class Site>
+std::size_t profiled_site_index()
+{
+    static const auto index = profiled_site_count<Machine>.fetch_add(1, std::memory_order_relaxed);
+    return index;
+}
+
+/*
+The latency histograms of a machine (see
+`maki::machine_conf::latency_profiling()`), indexed by profiled site index.
+*/
+class latency_profile
+{
+public:
+    template<class Machine, class Site>
+    void add(const std::chrono::nanoseconds duration)
+    {
+        const auto index = profiled_site_index<Machine, Site>();
+        if(index >= sites_.size())
+        {
+            sites_.resize(index + 1);
+        }
+
+        auto& site = sites_[index];
+        if(site.describe == nullptr)
+        {
+            site.describe = &Site::describe;
+        }
+        site.histogram.add(duration);
+    }
+
+    [[nodiscard]] std::vector<latency_profile_entry> top_offenders(const std::size_t max_count) const
+    {
+        auto entries = std::vector<latency_profile_entry>{};
+        for(const auto& site: sites_)
+        {
+            if(site.histogram.count != 0)
+            {
+                entries.push_back(latency_profile_entry{site.describe(), site.histogram});
+            }
+        }
+
+        std::stable_sort
+        (
+            entries.begin(),
+            entries.end(),
+            [](const latency_profile_entry& lhs, const latency_profile_entry& rhs)
+            {
+                return lhs.histogram.total_duration > rhs.histogram.total_duration;
+            }
+        );
+
+        if(entries.size() > max_count)
+        {
+            entries.erase(entries.begin() + static_cast<std::ptrdiff_t>(max_count), entries.end());
+        }
+
+        return entries;
+    }
+
+    void reset()
+    {
+        for(auto& site: sites_)
+        {
+            site.histogram = latency_histogram{};
+        }
+    }
+
+private:
+    struct site_stats
+    {
+        std::string(*describe)() = nullptr;
+        latency_histogram histogram;
+    };
+
+    std::vector<site_stats> sites_;
+};
+
+struct disabled_latency_profile
+{
+};
+
+/*
+Calls `fun()` and adds its duration to the latency histogram of `Site`.
+*/
+template<class Machine, class Site, class Fun>
+auto call_profiled(latency_profile& profile, const Fun& fun)
+{
+    const auto start_time = std::chrono::steady_clock::now();
+    if constexpr(std::is_void_v<decltype(fun())>)
+    {
+        fun();
+        profile.add<Machine, Site>(std::chrono::steady_clock::now() - start_time);
+    }
+    else
+    {
+        const auto result = fun();
+        profile.add<Machine, Site>(std::chrono::steady_clock::now() - start_time);
+        return result;
+    }
+}
+
+} //namespace
+
+#endif
@@ -15,12 +15,15 @@
 #include "mix.hpp"
 #include "type_set.hpp"
 #include "../context.hpp"
+#include "../dispatch_strategy.hpp"
 #include "../null.hpp"
+#include "../overflow_policy.hpp"
 #include <cstdlib>
 
 namespace maki
 {
 
+inline constexpr auto machine_conf_default_post_event_capacity = std::size_t{256};
 inline constexpr auto machine_conf_default_small_event_max_align = 8;
 inline constexpr auto machine_conf_default_small_event_max_size = 16;
 
@@ -37,12 +40,19 @@ template
     class PreExternalTransitionHook = null_t,
     class PostExternalTransitionHook = null_t,
     class PostProcessingHookTuple = mix<>,
-    class TransitionTableTuple = mix<>
+    class TransitionTableTuple = mix<>,
+    class LargeEventAllocator = null_t,
+    class TimerServiceGetter = null_t,
+    class EventPriorityMix = mix<>,
+    class EventCoalescingMix = mix<>,
+    class EventQueueOverflowHandler = null_t
 >
 struct machine_conf_impl
 {
     using context_type = Context;
     using exception_handler_type = ExceptionHandler;
+    using event_queue_overflow_handler_type = EventQueueOverflowHandler;
+    using timer_service_getter_type = TimerServiceGetter;
     using pre_external_transition_hook_type = PreExternalTransitionHook;
     using post_external_transition_hook_type = PostExternalTransitionHook;
     using pre_processing_hook_tuple_type = PreProcessingHookTuple;
@@ -50,18 +60,40 @@ struct machine_conf_impl
     using internal_action_mix_type = mix<>;
     using deferred_event_type_set = empty_type_set_t;
 
+    bool async_actions_enabled = false;
     bool auto_start = true;
     machine_context_signature context_sig = machine_context_signature::a;
+    dispatch_strategy dispatch_strat = dispatch_strategy::linear;
+    EventCoalescingMix event_coalescings;
+    EventPriorityMix event_priorities;
+    int event_priority_count = 1;
+    std::size_t event_queue_capacity = 0;
+    std::size_t event_queue_max_size = 0;
+    EventQueueOverflowHandler event_queue_overflow_handler = EventQueueOverflowHandler{};
+    overflow_policy event_queue_overflow_policy = overflow_policy::reject;
+    bool flattened_dispatch = false;
+    LargeEventAllocator large_event_allocator = LargeEventAllocator{};
+    std::size_t large_event_arena_size = 0;
+    bool latency_profiling = false;
+    bool metrics = false;
+    std::size_t operation_budget = 0;
     PreProcessingHookTuple pre_processing_hooks;
     PostExternalTransitionHook post_external_transition_hook = null;
     PreExternalTransitionHook pre_external_transition_hook = null;
     ExceptionHandler exception_handler = null;
     PostProcessingHookTuple post_processing_hooks;
+    std::size_t post_event_capacity = machine_conf_default_post_event_capacity;
+    bool post_event_enabled = false;
     bool process_event_now_enabled = false;
+    bool queue_statistics = false;
     bool run_to_completion = true;
     std::size_t small_event_max_align = machine_conf_default_small_event_max_align;
     std::size_t small_event_max_size = machine_conf_default_small_event_max_size;
+    TimerServiceGetter timer_service = TimerServiceGetter{};
+    bool tracing = false;
     TransitionTableTuple transition_tables;
+    bool typed_event_queues = false;
+    bool until_enabled = false;
 
     static constexpr auto context_lifetime = state_context_lifetime::parent;
     static constexpr auto entry_actions = mix<>{};
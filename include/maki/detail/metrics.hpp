@@ -0,0 +1,393 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#ifndef MAKI_DETAIL_METRICS_HPP
+#define MAKI_DETAIL_METRICS_HPP
+
+#include "region_list.hpp"
+#include "pretty_name.hpp"
+#include "type_list.hpp"
+#include "constant.hpp"
+#include "equals.hpp"
+#include "tuple.hpp"
+#include "tlu/contains.hpp"
+#include "tlu/find.hpp"
+#include "tlu/size.hpp"
+#include "../states.hpp"
+#include <array>
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <cstdint>
+#include <cstddef>
+
+namespace maki::detail
+{
+
+/*
+The metrics of a region (see `maki::machine_conf::metrics()`).
+
+States are identified by their index in the transition table of the region.
+The undefined state (which is only active while a transition is interrupted by
+an exception) isn't counted, and is treated as the initial pseudostate.
+
+Transitions are identified by the indices of their source and target states.
+A source index equal to `state_count` stands for the initial pseudostate. A
+target index equal to `state_count` stands for the exit of the region, and a
+target index equal to `state_count + 1` stands for the final state.
+*/
+template<class Region>
+struct region_metrics
+{
+    static constexpr auto state_count = static_cast<int>
+    (
+        tlu::size_v<typename Region::state_id_constant_list_0>
+    );
+    static constexpr auto none_index = state_count;
+    static constexpr auto final_index = state_count + 1;
+    static constexpr auto source_index_count = state_count + 1;
+    static constexpr auto target_index_count = state_count + 2;
+
+    template<auto StateId>
+    static constexpr int source_index()
+    {
+        if constexpr
+        (
+            ptr_equals(StateId, &state_molds::null) ||
+            ptr_equals(StateId, &maki::undefined)
+        )
+        {
+            return none_index;
+        }
+        else
+        {
+            return tlu::find_v<typename Region::state_id_constant_list_0, constant_t<StateId>>;
+        }
+    }
+
+    template<auto StateId>
+    static constexpr int target_index()
+    {
+        if constexpr(ptr_equals(StateId, &state_molds::fin))
+        {
+            return final_index;
+        }
+        else
+        {
+            return source_index<StateId>();
+        }
+    }
+
+    static constexpr std::size_t transition_index(const int source, const int target)
+    {
+        return static_cast<std::size_t>((source * target_index_count) + target);
+    }
+
+    template<auto SourceStateId, auto TargetStateId>
+    void on_external_transition(const std::chrono::steady_clock::time_point now)
+    {
+        constexpr auto source = source_index<SourceStateId>();
+        constexpr auto target = target_index<TargetStateId>();
+
+        ++transition_counts[transition_index(source, target)];
+
+        if constexpr(source != none_index)
+        {
+            state_dwell_times[static_cast<std::size_t>(source)] += now - active_state_entry_time;
+        }
+
+        if constexpr(target < state_count)
+        {
+            ++state_entry_counts[static_cast<std::size_t>(target)];
+            active_state_index = target;
+            active_state_entry_time = now;
+        }
+        else
+        {
+            active_state_index = none_index;
+        }
+    }
+
+    //Includes the ongoing activation, if any
+    [[nodiscard]] std::chrono::nanoseconds state_dwell_time
+    (
+        const int index,
+        const std::chrono::steady_clock::time_point now
+    ) const
+    {
+        auto dwell_time = state_dwell_times[static_cast<std::size_t>(index)];
+        if(index == active_state_index)
+        {
+            dwell_time += now - active_state_entry_time;
+        }
+        return dwell_time;
+    }
+
+    void reset(const std::chrono::steady_clock::time_point now)
+    {
+        state_entry_counts = {};
+        state_dwell_times = {};
+        transition_counts = {};
+        active_state_entry_time = now;
+    }
+
+    std::array<std::uint64_t, static_cast<std::size_t>(state_count)> state_entry_counts{};
+    std::array<std::chrono::nanoseconds, static_cast<std::size_t>(state_count)> state_dwell_times{};
+    std::array<std::uint64_t, static_cast<std::size_t>(source_index_count * target_index_count)> transition_counts{};
+    int active_state_index = none_index;
+    std::chrono::steady_clock::time_point active_state_entry_time;
+};
+
+/*
+The metrics of a machine, i.e. the metrics of all its regions, plus the count
+of the events that no state or transition has handled.
+*/
+template<class RegionList>
+struct machine_metrics;
+
+template<class... Regions>
+struct machine_metrics<type_list_t<Regions...>>
+{
+    template<class Region>
+    region_metrics<Region>& of()
+    {
+        return tuple_get<region_metrics<Region>>(regions);
+    }
+
+    template<class Region>
+    const region_metrics<Region>& of() const
+    {
+        return tuple_get<region_metrics<Region>>(regions);
+    }
+
+    void reset()
+    {
+        const auto now = std::chrono::steady_clock::now();
+        (of<Regions>().reset(now), ...);
+        unhandled_event_count = 0;
+    }
+
+    tuple<region_metrics<Regions>...> regions;
+    std::uint64_t unhandled_event_count = 0;
+};
+
+struct disabled_machine_metrics
+{
+};
+
+template<bool Enabled, class RootImpl>
+struct machine_metrics_holder
+{
+    using type = disabled_machine_metrics;
+};
+
+template<class RootImpl>
+struct machine_metrics_holder<true, RootImpl>
+{
+    using type = machine_metrics<region_list_t<RootImpl>>;
+};
+
+/*
+The metrics of the machine whose root composite state implementation is
+`RootImpl`, or an empty struct if metrics are disabled.
+*/
+template<bool Enabled, class RootImpl>
+using machine_metrics_t = typename machine_metrics_holder<Enabled, RootImpl>::type;
+
+/*
+The first region of `RegionList` whose transition table contains the state
+created by `StateMold`, or `void`.
+*/
+template<class RegionList, const auto& StateMold>
+struct region_of_state;
+
+template<const auto& StateMold>
+struct region_of_state<type_list_t<>, StateMold>
+{
+    using type = void;
+};
+
+template<class Region, class... Regions, const auto& StateMold>
+struct region_of_state<type_list_t<Region, Regions...>, StateMold>
+{
+    using type = std::conditional_t
+    <
+        tlu::contains_v<typename Region::state_id_constant_list_0, constant_t<&StateMold>>,
+        Region,
+        typename region_of_state<type_list_t<Regions...>, StateMold>::type
+    >;
+};
+
+/*
+Escapes a label value, as required by the OpenMetrics text format.
+*/
+inline std::string escape_metric_label_value(const std::string_view value)
+{
+    auto escaped = std::string{};
+    escaped.reserve(value.size());
+    for(const auto c: value)
+    {
+        switch(c)
+        {
+            case '\\':
+                escaped += "\\\\";
+                break;
+            case '"':
+                escaped += "\\\"";
+                break;
+            case '\n':
+                escaped += "\\n";
+                break;
+            default:
+                escaped += c;
+                break;
+        }
+    }
+    return escaped;
+}
+
+/*
+The metric families written by `maki::metrics_registry`.
+*/
+enum class metric_family: char
+{
+    state_entries,
+    state_dwell_seconds,
+    transitions,
+    unhandled_events
+};
+
+/*
+Writes the samples of one metric family of a machine of type `Machine`.
+*/
+template<class Machine>
+struct metrics_export
+{
+    using region_list = region_list_t<typename Machine::impl_type>;
+
+    static void write
+    (
+        std::ostream& stream,
+        const metric_family family,
+        const void* const pmachine,
+        const std::string& machine_name
+    )
+    {
+        const auto& mach = *static_cast<const Machine*>(pmachine);
+        const auto machine_label = "machine=\"" + escape_metric_label_value(machine_name) + "\"";
+        const auto now = std::chrono::steady_clock::now();
+
+        if(family == metric_family::unhandled_events)
+        {
+            stream << "maki_unhandled_events_total{" << machine_label << "} " << mach.metrics_.unhandled_event_count << '\n';
+            return;
+        }
+
+        write_regions(stream, family, mach, machine_label, now, region_list{});
+    }
+
+private:
+    template<class... Regions>
+    static void write_regions
+    (
+        std::ostream& stream,
+        const metric_family family,
+        const Machine& mach,
+        const std::string& machine_label,
+        const std::chrono::steady_clock::time_point now,
+        type_list_t<Regions...> /*tag*/
+    )
+    {
+        (
+            write_region<Regions>
+            (
+                stream,
+                family,
+                mach.metrics_.template of<Regions>(),
+                machine_label,
+                now,
+                typename Regions::state_id_constant_list_0{}
+            ),
+            ...
+        );
+    }
+
+    template<class Region, class... StateIdConstants>
+    static void write_region
+    (
+        std::ostream& stream,
+        const metric_family family,
+        const region_metrics<Region>& metrics,
+        const std::string& machine_label,
+        const std::chrono::steady_clock::time_point now,
+        type_list_t<StateIdConstants...> /*tag*/
+    )
+    {
+        using metrics_type = region_metrics<Region>;
+
+        const auto region_label = machine_label + ",region=\"" + escape_metric_label_value(Region::path().to_string()) + "\"";
+
+        const std::string_view state_names[] = //NOLINT
+        {
+            pretty_name<*StateIdConstants::value>()...,
+            "null",
+            "fin"
+        };
+
+        switch(family)
+        {
+            case metric_family::state_entries:
+                for(auto i = 0; i != metrics_type::state_count; ++i)
+                {
+                    stream
+                        << "maki_state_entries_total{" << region_label
+                        << ",state=\"" << escape_metric_label_value(state_names[i]) << "\"} " //NOLINT
+                        << metrics.state_entry_counts[static_cast<std::size_t>(i)] << '\n'
+                    ;
+                }
+                break;
+            case metric_family::state_dwell_seconds:
+                for(auto i = 0; i != metrics_type::state_count; ++i)
+                {
+                    const auto dwell_time = std::chrono::duration<double>{metrics.state_dwell_time(i, now)};
+                    stream
+                        << "maki_state_dwell_seconds_total{" << region_label
+                        << ",state=\"" << escape_metric_label_value(state_names[i]) << "\"} " //NOLINT
+                        << dwell_time.count() << '\n'
+                    ;
+                }
+                break;
+            case metric_family::transitions:
+                for(auto source = 0; source != metrics_type::source_index_count; ++source)
+                {
+                    for(auto target = 0; target != metrics_type::target_index_count; ++target)
+                    {
+                        const auto count = metrics.transition_counts[metrics_type::transition_index(source, target)];
+                        if(count == 0)
+                        {
+                            continue;
+                        }
+
+                        stream
+                            << "maki_transitions_total{" << region_label
+                            << ",source=\"" << escape_metric_label_value(state_names[source]) << "\"" //NOLINT
+                            << ",target=\"" << escape_metric_label_value(state_names[target]) << "\"} " //NOLINT
+                            << count << '\n'
+                        ;
+                    }
+                }
+                break;
+            case metric_family::unhandled_events:
+                break;
+        }
+    }
+};
+
+} //namespace
+
+#endif
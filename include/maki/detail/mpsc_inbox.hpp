@@ -0,0 +1,277 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#ifndef MAKI_DETAIL_MPSC_INBOX_HPP
+#define MAKI_DETAIL_MPSC_INBOX_HPP
+
+#include <atomic>
+#include <memory>
+#include <new>
+#include <cstddef>
+
+namespace maki::detail
+{
+
+/*
+A bounded, lock-free, multiple-producer, single-consumer queue of calls to
+`FunHolder::call(data, arg)`.
+
+The calls are stored in a ring buffer of slots that is allocated once and for
+all at construction. Each slot stores its data in place, so that the data must
+fit in `DataMaxSize` bytes aligned to `DataMaxAlign`.
+
+Each slot holds a sequence number that tells, for a given position in the
+queue, whether the slot is free (sequence == position) or holds a published
+call (sequence == position + 1). This is the bounded queue of Dmitry Vyukov.
+
+`push()` can be called from any thread. It reserves the slot at the tail with a
+CAS loop, copies the data into the slot and publishes it. It never allocates,
+blocks nor takes any lock. It fails if the queue is full.
+
+`invoke_and_pop_all()` must only be called from a single (consumer) thread. It
+makes the published calls, in the order their slots have been reserved. It
+stops at the first slot whose call hasn't been published yet.
+*/
+template<class Arg, std::size_t DataMaxSize, std::size_t DataMaxAlign>
+class mpsc_inbox
+{
+public:
+    explicit mpsc_inbox(const std::size_t capacity):
+        mask_(round_up_to_power_of_two(capacity) - 1),
+        slots_(std::make_unique<slot[]>(mask_ + 1)) //NOLINT(cppcoreguidelines-avoid-c-arrays)
+    {
+        for(auto i = std::size_t{0}; i <= mask_; ++i)
+        {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    mpsc_inbox(const mpsc_inbox&) = delete;
+    mpsc_inbox(mpsc_inbox&&) = delete;
+    mpsc_inbox& operator=(const mpsc_inbox&) = delete;
+    mpsc_inbox& operator=(mpsc_inbox&&) = delete;
+
+    //Note: No call must be being pushed.
+    ~mpsc_inbox()
+    {
+        while(slot* const pslot = published_front())
+        {
+            pslot->destroy(pslot->storage);
+            ++head_;
+        }
+    }
+
+    /*
+    Push call to FunHolder::call(data, arg). Returns `false` if the queue is
+    full.
+
+    Calls `on_reserved()` (which must not throw) once a slot has been reserved,
+    before the call is published. If the copy of `data` throws, the slot is
+    published as a call that does nothing, so that the consumer doesn't wait
+    for it forever, and the exception is propagated.
+    */
+    template<class FunHolder, class Data, class OnReserved>
+    bool push(const Data& data, const OnReserved& on_reserved)
+    {
+        static_assert
+        (
+            sizeof(Data) <= DataMaxSize && alignof(Data) <= DataMaxAlign,
+            "Posted events (and their callbacks) must fit in `maki::machine_conf::small_event_max_size()` and `maki::machine_conf::small_event_max_align()`"
+        );
+
+        auto pos = tail_.load(std::memory_order_relaxed);
+        slot* pslot = nullptr;
+        while(true)
+        {
+            pslot = &slots_[pos & mask_];
+            const auto seq = pslot->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(seq - pos);
+            if(diff == 0)
+            {
+                if
+                (
+                    tail_.compare_exchange_weak
+                    (
+                        pos,
+                        pos + 1,
+                        std::memory_order_relaxed,
+                        std::memory_order_relaxed
+                    )
+                )
+                {
+                    break;
+                }
+            }
+            else if(diff < 0)
+            {
+                //The slot still holds the call of the previous lap
+                return false;
+            }
+            else
+            {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+
+        on_reserved();
+
+        auto grd = publication_guard{*pslot, pos};
+        new(pslot->storage) Data{data}; //NOLINT(cppcoreguidelines-owning-memory)
+        pslot->call = &call_impl<FunHolder, Data>;
+        pslot->destroy = &destroy_impl<Data>;
+        return true;
+    }
+
+    template<class FunHolder, class Data>
+    bool push(const Data& data)
+    {
+        return push<FunHolder>(data, []{});
+    }
+
+    /*
+    Returns the number of calls that have been made.
+
+    The front slot is popped before its call is made, so that the call can
+    recursively call this function. If a call throws, the calls that haven't
+    been made yet are kept for the next `invoke_and_pop_all()`.
+    */
+    std::size_t invoke_and_pop_all(Arg arg)
+    {
+        auto count = std::size_t{0};
+        while(slot* const pslot = published_front())
+        {
+            const auto grd = release_guard{*pslot, head_ + mask_ + 1};
+            ++head_;
+            ++count;
+            pslot->call(pslot->storage, arg);
+        }
+        return count;
+    }
+
+    //Note: The result is only an indication when producers are pushing.
+    [[nodiscard]] bool empty() const
+    {
+        return published_front() == nullptr;
+    }
+
+    [[nodiscard]] std::size_t capacity() const
+    {
+        return mask_ + 1;
+    }
+
+private:
+    struct slot
+    {
+        std::atomic<std::size_t> sequence{0};
+        void (*call)(void* pdata, Arg arg) = nullptr;
+        void (*destroy)(void* pdata) noexcept = nullptr;
+        alignas(DataMaxAlign) char storage[DataMaxSize]; //NOLINT
+    };
+
+    //Publishes the slot on destruction, as a call that does nothing if no call
+    //has been set (i.e. if the copy of the data has thrown).
+    struct publication_guard
+    {
+        publication_guard(slot& slt, const std::size_t pos):
+            slt(slt),
+            pos(pos)
+        {
+            slt.call = &noop_call;
+            slt.destroy = &noop_destroy;
+        }
+
+        publication_guard(const publication_guard&) = delete;
+        publication_guard(publication_guard&&) = delete;
+        publication_guard& operator=(const publication_guard&) = delete;
+        publication_guard& operator=(publication_guard&&) = delete;
+
+        ~publication_guard()
+        {
+            slt.sequence.store(pos + 1, std::memory_order_release);
+        }
+
+        slot& slt; //NOLINT(cppcoreguidelines-avoid-const-or-ref-data-members)
+        std::size_t pos;
+    };
+
+    //Destroys the data of the slot and frees the slot on destruction
+    struct release_guard
+    {
+        release_guard(slot& slt, const std::size_t next_lap_pos):
+            slt(slt),
+            next_lap_pos(next_lap_pos)
+        {
+        }
+
+        release_guard(const release_guard&) = delete;
+        release_guard(release_guard&&) = delete;
+        release_guard& operator=(const release_guard&) = delete;
+        release_guard& operator=(release_guard&&) = delete;
+
+        ~release_guard()
+        {
+            slt.destroy(slt.storage);
+            slt.sequence.store(next_lap_pos, std::memory_order_release);
+        }
+
+        slot& slt; //NOLINT(cppcoreguidelines-avoid-const-or-ref-data-members)
+        std::size_t next_lap_pos;
+    };
+
+    template<class FunHolder, class Data>
+    static void call_impl(void* const pdata, Arg arg)
+    {
+        FunHolder::call(*std::launder(static_cast<const Data*>(pdata)), arg);
+    }
+
+    template<class Data>
+    static void destroy_impl(void* const pdata) noexcept
+    {
+        std::launder(static_cast<Data*>(pdata))->~Data();
+    }
+
+    static void noop_call(void* /*pdata*/, Arg /*arg*/)
+    {
+    }
+
+    static void noop_destroy(void* /*pdata*/) noexcept
+    {
+    }
+
+    static std::size_t round_up_to_power_of_two(const std::size_t value)
+    {
+        auto result = std::size_t{1};
+        while(result < value)
+        {
+            result *= 2;
+        }
+        return result;
+    }
+
+    //Returns the front slot if its call has been published.
+    [[nodiscard]] slot* published_front() const
+    {
+        slot& slt = slots_[head_ & mask_];
+        if(slt.sequence.load(std::memory_order_acquire) != head_ + 1)
+        {
+            return nullptr;
+        }
+        return &slt;
+    }
+
+    std::size_t mask_;
+    std::unique_ptr<slot[]> slots_; //NOLINT(cppcoreguidelines-avoid-c-arrays)
+
+    //The position of the next slot to be reserved by the producers
+    std::atomic<std::size_t> tail_{0};
+
+    //The position of the next slot to be popped by the consumer
+    std::size_t head_ = 0;
+};
+
+} //namespace
+
+#endif
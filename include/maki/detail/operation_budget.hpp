@@ -0,0 +1,72 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#ifndef MAKI_DETAIL_OPERATION_BUDGET_HPP
+#define MAKI_DETAIL_OPERATION_BUDGET_HPP
+
+#include <chrono>
+#include <cstddef>
+
+namespace maki::detail
+{
+
+/*
+The budgets below limit the number of queued operations a machine executes in
+a row. `consume()` is called before each operation, and returns `false` once
+the budget is exhausted.
+*/
+
+struct unlimited_operation_budget
+{
+    static constexpr bool consume()
+    {
+        return true;
+    }
+};
+
+class operation_count_budget
+{
+public:
+    explicit operation_count_budget(const std::size_t count):
+        remaining_count_(count)
+    {
+    }
+
+    bool consume()
+    {
+        if(remaining_count_ == 0)
+        {
+            return false;
+        }
+        --remaining_count_;
+        return true;
+    }
+
+private:
+    std::size_t remaining_count_;
+};
+
+template<class Clock, class Duration>
+class operation_deadline_budget
+{
+public:
+    explicit operation_deadline_budget(const std::chrono::time_point<Clock, Duration>& deadline):
+        deadline_(deadline)
+    {
+    }
+
+    [[nodiscard]] bool consume() const
+    {
+        return Clock::now() < deadline_;
+    }
+
+private:
+    std::chrono::time_point<Clock, Duration> deadline_;
+};
+
+} //namespace
+
+#endif
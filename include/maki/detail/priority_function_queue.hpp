@@ -0,0 +1,154 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#ifndef MAKI_DETAIL_PRIORITY_FUNCTION_QUEUE_HPP
+#define MAKI_DETAIL_PRIORITY_FUNCTION_QUEUE_HPP
+
+#include <array>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+namespace maki::detail
+{
+
+/*
+A set of `PriorityCount` function queues (either `function_queue` or
+`typed_function_queue`), one per priority. Functions are invoked in decreasing
+order of priority, and in FIFO order within a given priority.
+*/
+template<class Queue, int PriorityCount>
+class priority_function_queue
+{
+public:
+    static_assert(PriorityCount > 1);
+
+    template<class LargeDataAllocator>
+    explicit priority_function_queue(const LargeDataAllocator& large_data_alloc):
+        priority_function_queue
+        (
+            large_data_alloc,
+            std::make_index_sequence<static_cast<std::size_t>(PriorityCount)>{}
+        )
+    {
+    }
+
+    priority_function_queue(const priority_function_queue&) = delete;
+    priority_function_queue(priority_function_queue&&) = delete;
+    priority_function_queue& operator=(const priority_function_queue&) = delete;
+    priority_function_queue& operator=(priority_function_queue&&) = delete;
+    ~priority_function_queue() = default;
+
+    //Push call to FunHolder::call(data, arg), with the given priority
+    template<class FunHolder, class Data>
+    void push(const Data& data, const int priority)
+    {
+        queues_[static_cast<std::size_t>(priority)].template push<FunHolder>(data);
+    }
+
+    //Invoke and pop the oldest function of the highest priority
+    template<class Arg>
+    bool invoke_and_pop(Arg&& arg)
+    {
+        for(auto i = queues_.size(); i != 0; --i)
+        {
+            auto& queue = queues_[i - 1];
+            if(!queue.empty())
+            {
+                return queue.invoke_and_pop(std::forward<Arg>(arg));
+            }
+        }
+        return false;
+    }
+
+    //Drop the oldest function of the lowest priority
+    template<class Arg>
+    void drop_front(Arg&& arg)
+    {
+        for(auto& queue: queues_)
+        {
+            if(!queue.empty())
+            {
+                queue.drop_front(std::forward<Arg>(arg));
+                return;
+            }
+        }
+    }
+
+    //See `function_queue::remove_if()`.
+    template<class FunHolder, class DataList, class Pred, class Arg>
+    std::size_t remove_if(const Pred& pred, Arg&& arg)
+    {
+        auto removed_count = std::size_t{0};
+        for(auto& queue: queues_)
+        {
+            removed_count += queue.template remove_if<FunHolder, DataList>(pred, arg);
+        }
+        return removed_count;
+    }
+
+    //Make sure `capacity` functions of each priority can be pushed without any
+    //reallocation.
+    void reserve(const std::size_t capacity)
+    {
+        for(auto& queue: queues_)
+        {
+            queue.reserve(capacity);
+        }
+    }
+
+    [[nodiscard]] std::size_t size() const
+    {
+        auto total_size = std::size_t{0};
+        for(const auto& queue: queues_)
+        {
+            total_size += queue.size();
+        }
+        return total_size;
+    }
+
+    [[nodiscard]] bool empty() const
+    {
+        for(const auto& queue: queues_)
+        {
+            if(!queue.empty())
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    //See `function_queue::large_data_allocation_count()`.
+    [[nodiscard]] std::uint64_t large_data_allocation_count() const
+    {
+        auto total_count = std::uint64_t{0};
+        for(const auto& queue: queues_)
+        {
+            total_count += queue.large_data_allocation_count();
+        }
+        return total_count;
+    }
+
+private:
+    template<std::size_t Index, class T>
+    static const T& forward_for(const T& value)
+    {
+        return value;
+    }
+
+    template<class LargeDataAllocator, std::size_t... Indexes>
+    priority_function_queue(const LargeDataAllocator& large_data_alloc, std::index_sequence<Indexes...> /*indexes*/):
+        queues_{{Queue{forward_for<Indexes>(large_data_alloc)}...}}
+    {
+    }
+
+    std::array<Queue, static_cast<std::size_t>(PriorityCount)> queues_;
+};
+
+} //namespace
+
+#endif
@@ -0,0 +1,208 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#ifndef MAKI_DETAIL_QUEUE_STATISTICS_HPP
+#define MAKI_DETAIL_QUEUE_STATISTICS_HPP
+
+#include "event_coalescing.hpp"
+#include "expiring_event.hpp"
+#include "type_list.hpp"
+#include "type_set.hpp"
+#include "../latency_profile.hpp"
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace maki::detail
+{
+
+/*
+What the event queues of a machine store for the data (i.e. an event, a
+coalescing marker or an expiring event) they're given, when queue statistics
+are enabled (see `maki::machine_conf::queue_statistics()`).
+*/
+template<class Data>
+struct timestamped_event
+{
+    Data data;
+    std::chrono::steady_clock::time_point enqueue_time;
+};
+
+/*
+The type of the event of the data stored in an event queue.
+*/
+template<class Data>
+struct queued_event_type
+{
+    using type = Data;
+};
+
+template<class Event>
+struct queued_event_type<coalesced_event_marker<Event>>
+{
+    using type = Event;
+};
+
+template<class Event>
+struct queued_event_type<expiring_event<Event>>
+{
+    using type = Event;
+};
+
+template<class Data>
+using queued_event_type_t = typename queued_event_type<Data>::type;
+
+/*
+`timestamped_event_type_set_t`: The set of the `timestamped_event` of the types
+of the given type set, so that `typed_function_queue` can store them in place.
+*/
+
+template<class TypeSet>
+struct timestamped_event_type_set
+{
+    using type = TypeSet;
+};
+
+template<class Data>
+struct timestamped_event_type_set<type_set_item<Data>>
+{
+    using type = type_set_item<timestamped_event<Data>>;
+};
+
+template<class... Datas>
+struct timestamped_event_type_set<type_set_inclusion_list<Datas...>>
+{
+    using type = type_set_inclusion_list<timestamped_event<Datas>...>;
+};
+
+template<class TypeSet>
+using timestamped_event_type_set_t = typename timestamped_event_type_set<TypeSet>::type;
+
+/*
+`timestamped_event_list_t`: The list of the `timestamped_event` of the types of
+the given type list.
+*/
+
+template<class TypeList>
+struct timestamped_event_list;
+
+template<class... Datas>
+struct timestamped_event_list<type_list_t<Datas...>>
+{
+    using type = type_list_t<timestamped_event<Datas>...>;
+};
+
+template<class TypeList>
+using timestamped_event_list_t = typename timestamped_event_list<TypeList>::type;
+
+/*
+Gives each event type queued into the queues identified by `QueueTag` a unique
+index, on first use.
+*/
+template<class QueueTag>
+inline std::atomic<std::size_t> queued_event_type_count{0};
+
+template<class QueueTag, class Event>
+std::size_t queued_event_type_index()
+{
+    static const auto index = queued_event_type_count<QueueTag>.fetch_add(1, std::memory_order_relaxed);
+    return index;
+}
+
+/*
+The enqueue-to-dispatch latency histograms of an event queue, indexed by queued
+event type index.
+*/
+template<class QueueTag>
+class event_latency_histograms
+{
+public:
+    template<class Event>
+    void add(const std::chrono::nanoseconds duration)
+    {
+        const auto index = queued_event_type_index<QueueTag, Event>();
+        if(index >= histograms_.size())
+        {
+            histograms_.resize(index + 1);
+        }
+        histograms_[index].add(duration);
+    }
+
+    template<class Event>
+    [[nodiscard]] const latency_histogram& of() const
+    {
+        static const auto empty_histogram = latency_histogram{};
+        const auto index = queued_event_type_index<QueueTag, Event>();
+        if(index >= histograms_.size())
+        {
+            return empty_histogram;
+        }
+        return histograms_[index];
+    }
+
+    void reset()
+    {
+        for(auto& histogram: histograms_)
+        {
+            histogram = latency_histogram{};
+        }
+    }
+
+private:
+    std::vector<latency_histogram> histograms_;
+};
+
+//The statistics of one of the event queues of a machine
+template<class QueueTag>
+struct event_queue_statistics
+{
+    template<class Data>
+    void on_dispatch(const timestamped_event<Data>& data)
+    {
+        latencies.template add<queued_event_type_t<Data>>(std::chrono::steady_clock::now() - data.enqueue_time);
+    }
+
+    void on_push(const std::size_t size)
+    {
+        if(size > high_water_mark)
+        {
+            high_water_mark = size;
+        }
+    }
+
+    std::size_t high_water_mark = 0;
+    event_latency_histograms<QueueTag> latencies;
+};
+
+/*
+The queue statistics of a machine (see
+`maki::machine_conf::queue_statistics()`). Empty if queue statistics are
+disabled.
+*/
+template<bool Enabled, class Machine>
+struct machine_queue_statistics
+{
+};
+
+template<class Machine>
+struct machine_queue_statistics<true, Machine>
+{
+    struct rtc_queue_tag{};
+    struct event_deferral_queue_tag{};
+
+    event_queue_statistics<rtc_queue_tag> rtc_queue;
+    event_queue_statistics<event_deferral_queue_tag> event_deferral_queue;
+    std::uint64_t deferral_retry_count = 0;
+
+    //The number of large event allocations at the last reset
+    std::uint64_t large_event_allocation_count_offset = 0;
+};
+
+} //namespace
+
+#endif
@@ -8,6 +8,7 @@
 #define MAKI_DETAIL_REGION_IMPL_HPP
 
 #include "compiler.hpp"
+#include "bitset.hpp"
 #include "type_set.hpp"
 #include "state_id_to_state.hpp"
 #include "transition_table_digest.hpp"
@@ -19,20 +20,34 @@
 #include "mix.hpp"
 #include "constant.hpp"
 #include "friendly_impl.hpp"
+#include "flat_leaf_list.hpp"
+#include "type_list.hpp"
+#include "smallest_int.hpp"
+#include "state_waiter.hpp"
+#include "state_timeout.hpp"
+#include "latency_profiling.hpp"
 #include "tlu/apply.hpp"
+#include "tlu/call_at.hpp"
 #include "tlu/empty.hpp"
+#include "tlu/filter.hpp"
 #include "tlu/find.hpp"
 #include "tlu/front.hpp"
+#include "tlu/pop_front.hpp"
 #include "tlu/push_back.hpp"
+#include "tlu/size.hpp"
 #include "../states.hpp"
 #include "../action.hpp"
 #include "../guard.hpp"
 #include "../path.hpp"
+#include "../dispatch_strategy.hpp"
 #include "../null.hpp"
 #include "../state_mold.hpp"
 #include "../state.hpp"
 #include "../transition_table.hpp"
+#include "../timer_service.hpp"
+#include <algorithm>
 #include <type_traits>
+#include <utility>
 
 namespace maki
 {
@@ -61,10 +76,33 @@ namespace region_detail
 
     template<class StateIdConstantList, auto StateId>
     inline constexpr auto state_id_to_index_v = state_id_to_index<StateIdConstantList, StateId>::value;
+
+    template<auto StateId>
+    inline constexpr auto timeout_count_v = static_cast<int>
+    (
+        std::decay_t<decltype(impl_of(*StateId).timeouts)>::size
+    );
+
+    template<class... StateIdConstants>
+    struct max_timeout_count
+    {
+        static constexpr auto value = std::max({0, timeout_count_v<StateIdConstants::value>...});
+    };
+
+    template<const auto& TransitionTable>
+    using timeout_timer_array_t = timeout_timer_array
+    <
+        tlu::apply_t
+        <
+            typename transition_table_digest<TransitionTable>::state_id_constant_list,
+            max_timeout_count
+        >::value
+    >;
 }
 
 template<const auto& TransitionTable, const auto& Path, context_storage ParentCtxStorage>
-class region_impl
+class region_impl:
+    private region_detail::timeout_timer_array_t<TransitionTable>
 {
 public:
     using transition_table_type = std::decay_t<decltype(TransitionTable)>;
@@ -129,18 +167,49 @@ public:
         return is_active_state_id<&state_molds::fin>();
     }
 
+    /*
+    Whether the active state defers `Event`.
+
+    Whether a state itself defers `Event` is known at compile time, so that
+    the answer for the active state is read from a bitmask indexed by the
+    active state index. Only composite states whose substates may defer
+    `Event` need to be asked at run time.
+    */
     template<class Event>
     [[nodiscard]] bool defers_event() const
     {
         if constexpr(type_set_contains_v<deferrable_event_type_set, Event>)
         {
-            auto defers = false;
-            with_active_state_id
+            static constexpr auto mask = state_deferral_mask<Event>;
+
+            if(active_state_index_ == region_detail::final_state_index)
+            {
+                return false;
+            }
+
+            if(mask.test(active_state_index_))
+            {
+                return true;
+            }
+
+            using candidate_state_type_list = tlu::filter_t
             <
-                state_id_constant_list,
-                state_defers_event<Event>
-            >(*this, defers);
-            return defers;
+                state_mix_type,
+                state_may_defer_event_through_substates<Event>::template predicate
+            >;
+
+            if constexpr(!tlu::empty_v<candidate_state_type_list>)
+            {
+                return tlu::for_each_or
+                <
+                    candidate_state_type_list,
+                    active_state_defers_event<Event>
+                >(*this);
+            }
+            else
+            {
+                return false;
+            }
         }
         else
         {
@@ -184,7 +253,12 @@ public:
     {
         if(!completed())
         {
-            with_active_state_id<state_id_constant_list, exit_2<TargetStateId>>
+            with_active_state_id
+            <
+                state_id_constant_list,
+                exit_2<TargetStateId>,
+                machine_dispatch_strategy<Machine>
+            >
             (
                 *this,
                 mach,
@@ -215,6 +289,18 @@ public:
         return process_event_2<Dry>(*this, mach, ctx, event);
     }
 
+    /*
+    Like `process_event()`, but the active states are known in advance.
+    `ActiveStatePath` is the `type_list_t` of the active state types, from the
+    active state of this region down to a leaf state (see
+    `maki::machine_conf::flattened_dispatch()`).
+    */
+    template<bool Dry, class ActiveStatePath, class Machine, class Context, class Event>
+    bool process_event_along(Machine& mach, Context& ctx, const Event& event)
+    {
+        return process_event_2<Dry, ActiveStatePath>(*this, mach, ctx, event);
+    }
+
     template<const auto& StateMold>
     const auto& state() const
     {
@@ -228,6 +314,9 @@ public:
     }
 
 private:
+    template<class Machine>
+    static constexpr auto machine_dispatch_strategy = impl_of(Machine::conf).dispatch_strat;
+
     struct state_emplace_contexts_with_parent_lifetime
     {
         template<class State, class Self, class Context, class Machine>
@@ -253,18 +342,69 @@ private:
         }
     };
 
+    //Whether `State` itself (i.e. not its substates) defers `Event`.
+    template<class State, class Event>
+    static constexpr bool state_itself_defers_event_v = type_set_contains_v
+    <
+        typename std::decay_t<decltype(impl_of(*impl_of_t<State>::identifier))>::deferred_event_type_set,
+        Event
+    >;
+
+    template<class Event>
+    struct state_may_defer_event_through_substates
+    {
+        template<class State>
+        struct predicate
+        {
+            static constexpr bool value =
+                !state_itself_defers_event_v<State, Event> &&
+                type_set_contains_v<typename impl_of_t<State>::deferrable_event_type_set, Event>
+            ;
+        };
+    };
+
+    template<class... States>
+    struct state_deferral_mask_maker
+    {
+        template<class Event>
+        static constexpr auto make()
+        {
+            auto mask = bitset<sizeof...(States)>{};
+            auto index = 0;
+            (
+                (
+                    state_itself_defers_event_v<States, Event> ?
+                        mask.set(index++) :
+                        static_cast<void>(index++)
+                ),
+                ...
+            );
+            return mask;
+        }
+    };
+
+    //The bitmask of the indices of the states that themselves defer `Event`.
     template<class Event>
-    struct state_defers_event
+    static constexpr auto state_deferral_mask = tlu::apply_t
+    <
+        state_mix_type,
+        state_deferral_mask_maker
+    >::template make<Event>();
+
+    template<class Event>
+    struct active_state_defers_event
     {
-        template<class StateIdConstant>
-        static void call(const region_impl& self, bool& defers)
+        template<class State>
+        static bool call(const region_impl& self)
         {
-            const auto& stt = self.state_id_to_obj<StateIdConstant::value>();
-            defers = impl_of(stt).template defers_event<Event>();
+            return
+                self.is_active_state_type<State>() &&
+                impl_of(self.state_type_to_obj<State>()).template defers_event<Event>()
+            ;
         }
     };
 
-    template<bool Dry, class Self, class Machine, class Context, class Event>
+    template<bool Dry, class ActiveStatePath = void, class Self, class Machine, class Context, class Event>
     static bool process_event_2
     (
         Self& self,
@@ -300,13 +440,13 @@ private:
             transitions.
             */
             return
-                call_active_state_internal_action<Dry>(self, mach, ctx, event) ||
+                call_active_state_internal_action<Dry, ActiveStatePath>(self, mach, ctx, event) ||
                 try_executing_transitions<candidate_transition_index_constant_list, Dry>(self, mach, ctx, event)
             ;
         }
         else if constexpr(!must_try_executing_transitions && must_try_process_event_in_states)
         {
-            return call_active_state_internal_action<Dry>(self, mach, ctx, event);
+            return call_active_state_internal_action<Dry, ActiveStatePath>(self, mach, ctx, event);
         }
         else if constexpr(must_try_executing_transitions && !must_try_process_event_in_states)
         {
@@ -336,17 +476,96 @@ private:
     /*
     Try executing one of the transitions at indices
     `TransitionIndexConstantList`.
+
+    With the jump table strategy, the active state index is used to index a
+    table whose entries only try the transitions that can fire from the
+    corresponding state. The completion transitions don't need this, as they
+    are already filtered by source state.
     */
     template<class TransitionIndexConstantList, bool Dry = false, class Self, class Machine, class Context, class Event>
     static bool try_executing_transitions(Self& self, Machine& mach, Context& ctx, const Event& event)
     {
-        return tlu::for_each_or
-        <
-            TransitionIndexConstantList,
-            try_executing_transition<Dry>
-        >(self, mach, ctx, event);
+        if constexpr
+        (
+            machine_dispatch_strategy<Machine> == dispatch_strategy::jump_table &&
+            !is_null_v<Event>
+        )
+        {
+            if(self.active_state_index_ == region_detail::final_state_index)
+            {
+                return false;
+            }
+
+            return tlu::call_at
+            <
+                state_id_constant_list,
+                try_executing_transitions_from<TransitionIndexConstantList, Dry>,
+                bool
+            >(self.active_state_index_, self, mach, ctx, event);
+        }
+        else
+        {
+            return tlu::for_each_or
+            <
+                TransitionIndexConstantList,
+                try_executing_transition<Dry>
+            >(self, mach, ctx, event);
+        }
     }
 
+    /*
+    Try executing one of the transitions at indices
+    `TransitionIndexConstantList` whose source is (or contains) the given state,
+    which is known to be the active state.
+    */
+    template<class TransitionIndexConstantList, bool Dry>
+    struct try_executing_transitions_from
+    {
+        template<class ActiveStateIdConstant, class Self, class Machine, class Context, class Event>
+        static bool call(Self& self, Machine& mach, Context& ctx, const Event& event)
+        {
+            using matching_transition_index_constant_list = transition_table_filters::by_source_state_t
+            <
+                TransitionIndexConstantList,
+                TransitionTable,
+                ActiveStateIdConstant::value
+            >;
+
+            return tlu::for_each_or
+            <
+                matching_transition_index_constant_list,
+                try_executing_transition_from<Dry, ActiveStateIdConstant>
+            >(self, mach, ctx, event);
+        }
+    };
+
+    template<bool Dry, class ActiveStateIdConstant>
+    struct try_executing_transition_from
+    {
+        template<class TransitionIndexConstant, class Self, class Machine, class Context, class Event>
+        static bool call(Self& self, Machine& mach, Context& ctx, const Event& event)
+        {
+            static constexpr const auto& trans = tuple_get<TransitionIndexConstant::value>(impl_of(TransitionTable));
+            static constexpr auto action = trans.act;
+            static constexpr auto guard = trans.grd;
+
+            return try_executing_transition_2
+            <
+                Dry,
+                trans.target_state_mold,
+                action,
+                guard,
+                false
+            >::template call<ActiveStateIdConstant>
+            (
+                self,
+                mach,
+                ctx,
+                event
+            );
+        }
+    };
+
     // Try executing the transition at index `TransitionIndexConstant`.
     template<bool Dry>
     struct try_executing_transition
@@ -370,6 +589,16 @@ private:
 
                 static_assert(!tlu::empty_v<matching_state_mold_constant_list>);
 
+                if constexpr(!is_null_v<Event>) // Already filtered out
+                {
+                    //Quickly reject the transition if the source state set
+                    //doesn't contain the active state
+                    if(!self.template is_active_state_index_in_set<&source_state_mold>())
+                    {
+                        return false;
+                    }
+                }
+
                 return tlu::for_each_or
                 <
                     matching_state_mold_constant_list,
@@ -401,7 +630,7 @@ private:
         }
     };
 
-    template<bool Dry, auto TargetStateId, const auto& Action, const auto& Guard>
+    template<bool Dry, auto TargetStateId, const auto& Action, const auto& Guard, bool CheckActiveState = true>
     struct try_executing_transition_2
     {
         template
@@ -420,7 +649,7 @@ private:
             const Event& event
         )
         {
-            if constexpr(!is_null_v<Event>) // Already filtered out
+            if constexpr(CheckActiveState && !is_null_v<Event>) // Already filtered out
             {
                 //Make sure the transition source state is the active state
                 if(!self.template is_active_state_id<SourceStateIdConstant::value>())
@@ -432,7 +661,22 @@ private:
             //Check guard
             if constexpr(!std::is_same_v<decltype(Guard), const null_t&>)
             {
-                if(!detail::call_guard(Guard, ctx, mach, event))
+                const auto guard_result = call_maybe_profiled
+                <
+                    profiled_phase::guard,
+                    SourceStateIdConstant::value,
+                    TargetStateId,
+                    !std::is_same_v<std::decay_t<decltype(Guard)>, std::decay_t<decltype(null_guard)>>
+                >
+                (
+                    mach,
+                    [&]
+                    {
+                        return detail::call_guard(Guard, ctx, mach, event);
+                    }
+                );
+
+                if(!guard_result)
                 {
                     return false;
                 }
@@ -452,6 +696,39 @@ private:
         }
     };
 
+    /*
+    Calls `fun()`, measuring its duration if latency profiling is enabled (see
+    `maki::machine_conf::latency_profiling()`). Default guards and actions
+    (`IsUserCode == false`), and the entry and exit actions of the initial
+    pseudostate and of the final state aren't measured.
+    */
+    template<profiled_phase Phase, auto SourceStateId, auto TargetStateId, bool IsUserCode = true, class Machine, class Fun>
+    static auto call_maybe_profiled(Machine& mach, const Fun& fun)
+    {
+        constexpr auto must_profile =
+            impl_of(Machine::conf).latency_profiling &&
+            IsUserCode &&
+            (
+                Phase == profiled_phase::guard ||
+                Phase == profiled_phase::transition_action ||
+                (
+                    is_profiled_state_id<SourceStateId>() &&
+                    is_profiled_state_id<TargetStateId>()
+                )
+            )
+        ;
+
+        if constexpr(must_profile)
+        {
+            using site_type = profiled_site<region_impl, Phase, SourceStateId, TargetStateId>;
+            return call_profiled<Machine, site_type>(mach.latency_profile_, fun);
+        }
+        else
+        {
+            return fun();
+        }
+    }
+
     template
     <
         auto SourceStateId,
@@ -477,6 +754,15 @@ private:
 
         auto& source_state = state_id_to_obj<SourceStateId>();
 
+        /*
+        For external transitions, record the transition into the trace buffer,
+        if tracing is enabled.
+        */
+        if constexpr(is_external_transition && impl_of(Machine::conf).tracing)
+        {
+            mach.template trace_external_transition<region_impl, SourceStateId, TargetStateId, Event>();
+        }
+
         /*
         For external transitions, invoke the pre-transition hook, if any.
         */
@@ -511,6 +797,19 @@ private:
                 state_id_constant_list,
                 &maki::undefined
             >;
+            update_flat_leaf_index<&maki::undefined>(mach);
+        }
+
+        /*
+        For external transitions, cancel the timeouts of the source state, if
+        any.
+        */
+        if constexpr(is_external_transition)
+        {
+            if constexpr(region_detail::timeout_count_v<SourceStateId> != 0)
+            {
+                cancel_timeouts<SourceStateId>();
+            }
         }
 
         /*
@@ -519,23 +818,56 @@ private:
         */
         if constexpr(is_external_transition)
         {
-            impl_of(source_state).exit
+            call_maybe_profiled<profiled_phase::exit_action, SourceStateId, SourceStateId>
             (
                 mach,
-                ctx,
-                event
+                [&]
+                {
+                    impl_of(source_state).exit
+                    (
+                        mach,
+                        ctx,
+                        event
+                    );
+                }
             );
         }
 
+        /*
+        For external transitions, if the source state can defer events, let the
+        machine know that some deferred events might not be deferred anymore.
+        */
+        if constexpr
+        (
+            is_external_transition &&
+            !type_set_empty_v<typename std::decay_t<decltype(impl_of(source_state))>::deferrable_event_type_set>
+        )
+        {
+            mach.deferring_state_exited_ = true;
+        }
+
         /*
         Invoke the transition action, if any.
         */
-        detail::call_action
+        call_maybe_profiled
+        <
+            profiled_phase::transition_action,
+            SourceStateId,
+            TargetStateId,
+            !std::is_same_v<std::decay_t<decltype(*ActionPtr)>, std::decay_t<decltype(null_action)>>
+        >
         (
-            *ActionPtr,
-            ctx,
             mach,
-            event
+            [&]
+            {
+                detail::call_action
+                (
+                    *ActionPtr,
+                    ctx,
+                    mach,
+                    event
+                );
+            }
         );
 
         /*
@@ -546,11 +878,18 @@ private:
         {
             auto& target_state = state_id_to_obj<TargetStateId>();
 
-            impl_of(target_state).enter
+            call_maybe_profiled<profiled_phase::entry_action, TargetStateId, TargetStateId>
             (
                 mach,
-                ctx,
-                event
+                [&]
+                {
+                    impl_of(target_state).enter
+                    (
+                        mach,
+                        ctx,
+                        event
+                    );
+                }
             );
         }
 
@@ -568,6 +907,30 @@ private:
                 state_id_constant_list,
                 TargetStateId
             >;
+            update_flat_leaf_index<TargetStateId>(mach);
+        }
+
+        /*
+        For external transitions, arm the timeouts of the target state, if any.
+        */
+        if constexpr(is_external_transition)
+        {
+            if constexpr(region_detail::timeout_count_v<TargetStateId> != 0)
+            {
+                arm_timeouts<TargetStateId>
+                (
+                    mach,
+                    std::make_integer_sequence<int, region_detail::timeout_count_v<TargetStateId>>{}
+                );
+            }
+        }
+
+        /*
+        For external transitions, update the metrics, if enabled.
+        */
+        if constexpr(is_external_transition && impl_of(Machine::conf).metrics)
+        {
+            mach.template record_external_transition_metrics<region_impl, SourceStateId, TargetStateId>();
         }
 
         /*
@@ -589,6 +952,17 @@ private:
             );
         }
 
+#if MAKI_DETAIL_COROUTINES
+        /*
+        For external transitions, resume the coroutines that wait for the
+        machine to reach the new state, if any.
+        */
+        if constexpr(is_external_transition && impl_of(Machine::conf).until_enabled)
+        {
+            mach.state_waiters_.resume_satisfied(mach);
+        }
+#endif
+
         /*
         For external transitions, execute the completion transitions, if any.
         */
@@ -608,8 +982,95 @@ private:
         }
     }
 
-    // Find the active state and call its internal action for `event`.
-    template<bool Dry, class Self, class Machine, class Context, class Event>
+    template<auto StateId, class Machine, int... Indexes>
+    void arm_timeouts(Machine& mach, std::integer_sequence<int, Indexes...> /*indexes*/)
+    {
+        static_assert
+        (
+            !is_null_v<typename Machine::option_set_type::timer_service_getter_type>,
+            "A state has a timeout (see `maki::state_mold::timeout()`), but no `maki::timer_service` has been given to the machine (see `maki::machine_conf::timer_service()`)"
+        );
+
+        auto& service = impl_of(Machine::conf).timer_service(mach);
+        (arm_timeout<StateId, Indexes>(mach, service), ...);
+    }
+
+    template<auto StateId, int Index, class Machine>
+    void arm_timeout(Machine& mach, timer_service& service)
+    {
+        auto& node = this->timeout_timer(Index);
+        node.callback = &fire_timeout<StateId, Index, Machine>;
+        node.pobj = &mach;
+        timer_service_access::arm
+        (
+            service,
+            node,
+            tuple_get<Index>(impl_of(*StateId).timeouts).delay
+        );
+    }
+
+    template<auto StateId>
+    void cancel_timeouts()
+    {
+        for(auto i = 0; i < region_detail::timeout_count_v<StateId>; ++i)
+        {
+            timer_service_access::cancel(this->timeout_timer(i));
+        }
+    }
+
+    template<auto StateId, int Index, class Machine>
+    static void fire_timeout(timer_node& node)
+    {
+        static_cast<Machine*>(node.pobj)->process_event
+        (
+            tuple_get<Index>(impl_of(*StateId).timeouts).event
+        );
+    }
+
+    /*
+    If this region belongs to the flattened hierarchy of the machine (see
+    `maki::machine_conf::flattened_dispatch()`), keep the active leaf index of
+    the machine up to date with the given new active state.
+
+    A composite state made of a single region isn't a leaf. Its region has
+    already updated the index when it has been entered.
+    */
+    template<auto StateId, class Machine>
+    static void update_flat_leaf_index([[maybe_unused]] Machine& mach)
+    {
+        if constexpr(impl_of(Machine::conf).flattened_dispatch)
+        {
+            using flat_leaf_list = typename Machine::flat_leaf_list;
+
+            if constexpr(flat_leaf_list_contains_region_v<flat_leaf_list, region_impl>)
+            {
+                using state_type = std::decay_t<decltype(static_state_id_to_obj<StateId>(std::declval<region_impl&>()))>;
+
+                constexpr auto index = flat_leaf_index_v
+                <
+                    flat_leaf_list,
+                    region_impl,
+                    state_type
+                >;
+
+                if constexpr(ptr_equals(StateId, &maki::undefined))
+                {
+                    mach.flat_leaf_index_ = unknown_flat_leaf_index;
+                }
+                else if constexpr(index != unknown_flat_leaf_index)
+                {
+                    mach.flat_leaf_index_ = index;
+                }
+            }
+        }
+    }
+
+    /*
+    Find the active state and call its internal action for `event`.
+    The active state isn't searched if `ActiveStatePath` isn't `void` (see
+    `process_event_along()`).
+    */
+    template<bool Dry, class ActiveStatePath = void, class Self, class Machine, class Context, class Event>
     static bool call_active_state_internal_action
     (
         Self& self,
@@ -618,13 +1079,38 @@ private:
         const Event& event
     )
     {
-        auto processed = false;
-        tlu::for_each_or
-        <
-            state_mix_type,
-            call_active_state_internal_action_2<Dry>
-        >(self, mach, ctx, event, processed);
-        return processed;
+        if constexpr(!std::is_void_v<ActiveStatePath>)
+        {
+            return call_state_internal_action
+            <
+                Dry,
+                tlu::pop_front_t<ActiveStatePath>
+            >::template call<tlu::front_t<ActiveStatePath>>(self, mach, ctx, event);
+        }
+        else if constexpr(machine_dispatch_strategy<Machine> == dispatch_strategy::jump_table)
+        {
+            if(self.active_state_index_ == region_detail::final_state_index)
+            {
+                return false;
+            }
+
+            return tlu::call_at
+            <
+                state_mix_type,
+                call_state_internal_action<Dry>,
+                bool
+            >(self.active_state_index_, self, mach, ctx, event);
+        }
+        else
+        {
+            auto processed = false;
+            tlu::for_each_or
+            <
+                state_mix_type,
+                call_active_state_internal_action_2<Dry>
+            >(self, mach, ctx, event, processed);
+            return processed;
+        }
     }
 
     template<bool Dry>
@@ -655,15 +1141,74 @@ private:
                     return false;
                 }
 
-                auto& active_state = self.template state_type_to_obj<State>();
-
-                processed = impl_of(active_state).template call_internal_action<Dry>
+                processed = call_state_internal_action<Dry>::template call<State>
                 (
+                    self,
                     mach,
                     ctx,
                     event
                 );
 
+                return true;
+            }
+            else
+            {
+                return false;
+            }
+        }
+    };
+
+    /*
+    Call the internal action of `State` (supposedly active) for `event`.
+    `SubstatePath` is the `type_list_t` of the active substates of `State`, if
+    known (see `process_event_along()`).
+    */
+    template<bool Dry, class SubstatePath = type_list_t<>>
+    struct call_state_internal_action
+    {
+        template<class State, class Self, class Machine, class Context, class Event>
+        static bool call
+        (
+            [[maybe_unused]] Self& self,
+            [[maybe_unused]] Machine& mach,
+            [[maybe_unused]] Context& ctx,
+            [[maybe_unused]] const Event& event
+        )
+        {
+            constexpr auto can_state_process_event =
+                type_set_contains_v
+                <
+                    typename impl_of_t<State>::event_type_set,
+                    Event
+                >
+            ;
+
+            if constexpr(can_state_process_event)
+            {
+                auto& active_state = self.template state_type_to_obj<State>();
+
+                const auto processed = [&]
+                {
+                    if constexpr(tlu::empty_v<SubstatePath>)
+                    {
+                        return impl_of(active_state).template call_internal_action<Dry>
+                        (
+                            mach,
+                            ctx,
+                            event
+                        );
+                    }
+                    else
+                    {
+                        return impl_of(active_state).template call_internal_action_along<Dry, SubstatePath>
+                        (
+                            mach,
+                            ctx,
+                            event
+                        );
+                    }
+                }();
+
                 if constexpr
                 (
                     transition_table_digest_type::has_completion_transitions &&
@@ -678,7 +1223,7 @@ private:
                     );
                 }
 
-                return true;
+                return processed;
             }
             else
             {
@@ -732,36 +1277,111 @@ private:
     template<auto StateSetPtr>
     [[nodiscard]] bool is_active_state_id_in_set() const
     {
-        auto matches = false;
-        with_active_state_id
-        <
-            tlu::push_back_t<state_id_constant_list, constant_t<&state_molds::fin>>,
-            is_active_state_id_in_set_2<StateSetPtr>
-        >(matches);
-        return matches;
+        if(active_state_index_ == region_detail::final_state_index)
+        {
+            return contains(impl_of(*StateSetPtr), &state_molds::fin);
+        }
+        return is_active_state_index_in_set<StateSetPtr>();
     }
 
+    /*
+    Whether the active state belongs to the given state set, not counting the
+    final state.
+
+    The membership is tested against a bitmask of the indices of the states
+    that belong to the set, computed at compile time. If these indices form a
+    contiguous range, a range check is done instead.
+    */
     template<auto StateSetPtr>
-    struct is_active_state_id_in_set_2
+    [[nodiscard]] bool is_active_state_index_in_set() const
     {
-        template<class ActiveStateIdConstant>
-        static void call([[maybe_unused]] bool& matches)
+        static constexpr auto mask = state_set_mask<StateSetPtr>;
+
+        if constexpr(mask.none())
         {
-            if constexpr(contains(impl_of(*StateSetPtr), ActiveStateIdConstant::value))
-            {
-                matches = true;
-            }
+            return false;
+        }
+        else if constexpr(mask.contiguous())
+        {
+            //Note: `final_state_index` wraps around to a large value.
+            constexpr auto first = mask.first();
+            constexpr auto last = mask.last();
+            return static_cast<unsigned int>(active_state_index_ - first) <= static_cast<unsigned int>(last - first);
+        }
+        else
+        {
+            return
+                active_state_index_ != region_detail::final_state_index &&
+                mask.test(active_state_index_)
+            ;
+        }
+    }
+
+    template<class... StateIdConstants>
+    struct state_set_mask_maker
+    {
+        template<auto StateSetPtr>
+        static constexpr auto make()
+        {
+            auto mask = bitset<sizeof...(StateIdConstants)>{};
+            auto index = 0;
+            (
+                (
+                    contains(impl_of(*StateSetPtr), StateIdConstants::value) ?
+                        mask.set(index++) :
+                        static_cast<void>(index++)
+                ),
+                ...
+            );
+            return mask;
         }
     };
 
-    template<class StateIdConstantList, class F, class... Args>
+    //The bitmask of the indices of the states that belong to the given set.
+    template<auto StateSetPtr>
+    static constexpr auto state_set_mask = tlu::apply_t
+    <
+        state_id_constant_list,
+        state_set_mask_maker
+    >::template make<StateSetPtr>();
+
+    /*
+    Calls `F::call<ActiveStateIdConstant>(args...)`.
+
+    The jump table strategy requires `StateIdConstantList` to be
+    `state_id_constant_list`, so that the index of the active state is also the
+    index of its ID in the list.
+    */
+    template
+    <
+        class StateIdConstantList,
+        class F,
+        dispatch_strategy Strategy = dispatch_strategy::linear,
+        class... Args
+    >
     void with_active_state_id(Args&&... args) const
     {
-        tlu::for_each_or
-        <
-            StateIdConstantList,
-            with_active_state_id_2<F>
-        >(*this, std::forward<Args>(args)...);
+        if constexpr(Strategy == dispatch_strategy::jump_table)
+        {
+            static_assert(std::is_same_v<StateIdConstantList, state_id_constant_list>);
+
+            if(active_state_index_ != region_detail::final_state_index)
+            {
+                tlu::call_at
+                <
+                    StateIdConstantList,
+                    F
+                >(active_state_index_, std::forward<Args>(args)...);
+            }
+        }
+        else
+        {
+            tlu::for_each_or
+            <
+                StateIdConstantList,
+                with_active_state_id_2<F>
+            >(*this, std::forward<Args>(args)...);
+        }
     }
 
     template<class F>
@@ -835,9 +1455,25 @@ private:
         }
     }
 
+    /*
+    The smallest type that can hold the index of any state of
+    `state_id_constant_list`, as well as `final_state_index`.
+    */
+    using active_state_index_type = smallest_int_t
+    <
+        region_detail::final_state_index,
+        tlu::size_v<state_id_constant_list> - 1
+    >;
+
     const region<region_impl>* pitf_;
+
+    /*
+    Declared before `states_` so that it can fill the padding that follows
+    `pitf_` when the states are small.
+    */
+    active_state_index_type active_state_index_ = region_detail::final_state_index;
+
     state_mix_type states_;
-    int active_state_index_ = region_detail::final_state_index;
 };
 
 } //namespace
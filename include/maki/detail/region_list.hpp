@@ -0,0 +1,99 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#ifndef MAKI_DETAIL_REGION_LIST_HPP
+#define MAKI_DETAIL_REGION_LIST_HPP
+
+#include "type_list.hpp"
+#include "mix.hpp"
+#include "friendly_impl.hpp"
+#include <type_traits>
+
+/*
+Utilities for enumerating all the regions of a machine, so that each region
+can be identified by an index (see `maki::trace_record`).
+*/
+
+namespace maki::detail
+{
+
+namespace region_list_detail
+{
+    template<class... TypeLists>
+    struct concat
+    {
+        using type = type_list_t<>;
+    };
+
+    template<class... Ts>
+    struct concat<type_list_t<Ts...>>
+    {
+        using type = type_list_t<Ts...>;
+    };
+
+    template<class... Ts, class... Us, class... TypeLists>
+    struct concat<type_list_t<Ts...>, type_list_t<Us...>, TypeLists...>
+    {
+        using type = typename concat<type_list_t<Ts..., Us...>, TypeLists...>::type;
+    };
+
+    template<class RegionMix>
+    struct of_region_mix;
+
+    //Non-composite states have no region
+    template<class State, class = void>
+    struct of_state
+    {
+        using type = type_list_t<>;
+    };
+
+    template<class State>
+    struct of_state<State, std::void_t<typename impl_of_t<State>::region_mix_type>>
+    {
+        using type = typename of_region_mix<typename impl_of_t<State>::region_mix_type>::type;
+    };
+
+    template<class Region, class StateMix>
+    struct of_region;
+
+    template<class Region, class... States>
+    struct of_region<Region, mix<States...>>
+    {
+        using type = typename concat
+        <
+            type_list_t<Region>,
+            typename of_state<States>::type...
+        >::type;
+    };
+
+    template<class... Regions>
+    struct of_region_mix<mix<Regions...>>
+    {
+        using type = typename concat
+        <
+            typename of_region
+            <
+                impl_of_t<Regions>,
+                typename impl_of_t<Regions>::state_mix_type
+            >::type...
+        >::type;
+    };
+}
+
+/*
+The `type_list_t` of all the `region_impl` types of the machine whose root
+composite state implementation (i.e. `composite_no_context`) is `RootImpl`, in
+depth-first order.
+*/
+template<class RootImpl>
+using region_list_t = typename region_list_detail::of_region_mix
+<
+    typename RootImpl::region_mix_type
+>::type;
+
+} //namespace
+
+#endif
@@ -0,0 +1,133 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#ifndef MAKI_DETAIL_RING_BUFFER_HPP
+#define MAKI_DETAIL_RING_BUFFER_HPP
+
+#include <memory>
+#include <utility>
+#include <cstddef>
+
+namespace maki::detail
+{
+
+/*
+The storage of the function queues: a contiguous ring buffer of slots that
+grows (by doubling its capacity) when it's full, but never shrinks.
+
+Slot must be default-constructible (as an empty slot) and must have a
+`void relocate_to(Slot& other) noexcept` member function, which moves the
+content of the slot into the empty slot `other` and leaves the slot empty.
+Destroying the content of the slots is up to the owner of the buffer.
+*/
+template<class Slot>
+class ring_buffer
+{
+public:
+    ring_buffer() = default;
+
+    ring_buffer(const ring_buffer&) = delete;
+    ring_buffer(ring_buffer&&) = delete;
+    ring_buffer& operator=(const ring_buffer&) = delete;
+    ring_buffer& operator=(ring_buffer&&) = delete;
+
+    //Note: The buffer must have been emptied beforehand.
+    ~ring_buffer() = default;
+
+    /*
+    Returns the empty slot that follows the back of the buffer, growing the
+    buffer if necessary. The slot becomes part of the buffer once
+    `commit_back()` is called.
+    */
+    Slot& next_back()
+    {
+        if(size_ == capacity_)
+        {
+            reallocate(capacity_ == 0 ? default_initial_capacity : capacity_ * 2);
+        }
+        return at(size_);
+    }
+
+    void commit_back()
+    {
+        ++size_;
+    }
+
+    Slot& front()
+    {
+        return at(0);
+    }
+
+    //Note: Doesn't reset the front slot.
+    void pop_front()
+    {
+        head_ = (head_ + 1) % capacity_;
+        --size_;
+    }
+
+    //Moves the front slot to the back of the buffer.
+    void rotate()
+    {
+        if(size_ != capacity_)
+        {
+            at(0).relocate_to(at(size_));
+        }
+        head_ = (head_ + 1) % capacity_;
+    }
+
+    void reserve(const std::size_t capacity)
+    {
+        if(capacity > capacity_)
+        {
+            reallocate(capacity);
+        }
+    }
+
+    [[nodiscard]] std::size_t capacity() const
+    {
+        return capacity_;
+    }
+
+    [[nodiscard]] std::size_t size() const
+    {
+        return size_;
+    }
+
+    [[nodiscard]] bool empty() const
+    {
+        return size_ == 0;
+    }
+
+private:
+    //The slot at the given position, relative to the front of the buffer
+    Slot& at(const std::size_t position)
+    {
+        return slots_[(head_ + position) % capacity_];
+    }
+
+    void reallocate(const std::size_t capacity)
+    {
+        auto slots = std::unique_ptr<Slot[]>(new Slot[capacity]); //NOLINT
+        for(auto i = std::size_t{0}; i < size_; ++i)
+        {
+            at(i).relocate_to(slots[i]);
+        }
+        slots_ = std::move(slots);
+        capacity_ = capacity;
+        head_ = 0;
+    }
+
+    static constexpr auto default_initial_capacity = std::size_t{4};
+
+    std::unique_ptr<Slot[]> slots_; //NOLINT
+    std::size_t capacity_ = 0;
+    std::size_t head_ = 0;
+    std::size_t size_ = 0;
+};
+
+} //namespace
+
+#endif
@@ -0,0 +1,210 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#ifndef MAKI_DETAIL_RUNTIME_SHARD_HPP
+#define MAKI_DETAIL_RUNTIME_SHARD_HPP
+
+#include <condition_variable>
+#include <mutex>
+#include <deque>
+#include <atomic>
+#include <utility>
+#include <cstddef>
+
+namespace maki::detail
+{
+
+/*
+We don't use std::hardware_destructive_interference_size, as its value isn't
+guaranteed to be stable across compiler flags (and GCC warns about it).
+*/
+inline constexpr auto cache_line_size = std::size_t{64};
+
+/*
+A machine owned by a `maki::runtime`, type-erased so that machines of different
+types can be scheduled by the same workers.
+
+`pending_event_count` is the number of events that have been (or are about to
+be) posted to the machine and haven't been processed yet. It's incremented once
+a slot of the inbox has been reserved for the event and *before* the event is
+published, so that it's never lower than the actual number of events of the
+inbox. The machine is scheduled (i.e. put into a run queue) whenever this
+count leaves zero, and stays scheduled until a worker brings it back to zero.
+This guarantees that a machine is never in more than one run queue at once, and
+therefore never processes events on two threads at once.
+
+The entry is cache-line aligned so that two machines never share a cache line.
+*/
+struct alignas(cache_line_size) runtime_entry_base
+{
+    explicit runtime_entry_base(const std::size_t home_shard_index):
+        home_shard_index(home_shard_index)
+    {
+    }
+
+    //Returns whether the machine was idle (and therefore must be scheduled).
+    bool add_pending_event()
+    {
+        return pending_event_count.fetch_add(1, std::memory_order_acq_rel) == 0;
+    }
+
+    //Returns whether the machine still has events to process (and therefore
+    //must be rescheduled).
+    bool remove_pending_events(const std::size_t count)
+    {
+        return pending_event_count.fetch_sub(count, std::memory_order_acq_rel) != count;
+    }
+
+    std::size_t (*process_posted_events)(runtime_entry_base& self) = nullptr;
+    void (*destroy)(runtime_entry_base* pself) noexcept = nullptr;
+    std::atomic<std::size_t> pending_event_count{0};
+    std::size_t home_shard_index;
+};
+
+template<class Machine>
+struct runtime_entry: runtime_entry_base
+{
+    template<class... ContextArgs>
+    explicit runtime_entry(const std::size_t home_shard_index, ContextArgs&&... ctx_args):
+        runtime_entry_base(home_shard_index),
+        mach(std::forward<ContextArgs>(ctx_args)...)
+    {
+        this->process_posted_events = &process_posted_events_impl;
+        this->destroy = &destroy_impl;
+    }
+
+    /*
+    Posts `data` to the machine. Counts it as pending before it can be
+    processed. Returns `false` if the inbox of the machine is full. Otherwise,
+    sets `was_idle` to whether the machine was idle (and therefore must be
+    scheduled).
+    */
+    template<class Data>
+    bool post(const Data& data, bool& was_idle)
+    {
+        return mach.post_into_inbox
+        (
+            data,
+            [&]
+            {
+                was_idle = add_pending_event();
+            }
+        );
+    }
+
+    template<class Event>
+    bool post_event(const Event& event, bool& was_idle)
+    {
+        return post(event, was_idle);
+    }
+
+    template<class Event, class Callback>
+    bool post_event(const Event& event, const Callback& on_processed, bool& was_idle)
+    {
+        return post
+        (
+            typename Machine::template posted_event_with_callback<Event, Callback>{event, on_processed},
+            was_idle
+        );
+    }
+
+    static std::size_t process_posted_events_impl(runtime_entry_base& self)
+    {
+        return static_cast<runtime_entry&>(self).mach.process_posted_events();
+    }
+
+    static void destroy_impl(runtime_entry_base* const pself) noexcept
+    {
+        delete static_cast<runtime_entry*>(pself); //NOLINT(cppcoreguidelines-owning-memory)
+    }
+
+    Machine mach;
+};
+
+/*
+The run queue of a worker thread of a `maki::runtime`.
+
+The owning worker pops machines from the front, while idle workers steal them
+from the back.
+
+The shard is cache-line aligned so that the workers, which keep updating their
+own shard, don't invalidate the cache lines of each other.
+*/
+struct alignas(cache_line_size) runtime_shard
+{
+    //Returns whether the worker of this shard is sleeping.
+    bool push(runtime_entry_base& entry)
+    {
+        const auto lock = std::lock_guard<std::mutex>{mutex};
+        run_queue.push_back(&entry);
+        return sleeping.load(std::memory_order_relaxed);
+    }
+
+    runtime_entry_base* try_pop()
+    {
+        const auto lock = std::lock_guard<std::mutex>{mutex};
+        return pop_front();
+    }
+
+    runtime_entry_base* try_steal()
+    {
+        const auto lock = std::unique_lock<std::mutex>{mutex, std::try_to_lock};
+        if(!lock.owns_lock() || run_queue.empty())
+        {
+            return nullptr;
+        }
+        const auto pentry = run_queue.back();
+        run_queue.pop_back();
+        return pentry;
+    }
+
+    /*
+    Waits until a machine is pushed, `stopping` is set or `timeout` expires
+    (so that the worker can look for machines to steal). Returns `nullptr` in
+    the last two cases.
+    */
+    template<class Duration>
+    runtime_entry_base* wait_and_pop(const std::atomic<bool>& stopping, const Duration timeout)
+    {
+        auto lock = std::unique_lock<std::mutex>{mutex};
+        if(run_queue.empty() && !stopping.load(std::memory_order_relaxed))
+        {
+            sleeping.store(true, std::memory_order_relaxed);
+            cv.wait_for(lock, timeout);
+            sleeping.store(false, std::memory_order_relaxed);
+        }
+        return pop_front();
+    }
+
+    void wake()
+    {
+        {
+            const auto lock = std::lock_guard<std::mutex>{mutex};
+        }
+        cv.notify_one();
+    }
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<runtime_entry_base*> run_queue;
+    std::atomic<bool> sleeping{false};
+
+private:
+    runtime_entry_base* pop_front()
+    {
+        if(run_queue.empty())
+        {
+            return nullptr;
+        }
+        const auto pentry = run_queue.front();
+        run_queue.pop_front();
+        return pentry;
+    }
+};
+
+} //namespace
+
+#endif
@@ -0,0 +1,41 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#ifndef MAKI_DETAIL_SMALLEST_INT_HPP
+#define MAKI_DETAIL_SMALLEST_INT_HPP
+
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+namespace maki::detail
+{
+
+/*
+The smallest signed integer type that can hold any value of the [Min, Max]
+range.
+*/
+template<long long Min, long long Max>
+using smallest_int_t = std::conditional_t
+<
+    (Min >= std::numeric_limits<std::int8_t>::min() && Max <= std::numeric_limits<std::int8_t>::max()),
+    std::int8_t,
+    std::conditional_t
+    <
+        (Min >= std::numeric_limits<std::int16_t>::min() && Max <= std::numeric_limits<std::int16_t>::max()),
+        std::int16_t,
+        std::conditional_t
+        <
+            (Min >= std::numeric_limits<std::int32_t>::min() && Max <= std::numeric_limits<std::int32_t>::max()),
+            std::int32_t,
+            std::int64_t
+        >
+    >
+>;
+
+} //namespace
+
+#endif
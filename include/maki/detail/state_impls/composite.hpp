@@ -29,6 +29,7 @@ public:
     using transition_table_type_list = decltype(impl_of(mold).transition_tables);
     using context_type = typename option_set_type::context_type;
     using impl_type = composite_no_context<identifier, Path, ParentCtxStorage>;
+    using region_mix_type = typename impl_type::region_mix_type;
     using event_type_set = typename impl_type::event_type_set;
     using deferrable_event_type_set = typename impl_type::deferrable_event_type_set;
 
@@ -108,6 +109,17 @@ public:
         return impl_.template call_internal_action<Dry>(mach, ctx_holder_.get_deep(), event);
     }
 
+    template<bool Dry, class ActiveStatePath, class Machine, class ParentContext, class Event>
+    bool call_internal_action_along
+    (
+        Machine& mach,
+        ParentContext& /*parent_ctx*/,
+        const Event& event
+    )
+    {
+        return impl_.template call_internal_action_along<Dry, ActiveStatePath>(mach, ctx_holder_.get_deep(), event);
+    }
+
     template<class Machine, class ParentContext, class Event>
     void exit
     (
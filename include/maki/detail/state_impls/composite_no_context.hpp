@@ -224,6 +224,22 @@ public:
         return call_internal_action_2<Dry>(*this, mach, ctx, event);
     }
 
+    /*
+    Like `call_internal_action()`, but the active states of the (single) region
+    are known in advance (see `region_impl::process_event_along()`).
+    */
+    template<bool Dry, class ActiveStatePath, class Machine, class Context, class Event>
+    bool call_internal_action_along
+    (
+        Machine& mach,
+        Context& ctx,
+        const Event& event
+    )
+    {
+        static_assert(region_mix_type::size == 1);
+        return call_internal_action_2<Dry, ActiveStatePath>(*this, mach, ctx, event);
+    }
+
     template<class Machine, class Context, class Event>
     void exit(Machine& mach, Context& ctx, const Event& event)
     {
@@ -349,14 +365,21 @@ private:
         }
     };
 
-    template<bool Dry>
+    template<bool Dry, class ActiveStatePath>
     struct region_process_event
     {
         template<class Region, class Self, class Machine, class Context, class Event>
         static int call(Self& self, Machine& mach, Context& ctx, const Event& event)
         {
-            const auto processed = impl_of(get<Region>(self.regions_)).template process_event<Dry>(mach, ctx, event);
-            return static_cast<int>(processed);
+            auto& rgn = impl_of(get<Region>(self.regions_));
+            if constexpr(std::is_void_v<ActiveStatePath>)
+            {
+                return static_cast<int>(rgn.template process_event<Dry>(mach, ctx, event));
+            }
+            else
+            {
+                return static_cast<int>(rgn.template process_event_along<Dry, ActiveStatePath>(mach, ctx, event));
+            }
         }
     };
 
@@ -389,7 +412,7 @@ private:
         }
     };
 
-    template<bool Dry, class Self, class Machine, class Context, class Event>
+    template<bool Dry, class ActiveStatePath = void, class Self, class Machine, class Context, class Event>
     static bool call_internal_action_2
     (
         Self& self,
@@ -413,13 +436,13 @@ private:
                 event
             );
 
-            tlu::for_each<region_mix_type, region_process_event<Dry>>(self, mach, ctx, event);
+            tlu::for_each<region_mix_type, region_process_event<Dry, ActiveStatePath>>(self, mach, ctx, event);
 
             return true;
         }
         else
         {
-            const auto processed_count = tlu::for_each_plus<region_mix_type, region_process_event<Dry>>(self, mach, ctx, event);
+            const auto processed_count = tlu::for_each_plus<region_mix_type, region_process_event<Dry, ActiveStatePath>>(self, mach, ctx, event);
             return static_cast<bool>(processed_count);
         }
     }
@@ -9,6 +9,7 @@
 
 #include "../context.hpp"
 #include "mix.hpp"
+#include "tuple.hpp"
 #include "type_set.hpp"
 #include <string_view>
 
@@ -22,7 +23,8 @@ template
     class InternalActionTuple = mix<>,
     class ExitActionTuple = mix<>,
     class TransitionTableTuple = mix<>,
-    class DeferredEventTypeSet = empty_type_set_t
+    class DeferredEventTypeSet = empty_type_set_t,
+    class TimeoutTuple = tuple<>
 >
 struct state_mold_impl
 {
@@ -37,6 +39,7 @@ struct state_mold_impl
     ExitActionTuple exit_actions;
     std::string_view pretty_name;
     TransitionTableTuple transition_tables;
+    TimeoutTuple timeouts;
 };
 
 } //namespace
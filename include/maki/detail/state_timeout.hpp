@@ -0,0 +1,66 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#ifndef MAKI_DETAIL_STATE_TIMEOUT_HPP
+#define MAKI_DETAIL_STATE_TIMEOUT_HPP
+
+#include "../timer_service.hpp"
+#include <array>
+
+namespace maki::detail
+{
+
+/*
+A timeout declared with `maki::state_mold::timeout()`.
+*/
+template<class Event>
+struct state_timeout
+{
+    timer_service::tick_count delay;
+    Event event;
+};
+
+/*
+The timers of the timeouts of a region. Since only one state of a region can
+be active at a time, a region needs as many timers as the state that has the
+most timeouts.
+*/
+template<int Size>
+class timeout_timer_array
+{
+public:
+    timeout_timer_array() = default;
+
+    timeout_timer_array(const timeout_timer_array&) = delete;
+    timeout_timer_array(timeout_timer_array&&) = delete;
+    timeout_timer_array& operator=(const timeout_timer_array&) = delete;
+    timeout_timer_array& operator=(timeout_timer_array&&) = delete;
+
+    ~timeout_timer_array()
+    {
+        for(auto& node: nodes_)
+        {
+            timer_service_access::cancel(node);
+        }
+    }
+
+    timer_node& timeout_timer(const int index)
+    {
+        return nodes_[static_cast<std::size_t>(index)];
+    }
+
+private:
+    std::array<timer_node, static_cast<std::size_t>(Size)> nodes_;
+};
+
+template<>
+class timeout_timer_array<0>
+{
+};
+
+} //namespace
+
+#endif
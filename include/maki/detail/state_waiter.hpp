@@ -0,0 +1,193 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#ifndef MAKI_DETAIL_STATE_WAITER_HPP
+#define MAKI_DETAIL_STATE_WAITER_HPP
+
+#include "compiler.hpp"
+
+#if MAKI_DETAIL_COROUTINES
+
+#include <coroutine>
+
+namespace maki::detail
+{
+
+template<class Machine>
+class state_waiter_list;
+
+/*
+An awaiter that suspends the awaiting coroutine until `is_satisfied(mach)`
+returns `true`.
+
+The awaiter lives in the frame of the awaiting coroutine. While the coroutine is
+suspended, the awaiter is linked into the `state_waiter_list` of the machine,
+so that waiting doesn't allocate any memory. If the coroutine is destroyed
+while suspended, the awaiter unlinks itself.
+*/
+template<class Machine>
+class state_awaiter
+{
+public:
+    using predicate_type = bool(*)(const Machine& mach);
+
+    state_awaiter(Machine& mach, const predicate_type is_satisfied):
+        mach_(mach),
+        is_satisfied_(is_satisfied)
+    {
+    }
+
+    state_awaiter(const state_awaiter&) = delete;
+    state_awaiter(state_awaiter&&) = delete;
+    state_awaiter& operator=(const state_awaiter&) = delete;
+    state_awaiter& operator=(state_awaiter&&) = delete;
+
+    ~state_awaiter()
+    {
+        if(linked_)
+        {
+            mach_.state_waiters_.remove(*this);
+        }
+    }
+
+    [[nodiscard]] bool await_ready() const
+    {
+        return is_satisfied_(mach_);
+    }
+
+    void await_suspend(const std::coroutine_handle<> handle)
+    {
+        handle_ = handle;
+        mach_.state_waiters_.push(*this);
+    }
+
+    void await_resume() const
+    {
+    }
+
+private:
+    friend class state_waiter_list<Machine>;
+
+    Machine& mach_; //NOLINT(cppcoreguidelines-avoid-const-or-ref-data-members)
+    predicate_type is_satisfied_;
+    std::coroutine_handle<> handle_;
+    state_awaiter* pprev_ = nullptr;
+    state_awaiter* pnext_ = nullptr;
+    bool linked_ = false;
+};
+
+/*
+An intrusive, doubly linked list of `state_awaiter`s, in the order the
+coroutines have been suspended.
+*/
+template<class Machine>
+class state_waiter_list
+{
+public:
+    using awaiter_type = state_awaiter<Machine>;
+
+    state_waiter_list() = default;
+
+    state_waiter_list(const state_waiter_list&) = delete;
+    state_waiter_list(state_waiter_list&&) = delete;
+    state_waiter_list& operator=(const state_waiter_list&) = delete;
+    state_waiter_list& operator=(state_waiter_list&&) = delete;
+
+    //Note: The awaiting coroutines are never resumed.
+    ~state_waiter_list()
+    {
+        while(phead_ != nullptr)
+        {
+            remove(*phead_);
+        }
+    }
+
+    void push(awaiter_type& awaiter)
+    {
+        awaiter.pprev_ = ptail_;
+        awaiter.pnext_ = nullptr;
+        if(ptail_ != nullptr)
+        {
+            ptail_->pnext_ = &awaiter;
+        }
+        else
+        {
+            phead_ = &awaiter;
+        }
+        ptail_ = &awaiter;
+        awaiter.linked_ = true;
+    }
+
+    void remove(awaiter_type& awaiter)
+    {
+        if(awaiter.pprev_ != nullptr)
+        {
+            awaiter.pprev_->pnext_ = awaiter.pnext_;
+        }
+        else
+        {
+            phead_ = awaiter.pnext_;
+        }
+
+        if(awaiter.pnext_ != nullptr)
+        {
+            awaiter.pnext_->pprev_ = awaiter.pprev_;
+        }
+        else
+        {
+            ptail_ = awaiter.pprev_;
+        }
+
+        awaiter.pprev_ = nullptr;
+        awaiter.pnext_ = nullptr;
+        awaiter.linked_ = false;
+    }
+
+    /*
+    Resumes the coroutines whose condition is satisfied.
+
+    A resumed coroutine can add or remove awaiters (by awaiting again, or by
+    destroying other coroutines), so we restart from the head of the list after
+    every resumption. Since an awaiter whose condition is already satisfied
+    doesn't suspend the coroutine, this always terminates.
+    */
+    void resume_satisfied(const Machine& mach)
+    {
+        if(phead_ == nullptr)
+        {
+            return;
+        }
+
+        auto pawaiter = phead_;
+        while(pawaiter != nullptr)
+        {
+            if(pawaiter->is_satisfied_(mach))
+            {
+                remove(*pawaiter);
+                pawaiter->handle_.resume();
+                pawaiter = phead_;
+            }
+            else
+            {
+                pawaiter = pawaiter->pnext_;
+            }
+        }
+    }
+
+private:
+    awaiter_type* phead_ = nullptr;
+    awaiter_type* ptail_ = nullptr;
+};
+
+struct disabled_state_waiter_list
+{
+};
+
+} //namespace
+
+#endif
+
+#endif
@@ -16,6 +16,7 @@ A type list is an instance of a type template of this form:
 
 #include "tlu/apply.hpp" //NOLINT misc-include-cleaner
 #include "tlu/back.hpp" //NOLINT misc-include-cleaner
+#include "tlu/call_at.hpp" //NOLINT misc-include-cleaner
 #include "tlu/contains.hpp" //NOLINT misc-include-cleaner
 #include "tlu/contains_if.hpp" //NOLINT misc-include-cleaner
 #include "tlu/empty.hpp" //NOLINT misc-include-cleaner
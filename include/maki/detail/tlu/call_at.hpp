@@ -0,0 +1,52 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#ifndef MAKI_DETAIL_TLU_CALL_AT_HPP
+#define MAKI_DETAIL_TLU_CALL_AT_HPP
+
+namespace maki::detail::tlu
+{
+
+template<class TList, class F>
+struct call_at_helper;
+
+template<template<class...> class TList, class... Ts, class F>
+struct call_at_helper<TList<Ts...>, F>
+{
+    static_assert(sizeof...(Ts) != 0);
+
+    template<class T, class R, class... Args>
+    static R trampoline(Args&... args)
+    {
+        return F::template call<T>(args...);
+    }
+
+    template<class R, class... Args>
+    static R call(const int index, Args&... args)
+    {
+        using fn_ptr_t = R(*)(Args&...);
+        static constexpr fn_ptr_t fn_ptrs[] = {&trampoline<Ts, R, Args...>...}; //NOLINT
+        return fn_ptrs[index](args...); //NOLINT
+    }
+};
+
+/*
+Calls:
+    return F::call<TI>(args...);
+where TI is the type at index `index` of `TList`.
+
+The call is done through a `constexpr` table of function pointers, which makes
+the lookup O(1).
+*/
+template<class TList, class F, class R = void, class... Args>
+R call_at(const int index, Args&... args)
+{
+    return call_at_helper<TList, F>::template call<R>(index, args...);
+}
+
+} //namespace
+
+#endif
@@ -0,0 +1,295 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#ifndef MAKI_DETAIL_TRACE_HPP
+#define MAKI_DETAIL_TRACE_HPP
+
+#include "region_list.hpp"
+#include "pretty_name.hpp"
+#include "type_name.hpp"
+#include "type_set.hpp"
+#include "type_list.hpp"
+#include "constant.hpp"
+#include "equals.hpp"
+#include "tlu/contains.hpp"
+#include "tlu/find.hpp"
+#include "../trace_buffer.hpp"
+#include "../states.hpp"
+#include "../events.hpp"
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+
+namespace maki::detail
+{
+
+/*
+The tracing state of a machine (see `maki::machine_conf::tracing()`). Empty if
+tracing is disabled.
+*/
+template<bool Enabled>
+struct machine_trace_state
+{
+};
+
+template<>
+struct machine_trace_state<true>
+{
+    std::uint32_t id = 0;
+    bool enabled = true;
+};
+
+/*
+The event types that are given an index in the trace records of a machine,
+i.e. the default start and stop events, followed by the ones of the event type
+set of the machine (unless the machine reacts to an open-ended set of events,
+e.g. `maki::any_but()`).
+*/
+template<class EventTypeSet>
+struct trace_event_type_list
+{
+    using type = type_list_t<events::start, events::stop>;
+};
+
+template<class... Events>
+struct trace_event_type_list<type_set_inclusion_list<Events...>>
+{
+    using type = type_list_t<events::start, events::stop, Events...>;
+};
+
+template<class EventTypeSet>
+using trace_event_type_list_t = typename trace_event_type_list<EventTypeSet>::type;
+
+template<class EventTypeList, class Event>
+constexpr std::uint16_t trace_event_type_index()
+{
+    if constexpr(tlu::contains_v<EventTypeList, Event>)
+    {
+        return static_cast<std::uint16_t>(tlu::find_v<EventTypeList, Event>);
+    }
+    else
+    {
+        return trace_record::none_index;
+    }
+}
+
+template<class Region, auto StateId>
+constexpr std::uint16_t trace_state_index()
+{
+    if constexpr(ptr_equals(StateId, &state_molds::null))
+    {
+        return trace_record::none_index;
+    }
+    else if constexpr(ptr_equals(StateId, &state_molds::fin))
+    {
+        return trace_record::final_index;
+    }
+    else
+    {
+        return static_cast<std::uint16_t>
+        (
+            tlu::find_v<typename Region::state_id_constant_list, constant_t<StateId>>
+        );
+    }
+}
+
+inline std::uint64_t trace_timestamp()
+{
+    return static_cast<std::uint64_t>
+    (
+        std::chrono::duration_cast<std::chrono::nanoseconds>
+        (
+            std::chrono::steady_clock::now().time_since_epoch()
+        ).count()
+    );
+}
+
+/*
+The names of what a trace record refers to. Only the names that are relevant
+to the kind of the record are set.
+*/
+struct trace_record_names
+{
+    std::string region_path;
+    std::string source_state;
+    std::string target_state;
+    std::string event_type;
+};
+
+/*
+The names of what a trace record refers to, made of raw indices, for the records
+of unknown machines.
+*/
+inline trace_record_names raw_trace_record_names(const trace_record& record)
+{
+    auto names = trace_record_names{};
+    if(record.kind == trace_record_kind::external_transition)
+    {
+        names.region_path = "region#" + std::to_string(record.region_index);
+        names.source_state = "state#" + std::to_string(record.source_state_index);
+        names.target_state = "state#" + std::to_string(record.target_state_index);
+    }
+    if(record.kind == trace_record_kind::external_transition || record.kind == trace_record_kind::event)
+    {
+        names.event_type = "event#" + std::to_string(record.event_type_index);
+    }
+    return names;
+}
+
+inline std::string trace_record_to_string(const trace_record& record, const trace_record_names& names)
+{
+    auto str = std::to_string(record.timestamp) + " machine#" + std::to_string(record.machine_id) + " ";
+    switch(record.kind)
+    {
+        case trace_record_kind::external_transition:
+            return str + names.region_path + ": " + names.source_state + " -> " + names.target_state + " (" + names.event_type + ")";
+        case trace_record_kind::event:
+            return str + "event: " + names.event_type;
+        case trace_record_kind::rtc_drain_begin:
+            return str + "rtc queue drain begin";
+        case trace_record_kind::rtc_drain_end:
+            return str + "rtc queue drain end";
+    }
+    return str + "unknown record";
+}
+
+/*
+Gives the names of what the trace records of machines of type `Machine` refer
+to, i.e. the paths of the regions, the pretty names of the states and the names
+of the event types.
+*/
+template<class Machine>
+struct trace_decoding
+{
+    using region_list = region_list_t<typename Machine::impl_type>;
+    using event_type_list = trace_event_type_list_t<typename Machine::impl_type::event_type_set>;
+
+    static trace_record_names names(const trace_record& record)
+    {
+        auto names = trace_record_names{};
+        if(record.kind == trace_record_kind::external_transition)
+        {
+            names.region_path = region_path(record.region_index);
+            names.source_state = state_name(record.region_index, record.source_state_index);
+            names.target_state = state_name(record.region_index, record.target_state_index);
+        }
+        if(record.kind == trace_record_kind::external_transition || record.kind == trace_record_kind::event)
+        {
+            names.event_type = event_type_name(record.event_type_index);
+        }
+        return names;
+    }
+
+private:
+    template<class Region>
+    static std::string region_path_of()
+    {
+        return Region::path().to_string();
+    }
+
+    template<auto StateId>
+    static std::string_view state_name_of()
+    {
+        return pretty_name<*StateId>();
+    }
+
+    template<class Event>
+    static std::string_view event_type_name_of()
+    {
+        return decayed_type_name<Event>();
+    }
+
+    template<class... Regions>
+    static std::string region_path_in(const std::size_t index, type_list_t<Regions...> /*tag*/)
+    {
+        using fun_type = std::string(*)();
+        static constexpr fun_type funs[] = {&region_path_of<Regions>..., nullptr}; //NOLINT
+        if(index < sizeof...(Regions))
+        {
+            return funs[index](); //NOLINT
+        }
+        return "region#" + std::to_string(index);
+    }
+
+    static std::string region_path(const std::uint16_t index)
+    {
+        return region_path_in(index, region_list{});
+    }
+
+    template<class... StateIdConstants>
+    static std::string state_name_in(const std::size_t index, type_list_t<StateIdConstants...> /*tag*/)
+    {
+        using fun_type = std::string_view(*)();
+        static constexpr fun_type funs[] = {&state_name_of<StateIdConstants::value>..., nullptr}; //NOLINT
+        if(index < sizeof...(StateIdConstants))
+        {
+            return std::string{funs[index]()}; //NOLINT
+        }
+        return "state#" + std::to_string(index);
+    }
+
+    template<class... Regions>
+    static std::string state_name_in_region(const std::size_t region_index, const std::size_t state_index, type_list_t<Regions...> /*tag*/)
+    {
+        using fun_type = std::string(*)(std::size_t);
+        static constexpr fun_type funs[] = //NOLINT
+        {
+            [](const std::size_t index)
+            {
+                return state_name_in(index, typename Regions::state_id_constant_list{});
+            }...,
+            nullptr
+        };
+        if(region_index < sizeof...(Regions))
+        {
+            return funs[region_index](state_index); //NOLINT
+        }
+        return "state#" + std::to_string(state_index);
+    }
+
+    static std::string state_name(const std::uint16_t region_index, const std::uint16_t state_index)
+    {
+        if(state_index == trace_record::none_index)
+        {
+            return "null";
+        }
+        if(state_index == trace_record::final_index)
+        {
+            return "fin";
+        }
+        return state_name_in_region(region_index, state_index, region_list{});
+    }
+
+    template<class... Events>
+    static std::string event_type_name_in(const std::size_t index, type_list_t<Events...> /*tag*/)
+    {
+        using fun_type = std::string_view(*)();
+        static constexpr fun_type funs[] = {&event_type_name_of<Events>..., nullptr}; //NOLINT
+        if(index < sizeof...(Events))
+        {
+            return std::string{funs[index]()}; //NOLINT
+        }
+        return "event#" + std::to_string(index);
+    }
+
+    static std::string event_type_name(const std::uint16_t index)
+    {
+        if(index == trace_record::none_index)
+        {
+            return "unknown event";
+        }
+        return event_type_name_in(index, event_type_list{});
+    }
+};
+
+//Writes decoded trace records as Chrome trace events (see chrome_trace.hpp).
+struct chrome_trace_export;
+
+} //namespace
+
+#endif
@@ -116,6 +116,42 @@ using by_source_state_and_null_event_t = tlu::filter_t
     by_source_state_and_null_event_detail::predicate_holder<&TransitionTable, SourceStateId>::template predicate
 >;
 
+
+/*
+`by_source_state_t`
+
+Keeps the transitions (of the given list of transition indices) that can fire
+from the given source state, whether the source of the transition is that
+state or a state set that contains it. The order of the given list is
+preserved.
+*/
+
+namespace by_source_state_detail
+{
+    template<auto TransitionTablePtr, auto SourceStateId>
+    struct predicate_holder
+    {
+        template<class TransitionIndexConstant>
+        struct predicate
+        {
+            static constexpr bool make_value()
+            {
+                const auto& trans = tuple_get<TransitionIndexConstant::value>(impl_of(*TransitionTablePtr));
+                return contained_in(*SourceStateId, trans.source_state_mold);
+            }
+
+            static constexpr bool value = make_value();
+        };
+    };
+}
+
+template<class TransitionIndexConstantList, const auto& TransitionTable, auto SourceStateId>
+using by_source_state_t = tlu::filter_t
+<
+    TransitionIndexConstantList,
+    by_source_state_detail::predicate_holder<&TransitionTable, SourceStateId>::template predicate
+>;
+
 } //namespace
 
 #endif
@@ -0,0 +1,560 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#ifndef MAKI_DETAIL_TYPED_FUNCTION_QUEUE_HPP
+#define MAKI_DETAIL_TYPED_FUNCTION_QUEUE_HPP
+
+#include "function_queue.hpp"
+#include "ring_buffer.hpp"
+#include "large_data_storage.hpp"
+#include "smallest_int.hpp"
+#include "type_list.hpp"
+#include "type_set.hpp"
+#include "tlu/contains.hpp"
+#include "tlu/filter.hpp"
+#include "tlu/find.hpp"
+#include "../null.hpp"
+#include <algorithm>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+namespace maki::detail
+{
+
+//A call to `FunHolder::call(data, arg)`, where `data` is of type `Data`
+template<class FunHolder, class Data>
+struct typed_function_queue_entry
+{
+    using fun_holder_type = FunHolder;
+    using data_type = Data;
+};
+
+/*
+An alternative to `function_queue` for when the set of function calls that can
+be pushed is known at compile time.
+
+EntryList is the `type_list_t` of the `typed_function_queue_entry` types that
+are stored as the alternatives of a tagged union. These calls are dispatched
+through a `switch`-like chain of tag comparisons, without any indirect call.
+Other calls are stored in a `large_data_storage`, behind function pointers.
+
+All the entries must have a nothrow move constructor (see
+`typed_function_queue_accepts_v`), so that the slots of the underlying
+`ring_buffer` can be relocated.
+*/
+template
+<
+    class Arg,
+    class EntryList,
+    class LargeDataAllocator = null_t,
+    std::size_t LargeDataArenaSize = 0,
+    bool CountsLargeDataAllocations = false
+>
+class typed_function_queue;
+
+template<class Entry>
+inline constexpr auto typed_function_queue_accepts_v =
+    std::is_nothrow_move_constructible_v<typename Entry::data_type>
+;
+
+template<class Arg, class... Entries, class LargeDataAllocator, std::size_t LargeDataArenaSize, bool CountsLargeDataAllocations>
+class typed_function_queue<Arg, type_list_t<Entries...>, LargeDataAllocator, LargeDataArenaSize, CountsLargeDataAllocations>
+{
+public:
+    explicit typed_function_queue(const LargeDataAllocator& large_data_alloc = LargeDataAllocator{}):
+        large_data_storage_(large_data_alloc)
+    {
+    }
+
+    typed_function_queue(const typed_function_queue&) = delete;
+    typed_function_queue(typed_function_queue&&) = delete;
+    typed_function_queue& operator=(const typed_function_queue&) = delete;
+    typed_function_queue& operator=(typed_function_queue&&) = delete;
+
+    ~typed_function_queue()
+    {
+        while(!empty())
+        {
+            slots_.front().reset(large_data_storage_);
+            slots_.pop_front();
+        }
+    }
+
+    //Push call to FunHolder::call(data, arg)
+    template<class FunHolder, class Data>
+    void push(const Data& data)
+    {
+        //If the Data copy constructor throws, the slot is left empty.
+        slots_.next_back().template emplace<FunHolder>(data, large_data_storage_);
+        slots_.commit_back();
+    }
+
+    /*
+    Note: The function is moved out of the buffer before being called, so that
+    it's safe for the function to push new functions into this queue (which
+    can reallocate the buffer).
+    */
+    bool invoke_and_pop(Arg arg)
+    {
+        auto front = slot_guard{large_data_storage_};
+        slots_.front().relocate_to(front.slt);
+        slots_.pop_front();
+        return front.slt.call(arg);
+    }
+
+    //See `function_queue::invoke_or_rotate()`.
+    bool invoke_or_rotate(Arg arg)
+    {
+        if(!slots_.front().is_ready(arg))
+        {
+            slots_.rotate();
+            return false;
+        }
+        return invoke_and_pop(arg);
+    }
+
+    //See `function_queue::rotate()`.
+    void rotate()
+    {
+        slots_.rotate();
+    }
+
+    //See `function_queue::drop_front()`.
+    void drop_front(Arg arg)
+    {
+        auto front = slot_guard{large_data_storage_};
+        slots_.front().relocate_to(front.slt);
+        slots_.pop_front();
+        front.slt.drop(arg);
+    }
+
+    //See `function_queue::remove_if()`.
+    template<class FunHolder, class DataList, class Pred>
+    std::size_t remove_if(const Pred& pred, Arg arg)
+    {
+        auto removed_count = std::size_t{0};
+        for(auto count = size(); count != 0; --count)
+        {
+            if(matches<FunHolder>(slots_.front(), pred, DataList{}))
+            {
+                drop_front(arg);
+                ++removed_count;
+            }
+            else
+            {
+                slots_.rotate();
+            }
+        }
+        return removed_count;
+    }
+
+    void invoke_and_pop_all(Arg arg)
+    {
+        while(!empty())
+        {
+            invoke_and_pop(arg);
+        }
+    }
+
+    //Make sure `capacity` functions can be pushed without any reallocation.
+    void reserve(const std::size_t capacity)
+    {
+        slots_.reserve(capacity);
+    }
+
+    [[nodiscard]] std::size_t capacity() const
+    {
+        return slots_.capacity();
+    }
+
+    [[nodiscard]] std::size_t size() const
+    {
+        return slots_.size();
+    }
+
+    [[nodiscard]] bool empty() const
+    {
+        return slots_.empty();
+    }
+
+    //See `function_queue::large_data_allocation_count()`.
+    [[nodiscard]] std::uint64_t large_data_allocation_count() const
+    {
+        return large_data_storage_.allocation_count();
+    }
+
+private:
+    using entry_list = type_list_t<Entries...>;
+
+    static_assert((typed_function_queue_accepts_v<Entries> && ...));
+
+    static constexpr auto entry_count = static_cast<int>(sizeof...(Entries));
+
+    //Tag of the empty slots
+    static constexpr auto empty_tag = -1;
+
+    //Tag of the calls that aren't in EntryList
+    static constexpr auto erased_tag = entry_count;
+
+    using tag_type = smallest_int_t<empty_tag, erased_tag>;
+
+    using large_data_storage_type = large_data_storage<LargeDataAllocator, LargeDataArenaSize, CountsLargeDataAllocations>;
+
+    struct erased_ops
+    {
+        bool (*call)(const void* pdata, Arg arg);
+        bool (*is_ready)(const void* pdata, Arg arg);
+        void (*drop)(const void* pdata, Arg arg);
+        void (*destroy)(const void* pdata, large_data_storage_type& storage) noexcept;
+    };
+
+    //The representation of the calls that aren't in EntryList
+    struct erased
+    {
+        const void* pdata;
+        const erased_ops* pops;
+    };
+
+    static constexpr auto storage_size = std::max({sizeof(erased), sizeof(typename Entries::data_type)...});
+    static constexpr auto storage_align = std::max({alignof(erased), alignof(typename Entries::data_type)...});
+
+    template<class FunHolder, class Data>
+    static constexpr auto tag_of()
+    {
+        using entry_type = typed_function_queue_entry<FunHolder, Data>;
+        if constexpr(tlu::contains_v<entry_list, entry_type>)
+        {
+            return tlu::find_v<entry_list, entry_type>;
+        }
+        else
+        {
+            return erased_tag;
+        }
+    }
+
+    struct slot
+    {
+        slot() = default; //NOLINT(cppcoreguidelines-pro-type-member-init)
+
+        slot(const slot&) = delete;
+        slot(slot&&) = delete;
+        slot& operator=(const slot&) = delete;
+        slot& operator=(slot&&) = delete;
+
+        //Note: The slot must have been reset beforehand.
+        ~slot() = default;
+
+        template<class FunHolder, class Data>
+        void emplace(const Data& data, large_data_storage_type& large_data_storage)
+        {
+            constexpr auto entry_tag = tag_of<FunHolder, Data>();
+            if constexpr(entry_tag == erased_tag)
+            {
+                new(storage) erased //NOLINT
+                {
+                    large_data_storage.create(data),
+                    &erased_ops_of<FunHolder, Data>
+                };
+            }
+            else
+            {
+                new(storage) Data{data}; //NOLINT
+            }
+            tag = entry_tag;
+        }
+
+        bool call(Arg arg)
+        {
+            if(tag == erased_tag)
+            {
+                const auto& erased_data = get<erased>();
+                return erased_data.pops->call(erased_data.pdata, arg);
+            }
+
+            auto result = false;
+            visit<call_visitor>(*this, arg, result);
+            return result;
+        }
+
+        bool is_ready(Arg arg)
+        {
+            if(tag == erased_tag)
+            {
+                const auto& erased_data = get<erased>();
+                return erased_data.pops->is_ready(erased_data.pdata, arg);
+            }
+
+            auto result = false;
+            visit<is_ready_visitor>(*this, arg, result);
+            return result;
+        }
+
+        void drop(Arg arg)
+        {
+            if(tag == erased_tag)
+            {
+                const auto& erased_data = get<erased>();
+                erased_data.pops->drop(erased_data.pdata, arg);
+                return;
+            }
+
+            visit<drop_visitor>(*this, arg);
+        }
+
+        void relocate_to(slot& other) noexcept
+        {
+            if(tag == erased_tag)
+            {
+                new(other.storage) erased{get<erased>()}; //NOLINT
+            }
+            else
+            {
+                visit<relocate_visitor>(*this, other);
+            }
+            other.tag = tag;
+            tag = empty_tag;
+        }
+
+        void reset(large_data_storage_type& large_data_storage) noexcept
+        {
+            if(tag == erased_tag)
+            {
+                const auto& erased_data = get<erased>();
+                erased_data.pops->destroy(erased_data.pdata, large_data_storage);
+            }
+            else
+            {
+                visit<destroy_visitor>(*this);
+            }
+            tag = empty_tag;
+        }
+
+        template<class T>
+        T& get()
+        {
+            return *std::launder(reinterpret_cast<T*>(storage)); //NOLINT
+        }
+
+        alignas(storage_align) unsigned char storage[storage_size]; //NOLINT
+        tag_type tag = empty_tag;
+    };
+
+    //Resets the slot it holds on destruction
+    struct slot_guard
+    {
+        explicit slot_guard(large_data_storage_type& storage):
+            storage(storage)
+        {
+        }
+
+        slot_guard(const slot_guard&) = delete;
+        slot_guard(slot_guard&&) = delete;
+        slot_guard& operator=(const slot_guard&) = delete;
+        slot_guard& operator=(slot_guard&&) = delete;
+
+        ~slot_guard()
+        {
+            slt.reset(storage);
+        }
+
+        large_data_storage_type& storage; //NOLINT(cppcoreguidelines-avoid-const-or-ref-data-members)
+        slot slt;
+    };
+
+    template<class FunHolder, class Pred, class... Datas>
+    static bool matches(slot& slt, const Pred& pred, type_list_t<Datas...> /*tag*/)
+    {
+        return (matches<FunHolder, Datas>(slt, pred) || ...);
+    }
+
+    template<class FunHolder, class Data, class Pred>
+    static bool matches(slot& slt, const Pred& pred)
+    {
+        constexpr auto entry_tag = tag_of<FunHolder, Data>();
+        if constexpr(entry_tag == erased_tag)
+        {
+            if(slt.tag != erased_tag)
+            {
+                return false;
+            }
+            const auto& erased_data = slt.template get<erased>();
+            return
+                erased_data.pops == &erased_ops_of<FunHolder, Data> &&
+                pred(*static_cast<const Data*>(erased_data.pdata))
+            ;
+        }
+        else
+        {
+            return slt.tag == entry_tag && pred(slt.template get<Data>());
+        }
+    }
+
+    //Calls `Visitor::call<Entry>(self, args...)`, where `Entry` is the entry
+    //whose tag is `self.tag` (if any).
+    template<class Visitor, class... Args>
+    static void visit(slot& self, Args&... args)
+    {
+        visit_2<Visitor>(std::index_sequence_for<Entries...>{}, self, args...);
+    }
+
+    template<class Visitor, std::size_t... Indexes, class... Args>
+    static void visit_2(std::index_sequence<Indexes...> /*indexes*/, slot& self, Args&... args)
+    {
+        (void)
+        (
+            (
+                self.tag == static_cast<int>(Indexes) &&
+                (Visitor::template call<Entries>(self, args...), true)
+            ) || ...
+        );
+    }
+
+    struct call_visitor
+    {
+        template<class Entry>
+        static void call(slot& self, Arg arg, bool& result)
+        {
+            using data_type = typename Entry::data_type;
+            result = Entry::fun_holder_type::call(self.template get<data_type>(), arg);
+        }
+    };
+
+    struct is_ready_visitor
+    {
+        template<class Entry>
+        static void call(slot& self, Arg arg, bool& result)
+        {
+            using data_type = typename Entry::data_type;
+            result = fun_holder_is_ready<typename Entry::fun_holder_type, data_type, Arg>(self.template get<data_type>(), arg);
+        }
+    };
+
+    struct drop_visitor
+    {
+        template<class Entry>
+        static void call(slot& self, Arg arg)
+        {
+            using data_type = typename Entry::data_type;
+            fun_holder_drop<typename Entry::fun_holder_type, data_type, Arg>(self.template get<data_type>(), arg);
+        }
+    };
+
+    struct relocate_visitor
+    {
+        template<class Entry>
+        static void call(slot& self, slot& other)
+        {
+            using data_type = typename Entry::data_type;
+            auto& data = self.template get<data_type>();
+            new(other.storage) data_type{std::move(data)}; //NOLINT
+            data.~data_type();
+        }
+    };
+
+    struct destroy_visitor
+    {
+        template<class Entry>
+        static void call(slot& self)
+        {
+            using data_type = typename Entry::data_type;
+            self.template get<data_type>().~data_type();
+        }
+    };
+
+    template<class FunHolder, class Data>
+    static bool erased_call(const void* const pdata, Arg arg)
+    {
+        return FunHolder::call(*static_cast<const Data*>(pdata), arg);
+    }
+
+    template<class FunHolder, class Data>
+    static bool erased_is_ready(const void* const pdata, Arg arg)
+    {
+        return fun_holder_is_ready<FunHolder, Data, Arg>(*static_cast<const Data*>(pdata), arg);
+    }
+
+    template<class FunHolder, class Data>
+    static void erased_drop(const void* const pdata, Arg arg)
+    {
+        fun_holder_drop<FunHolder, Data, Arg>(*static_cast<const Data*>(pdata), arg);
+    }
+
+    template<class Data>
+    static void erased_destroy(const void* const pdata, large_data_storage_type& storage) noexcept
+    {
+        storage.destroy(static_cast<const Data*>(pdata));
+    }
+
+    template<class FunHolder, class Data>
+    static constexpr auto erased_ops_of = erased_ops
+    {
+        &erased_call<FunHolder, Data>,
+        &erased_is_ready<FunHolder, Data>,
+        &erased_drop<FunHolder, Data>,
+        &erased_destroy<Data>
+    };
+
+    ring_buffer<slot> slots_;
+    large_data_storage_type large_data_storage_;
+};
+
+/*
+The list of the `typed_function_queue_entry<FunHolder, Data>` types, for each
+type `Data` of the type set `DataTypeSet` that is accepted by
+`typed_function_queue` and that is no larger than MaxSize and MaxAlign.
+
+If `DataTypeSet` is an exclusion list, the list is empty (all the calls are
+then stored in the `large_data_storage`).
+*/
+template<class FunHolder, class DataTypeSet, std::size_t MaxSize, std::size_t MaxAlign>
+struct typed_function_queue_entry_list
+{
+    using type = type_list_t<>;
+};
+
+template<class FunHolder, class Data, std::size_t MaxSize, std::size_t MaxAlign>
+struct typed_function_queue_entry_list<FunHolder, type_set_item<Data>, MaxSize, MaxAlign>:
+    typed_function_queue_entry_list<FunHolder, type_set_inclusion_list<Data>, MaxSize, MaxAlign>
+{
+};
+
+template<class FunHolder, class... Datas, std::size_t MaxSize, std::size_t MaxAlign>
+struct typed_function_queue_entry_list<FunHolder, type_set_inclusion_list<Datas...>, MaxSize, MaxAlign>
+{
+    template<class Entry>
+    struct is_eligible
+    {
+        using data_type = typename Entry::data_type;
+
+        static constexpr auto value =
+            typed_function_queue_accepts_v<Entry> &&
+            sizeof(data_type) <= MaxSize &&
+            alignof(data_type) <= MaxAlign
+        ;
+    };
+
+    using type = tlu::filter_t
+    <
+        type_list_t<typed_function_queue_entry<FunHolder, Datas>...>,
+        is_eligible
+    >;
+};
+
+template<class FunHolder, class DataTypeSet, std::size_t MaxSize, std::size_t MaxAlign>
+using typed_function_queue_entry_list_t = typename typed_function_queue_entry_list
+<
+    FunHolder,
+    DataTypeSet,
+    MaxSize,
+    MaxAlign
+>::type;
+
+} //namespace
+
+#endif
@@ -0,0 +1,47 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+/**
+@file
+@brief Defines the maki::dispatch_strategy enum
+*/
+
+#ifndef MAKI_DISPATCH_STRATEGY_HPP
+#define MAKI_DISPATCH_STRATEGY_HPP
+
+namespace maki
+{
+
+/**
+@brief The way a region finds its active state whenever it has to forward a
+call to it (e.g. to process an event or to exit the active state).
+
+@see maki::machine_conf::dispatch_strategy()
+*/
+enum class dispatch_strategy: char
+{
+    /**
+    The index of the active state is compared to the index of every candidate
+    state, one by one. This is the default.
+
+    The generated code is fully inlinable, which makes it the fastest strategy
+    for regions made of a few states.
+    */
+    linear,
+
+    /**
+    The index of the active state is used to index a `constexpr` table of
+    function pointers, which gives an O(1) lookup.
+
+    This is the fastest strategy for regions made of many states, as the cost
+    of the indirect call doesn't depend on the number of states.
+    */
+    jump_table
+};
+
+} //namespace
+
+#endif
@@ -0,0 +1,134 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+/**
+@file
+@brief Defines the maki::latency_histogram and maki::latency_profile_entry
+structs
+*/
+
+#ifndef MAKI_LATENCY_PROFILE_HPP
+#define MAKI_LATENCY_PROFILE_HPP
+
+#include <array>
+#include <chrono>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+namespace maki
+{
+
+/**
+@brief A histogram of durations, with power-of-two buckets.
+
+The bucket at index `i` counts the durations `d` such that
+`2^i <= d.count() < 2^(i+1)` nanoseconds. The first bucket also counts zero
+durations, and the last one also counts longer durations.
+*/
+struct latency_histogram
+{
+    /**
+    @brief The number of buckets.
+    */
+    static constexpr std::size_t bucket_count = 40;
+
+    /**
+    @brief Adds a duration.
+    */
+    void add(const std::chrono::nanoseconds duration)
+    {
+        const auto ns = duration.count() > 0 ? static_cast<std::uint64_t>(duration.count()) : std::uint64_t{0};
+
+        auto bucket_index = std::size_t{0};
+        for(auto value = ns >> 1U; value != 0 && bucket_index + 1 != bucket_count; value >>= 1U)
+        {
+            ++bucket_index;
+        }
+        ++bucket_counts[bucket_index]; //NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
+
+        ++count;
+        total_duration += duration;
+        if(duration > max_duration)
+        {
+            max_duration = duration;
+        }
+    }
+
+    /**
+    @brief Returns an upper bound of the given percentile (e.g. `0.99`) of
+    the added durations, i.e. the upper limit of the bucket that contains it.
+    */
+    [[nodiscard]] std::chrono::nanoseconds percentile(const double ratio) const
+    {
+        const auto rank = static_cast<double>(count) * ratio;
+        auto cumulated_count = std::uint64_t{0};
+        for(auto i = std::size_t{0}; i != bucket_count; ++i)
+        {
+            cumulated_count += bucket_counts[i]; //NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
+            if(cumulated_count != 0 && static_cast<double>(cumulated_count) >= rank)
+            {
+                const auto upper_limit = std::chrono::nanoseconds{std::chrono::nanoseconds::rep{2} << i};
+                return upper_limit < max_duration ? upper_limit : max_duration;
+            }
+        }
+        return max_duration;
+    }
+
+    /**
+    @brief Returns the mean of the added durations.
+    */
+    [[nodiscard]] std::chrono::nanoseconds mean() const
+    {
+        if(count == 0)
+        {
+            return std::chrono::nanoseconds{0};
+        }
+        return total_duration / static_cast<std::chrono::nanoseconds::rep>(count);
+    }
+
+    /**
+    @brief The number of durations that fall into each bucket.
+    */
+    std::array<std::uint64_t, bucket_count> bucket_counts{};
+
+    /**
+    @brief The number of added durations.
+    */
+    std::uint64_t count = 0;
+
+    /**
+    @brief The sum of the added durations.
+    */
+    std::chrono::nanoseconds total_duration{0};
+
+    /**
+    @brief The longest added duration.
+    */
+    std::chrono::nanoseconds max_duration{0};
+};
+
+/**
+@brief The latencies of one piece of user code called by a machine (see
+`maki::machine_conf::latency_profiling()`).
+*/
+struct latency_profile_entry
+{
+    /**
+    @brief A description of the piece of user code and of where it's called
+    from, e.g. `guard of 0/on/0: red -> green`.
+    */
+    std::string site;
+
+    /**
+    @brief The durations of the calls.
+    */
+    latency_histogram histogram;
+};
+
+} //namespace
+
+#endif
@@ -16,18 +16,40 @@
 #include "events.hpp"
 #include "null.hpp"
 #include "detail/path_impl.hpp"
+#include "detail/async_actions.hpp"
 #include "detail/state_impls/simple.hpp" //NOLINT misc-include-cleaner
 #include "detail/state_impls/composite.hpp" //NOLINT misc-include-cleaner
 #include "detail/state_impls/composite_no_context.hpp"
 #include "detail/context_holder.hpp"
+#include "detail/flat_leaf_list.hpp"
+#include "detail/smallest_int.hpp"
+#include "detail/type_list.hpp"
 #include "detail/context_storage.hpp"
 #include "detail/event_action.hpp"
+#include "detail/event_coalescing.hpp"
+#include "detail/expiring_event.hpp"
 #include "detail/noinline.hpp"
+#include "detail/operation_budget.hpp"
 #include "detail/function_queue.hpp"
+#include "detail/latency_profiling.hpp"
+#include "detail/metrics.hpp"
+#include "detail/mpsc_inbox.hpp"
+#include "detail/priority_function_queue.hpp"
+#include "detail/queue_statistics.hpp"
+#include "detail/state_waiter.hpp"
+#include "detail/trace.hpp"
+#include "detail/typed_function_queue.hpp"
 #include "detail/mix.hpp"
+#include "detail/tlu/call_at.hpp"
 #include "detail/tlu/contains_if.hpp"
+#include "detail/tlu/empty.hpp"
+#include "detail/tlu/size.hpp"
 #include <type_traits>
 #include <exception>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
 
 namespace maki
 {
@@ -40,6 +62,9 @@ namespace detail
         stop,
         process_event
     };
+
+    template<class Machine>
+    struct runtime_entry;
 }
 
 #define MAKI_DETAIL_MAYBE_CATCH(statement) /*NOLINT(cppcoreguidelines-macro-usage)*/ \
@@ -117,8 +142,24 @@ public:
     template<class... ContextArgs>
     explicit machine(ContextArgs&&... ctx_args):
         ctx_holder_(*this, std::forward<ContextArgs>(ctx_args)...),
-        impl_(*this, context())
+        impl_(*this, context()),
+        rtc_queue_(impl_of(conf).large_event_allocator),
+        event_deferral_queue_(impl_of(conf).large_event_allocator),
+        inbox_(impl_of(conf).post_event_capacity)
     {
+        if constexpr(impl_of(conf).event_queue_capacity != 0)
+        {
+            if constexpr(impl_of(conf).run_to_completion)
+            {
+                rtc_queue_.reserve(impl_of(conf).event_queue_capacity);
+            }
+
+            if constexpr(has_deferrable_events)
+            {
+                event_deferral_queue_.reserve(impl_of(conf).event_queue_capacity);
+            }
+        }
+
         if constexpr(impl_of(conf).auto_start)
         {
             MAKI_DETAIL_MAYBE_CATCH(start_now())
@@ -304,267 +345,1822 @@ public:
 
     This function is slightly faster than @ref process_event(), but if you're
     not sure what you're doing, just call @ref process_event() instead.
+
+    Returns `false` if the event has been rejected because the
+    run-to-completion queue is full (see
+    `maki::machine_conf::event_queue_max_size()`) or because an exception has
+    been caught; `true` otherwise.
     */
     template<class Event>
-    MAKI_NOINLINE void push_event(const Event& event)
+    MAKI_NOINLINE bool push_event(const Event& event)
     {
-        MAKI_DETAIL_MAYBE_CATCH(push_event_no_catch(event))
+        auto pushed = false;
+        MAKI_DETAIL_MAYBE_CATCH(pushed = push_event_no_catch(event))
+        return pushed;
     }
 
     /**
-    @brief Returns the `maki::region` object at index `Index`.
+    @brief Like `push_event(event)`, but gives the event the priority
+    `priority` instead of the priority of its type (see
+    `maki::machine_conf::event_priority()`).
+
+    `priority` must be lower than `maki::machine_conf::event_priority_count()`,
+    which must be greater than 1.
     */
-    template<int Index>
-    [[nodiscard]] const auto& region() const
+    template<class Event>
+    MAKI_NOINLINE bool push_event(const Event& event, const int priority)
     {
-        return impl_.template region<Index>();
+        auto pushed = false;
+        MAKI_DETAIL_MAYBE_CATCH((pushed = push_event_no_catch(event, priority)))
+        return pushed;
     }
 
     /**
-    @brief Returns the `maki::state` object created by `StateMold` (of type
-    `maki::state_mold`). Only valid if machine is only made of one region.
+    @brief Like `push_event(event)`, but the event expires at `deadline`.
+
+    An expired event is dropped instead of being processed when it's dequeued,
+    either from the run-to-completion queue or from the event deferral queue.
+    Note that the deferred events are only dequeued when an active state that
+    defers events is exited, or when they're cancelled (see
+    `cancel_events()`).
+
+    An expiring event is never coalesced (see
+    `maki::machine_conf::coalesce()`).
     */
-    template<const auto& StateMold>
-    [[nodiscard]] const auto& state() const
+    template<class Event>
+    MAKI_NOINLINE bool push_event(const Event& event, const std::chrono::steady_clock::time_point deadline)
     {
-        return impl_.template state<StateMold>();
+        auto pushed = false;
+        MAKI_DETAIL_MAYBE_CATCH((pushed = push_event_no_catch(event, deadline)))
+        return pushed;
     }
 
     /**
-    @brief Returns whether the state created by `StateMold` is active in the
-    region of the state machine. Only valid if machine is only made of one
-    region.
+    @brief Removes all the events of type `Event` from the run-to-completion
+    queue and from the event deferral queue, without processing them.
+    @return the number of removed events
+
+    This is useful for getting rid of stale events, such as the requests that
+    have been deferred before a reconnection.
     */
-    template<const auto& StateMold>
-    [[nodiscard]] bool is() const
+    template<class Event>
+    std::size_t cancel_events()
     {
-        return impl_.template is<StateMold>();
+        return cancel_events_if<Event>
+        (
+            [](const Event& /*event*/)
+            {
+                return true;
+            }
+        );
     }
 
-private:
-    static constexpr auto path = detail::path_impl{};
-    using impl_type =
-        detail::state_impls::composite_no_context
-        <
-            &conf,
-            path,
-            detail::context_storage::plain
-        >
-    ;
-
-    using deferrable_event_type_set =
-        typename impl_type::deferrable_event_type_set
-    ;
-
-    static constexpr bool has_deferrable_events =
-        !detail::type_set_empty_v<deferrable_event_type_set>
-    ;
-
-    class executing_operation_guard
+    /**
+    @brief Like `cancel_events()`, but only removes the events for which
+    `pred(event)` returns `true`.
+    @return the number of removed events
+    */
+    template<class Event, class Predicate>
+    std::size_t cancel_events_if(const Predicate& pred)
     {
-    public:
-        executing_operation_guard(machine& self):
-            self_(self)
-        {
-            self_.executing_operation_ = true;
-        }
+        auto removed_count = std::size_t{0};
 
-        executing_operation_guard(const executing_operation_guard&) = delete;
-        executing_operation_guard(executing_operation_guard&&) = delete;
-        executing_operation_guard& operator=(const executing_operation_guard&) = delete;
-        executing_operation_guard& operator=(executing_operation_guard&&) = delete;
-
-        ~executing_operation_guard()
+        if constexpr(impl_of(conf).run_to_completion)
         {
-            self_.executing_operation_ = false;
+            removed_count += cancel_queued_events
+            <
+                Event,
+                any_event_visitor<detail::machine_operation::process_event>
+            >(rtc_queue_, rtc_coalesced_events_, pred);
         }
 
-    private:
-        machine& self_; //NOLINT(cppcoreguidelines-avoid-const-or-ref-data-members)
-    };
-
-    struct real_function_queue_holder
-    {
-        template<bool = true> //Dummy template for lazy evaluation
-        using type = detail::function_queue
-        <
-            machine&,
-            impl_of(conf).small_event_max_size,
-            impl_of(conf).small_event_max_align
-        >;
-    };
-
-    struct empty_holder
-    {
-        template<bool = true> //Dummy template for lazy evaluation
-        struct type{};
-    };
-
-    using rtc_queue_type = typename std::conditional_t
-    <
-        impl_of(conf).run_to_completion,
-        real_function_queue_holder,
-        empty_holder
-    >::template type<>;
-
-    using event_deferral_queue_type = typename std::conditional_t
-    <
-        has_deferrable_events,
-        real_function_queue_holder,
-        empty_holder
-    >::template type<>;
-
-    template<detail::machine_operation Operation>
-    struct any_event_visitor
-    {
-        template<class Event>
-        static bool call(const Event& event, machine& self)
+        if constexpr(detail::type_set_contains_v<deferrable_event_type_set, Event>)
         {
-            return self.execute_one_operation<Operation>(event);
+            removed_count += cancel_queued_events<Event, deferred_event_visitor>
+            (
+                event_deferral_queue_,
+                deferred_coalesced_events_,
+                pred
+            );
         }
-    };
 
-    void start_now()
-    {
-        execute_operation_now<detail::machine_operation::start>(events::start{});
+        return removed_count;
     }
 
-    template<class Event>
-    void start_no_catch(const Event& event)
-    {
-        if(!running())
-        {
-            execute_operation<detail::machine_operation::start>(event);
-        }
-    }
+    /**
+    @brief Executes at most `max_operation_count` of the operations that have
+    been left pending because of the budget set with
+    `maki::machine_conf::operation_budget()` (i.e. events queued into the
+    run-to-completion queue and attempts to process deferred events).
+    @return `true` if no operation is pending anymore
 
-    template<class Event>
-    void stop_no_catch(const Event& event)
+    Does nothing if called from an action or a hook of the machine.
+    */
+    bool process_pending(const std::size_t max_operation_count)
     {
-        if(running())
-        {
-            execute_operation<detail::machine_operation::stop>(event);
-        }
+        auto budget = detail::operation_count_budget{max_operation_count};
+        MAKI_DETAIL_MAYBE_CATCH(process_pending_no_catch(budget))
+        return !has_pending_operations();
     }
 
-    template<class Event>
-    void process_event_now_no_catch(const Event& event)
+    /**
+    @brief Like `process_pending()`, but executes pending operations until
+    `deadline` is reached instead of executing a given number of operations.
+    @return `true` if no operation is pending anymore
+
+    The clock is read before each operation. An operation that starts before
+    the deadline isn't interrupted.
+    */
+    template<class Clock, class Duration>
+    bool process_pending_until(const std::chrono::time_point<Clock, Duration>& deadline)
     {
-        static_assert
-        (
-            impl_of(conf).process_event_now_enabled,
-            "`maki::machine_conf::process_event_now_enabled()` hasn't been set to `true`"
-        );
-        execute_operation_now<detail::machine_operation::process_event>(event);
+        auto budget = detail::operation_deadline_budget<Clock, Duration>{deadline};
+        MAKI_DETAIL_MAYBE_CATCH(process_pending_no_catch(budget))
+        return !has_pending_operations();
     }
 
-    template<detail::machine_operation Operation, class Event>
-    void execute_operation(const Event& event)
+    /**
+    @brief Checks whether some operations have been left pending (see
+    `maki::machine_conf::operation_budget()`), or are waiting for a suspended
+    asynchronous action to complete (see `maki::task`).
+    */
+    [[nodiscard]] bool has_pending_operations() const
     {
         if constexpr(impl_of(conf).run_to_completion)
         {
-            if(!executing_operation_) //If call is not recursive
+            if constexpr(has_deferrable_events)
             {
-                execute_operation_now<Operation>(event);
+                return !rtc_queue_.empty() || deferring_state_exited_;
             }
             else
             {
-                //Push event to RTC queue in case of recursive call
-                push_event_impl<Operation>(event);
+                return !rtc_queue_.empty();
             }
         }
         else
         {
-            execute_one_operation<Operation>(event);
+            return false;
         }
     }
 
-    template<detail::machine_operation Operation, class Event>
-    void execute_operation_now(const Event& event)
-    {
-        if constexpr(impl_of(conf).run_to_completion)
-        {
-            auto grd = executing_operation_guard{*this};
+    /**
+    @brief Checks whether the run-to-completion queue is full, meaning the next
+    event to be queued would trigger the overflow policy (see
+    `maki::machine_conf::event_queue_max_size()`).
 
-            execute_one_operation<Operation>(event);
+    Always returns `false` if the queue is unbounded.
 
-            /*
-            Process enqueued and deferred events, if any.
-            We guarantee order of processing: At any given state configuration,
-            if several pending events can be processed, they're processed in the
-            same order they've been given to the `machine`.
-            */
-            try_processing_deferred_operations();
-            while (!rtc_queue_.empty())
-            {
-                rtc_queue_.invoke_and_pop(*this);
-                try_processing_deferred_operations();
-            }
+    This is a backpressure signal for producers that want to slow down rather
+    than lose events.
+    */
+    [[nodiscard]] bool would_block() const
+    {
+        if constexpr(impl_of(conf).run_to_completion && impl_of(conf).event_queue_max_size != 0)
+        {
+            return rtc_queue_.size() >= impl_of(conf).event_queue_max_size;
         }
         else
         {
-            execute_one_operation<Operation>(event);
-
-            try_processing_deferred_operations();
+            return false;
         }
     }
 
+    /**
+    @brief Posts an event to the inbox of the machine, for it to be processed
+    by the next call to `maki::machine::process_posted_events()`
+    @param event the event to be processed
+    @return `false` if the inbox is full (see
+    `maki::machine_conf::post_event_capacity()`), in which case the event isn't
+    posted
+
+    Unlike every other member function, this function can be called from any
+    thread. It never allocates memory, blocks nor takes any lock.
+
+    `maki::machine_conf::post_event_enabled()` must be set to `true` for this
+    function to be available.
+    */
     template<class Event>
-    MAKI_NOINLINE void push_event_no_catch(const Event& event)
+    bool post_event(const Event& event)
     {
-        static_assert(impl_of(conf).run_to_completion);
-        push_event_impl<detail::machine_operation::process_event>(event);
+        static_assert
+        (
+            impl_of(conf).post_event_enabled,
+            "`maki::machine_conf::post_event_enabled()` hasn't been set to `true`"
+        );
+        return inbox_.template push<posted_event_visitor>(event);
     }
 
-    template<detail::machine_operation Operation, class Event>
-    void push_event_impl(const Event& event)
+    /**
+    @brief Like `post_event(event)`, but calls `on_processed()` once the event
+    has been processed
+    @param event the event to be processed
+    @param on_processed a copyable callable, called without argument by the
+    thread that processes the event, right after `process_event(event)` has
+    returned
+    */
+    template<class Event, class Callback>
+    bool post_event(const Event& event, const Callback& on_processed)
     {
-        rtc_queue_.template push<any_event_visitor<Operation>>(event);
+        static_assert
+        (
+            impl_of(conf).post_event_enabled,
+            "`maki::machine_conf::post_event_enabled()` hasn't been set to `true`"
+        );
+        return inbox_.template push<posted_event_visitor>
+        (
+            posted_event_with_callback<Event, Callback>{event, on_processed}
+        );
     }
 
-    /*
-    Process all previously deferred events that can now be processed.
+    /**
+    @brief Processes the events that have been posted with `post_event()`, in
+    the order they've been posted, by calling `process_event()` on each of them
+    @return the number of processed events
+
+    Must only be called by the thread that owns the machine (i.e. the thread
+    that calls `process_event()`, `start()`, etc.).
+
+    `maki::machine_conf::post_event_enabled()` must be set to `true` for this
+    function to be available.
     */
-    void try_processing_deferred_operations()
+    std::size_t process_posted_events()
     {
-        if constexpr(has_deferrable_events)
-        {
-            /*
-            The inner loop tries to process every deferred event once.
+        static_assert
+        (
+            impl_of(conf).post_event_enabled,
+            "`maki::machine_conf::post_event_enabled()` hasn't been set to `true`"
+        );
+        return inbox_.invoke_and_pop_all(*this);
+    }
 
-            The outer loop executes the inner loop as many times as necessary, that
-            is, until `event_deferral_queue_` only contains events that are still
-            deferred by any of the currently active states.
+    /**
+    @brief Returns the latencies of the pieces of user code that have taken
+    the most time in total, sorted by decreasing total time (see
+    `maki::machine_conf::latency_profiling()`).
+    @param max_count the maximum number of returned entries
+    */
+    [[nodiscard]] std::vector<latency_profile_entry> top_latency_offenders(const std::size_t max_count) const
+    {
+        static_assert
+        (
+            impl_of(conf).latency_profiling,
+            "`maki::machine_conf::latency_profiling()` hasn't been set to `true`"
+        );
+        return latency_profile_.top_offenders(max_count);
+    }
 
-            These two levels are necessary, as processing a previously deferred
-            event can change the active states and allow other events of
-            `event_deferral_queue_` to be processed.
-            */
+    /**
+    @brief Clears the latencies measured so far (see
+    `maki::machine_conf::latency_profiling()`).
+    */
+    void reset_latency_profile()
+    {
+        static_assert
+        (
+            impl_of(conf).latency_profiling,
+            "`maki::machine_conf::latency_profiling()` hasn't been set to `true`"
+        );
+        latency_profile_.reset();
+    }
 
-            auto processing_count = 1;
-            while (processing_count != 0) // Outer loop
-            {
-                processing_count = 0;
-                for (auto i = 0U; i < event_deferral_queue_.size(); ++i) // Inner loop
-                {
-                    processing_count += static_cast<int>(event_deferral_queue_.invoke_and_pop(*this));
-                }
-            }
+    /**
+    @brief Returns the number of operations in the run-to-completion queue
+    (see `maki::machine_conf::queue_statistics()`).
+    */
+    [[nodiscard]] std::size_t rtc_queue_depth() const
+    {
+        static_assert
+        (
+            impl_of(conf).queue_statistics,
+            "`maki::machine_conf::queue_statistics()` hasn't been set to `true`"
+        );
+        if constexpr(impl_of(conf).run_to_completion)
+        {
+            return rtc_queue_.size();
+        }
+        else
+        {
+            return 0;
         }
     }
 
-    template<detail::machine_operation Operation, class Event>
-    bool execute_one_operation(const Event& event)
+    /**
+    @brief Returns the largest number of operations the run-to-completion
+    queue has held (see `maki::machine_conf::queue_statistics()`).
+    */
+    [[nodiscard]] std::size_t rtc_queue_high_water_mark() const
     {
-        if constexpr(Operation == detail::machine_operation::start)
+        static_assert
+        (
+            impl_of(conf).queue_statistics,
+            "`maki::machine_conf::queue_statistics()` hasn't been set to `true`"
+        );
+        return queue_stats_.rtc_queue.high_water_mark;
+    }
+
+    /**
+    @brief Returns the number of deferred events (see
+    `maki::machine_conf::queue_statistics()`).
+    */
+    [[nodiscard]] std::size_t event_deferral_queue_depth() const
+    {
+        static_assert
+        (
+            impl_of(conf).queue_statistics,
+            "`maki::machine_conf::queue_statistics()` hasn't been set to `true`"
+        );
+        if constexpr(has_deferrable_events)
         {
-            impl_.enter(*this, context(), event);
-            return true;
+            return event_deferral_queue_.size();
         }
-        else if constexpr(Operation == detail::machine_operation::stop)
+        else
         {
-            impl_.exit_to_finals(*this, context(), event);
-            return true;
+            return 0;
+        }
+    }
+
+    /**
+    @brief Returns the largest number of events the event deferral queue has
+    held (see `maki::machine_conf::queue_statistics()`).
+    */
+    [[nodiscard]] std::size_t event_deferral_queue_high_water_mark() const
+    {
+        static_assert
+        (
+            impl_of(conf).queue_statistics,
+            "`maki::machine_conf::queue_statistics()` hasn't been set to `true`"
+        );
+        return queue_stats_.event_deferral_queue.high_water_mark;
+    }
+
+    /**
+    @brief Returns the number of events that the queues couldn't store in
+    place and that have been allocated by the allocator given to
+    `maki::machine_conf::large_event_allocator()` (or with `new`), without the
+    arena of `maki::machine_conf::large_event_arena_size()` (see
+    `maki::machine_conf::queue_statistics()`).
+    */
+    [[nodiscard]] std::uint64_t large_event_allocation_count() const
+    {
+        static_assert
+        (
+            impl_of(conf).queue_statistics,
+            "`maki::machine_conf::queue_statistics()` hasn't been set to `true`"
+        );
+        return total_large_event_allocation_count() - queue_stats_.large_event_allocation_count_offset;
+    }
+
+    /**
+    @brief Returns the number of times deferred events have been tried again,
+    whether they've been processed or are still deferred (see
+    `maki::machine_conf::queue_statistics()`).
+
+    A count that grows much faster than the number of processed events reveals
+    events that are repeatedly deferred.
+    */
+    [[nodiscard]] std::uint64_t deferral_retry_count() const
+    {
+        static_assert
+        (
+            impl_of(conf).queue_statistics,
+            "`maki::machine_conf::queue_statistics()` hasn't been set to `true`"
+        );
+        return queue_stats_.deferral_retry_count;
+    }
+
+    /**
+    @brief Returns the histogram of the durations events of type `Event` have
+    spent in the run-to-completion queue, from their enqueuing to their
+    dispatch (see `maki::machine_conf::queue_statistics()`).
+
+    Events that are processed without being queued aren't counted.
+    */
+    template<class Event>
+    [[nodiscard]] const latency_histogram& rtc_queue_latency() const
+    {
+        static_assert
+        (
+            impl_of(conf).queue_statistics,
+            "`maki::machine_conf::queue_statistics()` hasn't been set to `true`"
+        );
+        return queue_stats_.rtc_queue.latencies.template of<Event>();
+    }
+
+    /**
+    @brief Like `rtc_queue_latency()`, for the event deferral queue (i.e. from
+    the deferral of the events to their dispatch).
+    */
+    template<class Event>
+    [[nodiscard]] const latency_histogram& event_deferral_queue_latency() const
+    {
+        static_assert
+        (
+            impl_of(conf).queue_statistics,
+            "`maki::machine_conf::queue_statistics()` hasn't been set to `true`"
+        );
+        return queue_stats_.event_deferral_queue.latencies.template of<Event>();
+    }
+
+    /**
+    @brief Resets the queue statistics (see
+    `maki::machine_conf::queue_statistics()`). The high-water marks are set to
+    the current depths of the queues.
+    */
+    void reset_queue_statistics()
+    {
+        static_assert
+        (
+            impl_of(conf).queue_statistics,
+            "`maki::machine_conf::queue_statistics()` hasn't been set to `true`"
+        );
+        queue_stats_.rtc_queue.high_water_mark = rtc_queue_depth();
+        queue_stats_.rtc_queue.latencies.reset();
+        queue_stats_.event_deferral_queue.high_water_mark = event_deferral_queue_depth();
+        queue_stats_.event_deferral_queue.latencies.reset();
+        queue_stats_.deferral_retry_count = 0;
+        queue_stats_.large_event_allocation_count_offset = total_large_event_allocation_count();
+    }
+
+    /**
+    @brief Returns the number of times the state created by `StateMold` has
+    been entered (see `maki::machine_conf::metrics()`).
+
+    If several regions contain the state, the first one, in depth-first order,
+    is considered.
+    */
+    template<const auto& StateMold>
+    [[nodiscard]] std::uint64_t state_entry_count() const
+    {
+        using region_type = metrics_region_of_state_t<StateMold>;
+        constexpr auto index = detail::region_metrics<region_type>::template source_index<&StateMold>();
+        return metrics_.template of<region_type>().state_entry_counts[static_cast<std::size_t>(index)];
+    }
+
+    /**
+    @brief Returns the cumulative time spent in the state created by
+    `StateMold`, including the current activation, if any (see
+    `maki::machine_conf::metrics()`).
+
+    If several regions contain the state, the first one, in depth-first order,
+    is considered.
+    */
+    template<const auto& StateMold>
+    [[nodiscard]] std::chrono::nanoseconds state_dwell_time() const
+    {
+        using region_type = metrics_region_of_state_t<StateMold>;
+        constexpr auto index = detail::region_metrics<region_type>::template source_index<&StateMold>();
+        return metrics_.template of<region_type>().state_dwell_time(index, std::chrono::steady_clock::now());
+    }
+
+    /**
+    @brief Returns the number of times the external transitions from the state
+    created by `SourceStateMold` to the state created by `TargetStateMold` (or
+    to `maki::fin`) have been executed (see `maki::machine_conf::metrics()`).
+
+    If several regions contain the source state, the first one, in depth-first
+    order, is considered.
+    */
+    template<const auto& SourceStateMold, const auto& TargetStateMold>
+    [[nodiscard]] std::uint64_t transition_count() const
+    {
+        using region_type = metrics_region_of_state_t<SourceStateMold>;
+        using region_metrics_type = detail::region_metrics<region_type>;
+        constexpr auto source = region_metrics_type::template source_index<&SourceStateMold>();
+        constexpr auto target = []
+        {
+            if constexpr(detail::is_fin_v<std::decay_t<decltype(TargetStateMold)>>)
+            {
+                return region_metrics_type::final_index;
+            }
+            else
+            {
+                return region_metrics_type::template target_index<&TargetStateMold>();
+            }
+        }();
+        return metrics_.template of<region_type>().transition_counts[region_metrics_type::transition_index(source, target)];
+    }
+
+    /**
+    @brief Returns the number of events that no state or transition has
+    handled (see `maki::machine_conf::metrics()`).
+    */
+    [[nodiscard]] std::uint64_t unhandled_event_count() const
+    {
+        static_assert
+        (
+            impl_of(conf).metrics,
+            "`maki::machine_conf::metrics()` hasn't been set to `true`"
+        );
+        return metrics_.unhandled_event_count;
+    }
+
+    /**
+    @brief Sets all the metrics (see `maki::machine_conf::metrics()`) to zero.
+    */
+    void reset_metrics()
+    {
+        static_assert
+        (
+            impl_of(conf).metrics,
+            "`maki::machine_conf::metrics()` hasn't been set to `true`"
+        );
+        metrics_.reset();
+    }
+
+    /**
+    @brief Pauses or resumes the recording of the activity of the machine (see
+    `maki::machine_conf::tracing()`). Recording is enabled by default.
+    */
+    void set_tracing_enabled(const bool enabled)
+    {
+        static_assert
+        (
+            impl_of(conf).tracing,
+            "`maki::machine_conf::tracing()` hasn't been set to `true`"
+        );
+        trace_.enabled = enabled;
+    }
+
+    /**
+    @brief Returns whether the activity of the machine is being recorded (see
+    `set_tracing_enabled()`).
+    */
+    [[nodiscard]] bool tracing_enabled() const
+    {
+        static_assert
+        (
+            impl_of(conf).tracing,
+            "`maki::machine_conf::tracing()` hasn't been set to `true`"
+        );
+        return trace_.enabled;
+    }
+
+    /**
+    @brief Sets the identifier written into the trace records of the machine
+    (see `maki::trace_record::machine_id`), so that they can be told apart from
+    the records of other machines. Defaults to 0.
+    */
+    void set_trace_id(const std::uint32_t id)
+    {
+        static_assert
+        (
+            impl_of(conf).tracing,
+            "`maki::machine_conf::tracing()` hasn't been set to `true`"
+        );
+        trace_.id = id;
+    }
+
+    /**
+    @brief Returns the `maki::region` object at index `Index`.
+    */
+    template<int Index>
+    [[nodiscard]] const auto& region() const
+    {
+        return impl_.template region<Index>();
+    }
+
+    /**
+    @brief Returns the `maki::state` object created by `StateMold` (of type
+    `maki::state_mold`). Only valid if machine is only made of one region.
+    */
+    template<const auto& StateMold>
+    [[nodiscard]] const auto& state() const
+    {
+        return impl_.template state<StateMold>();
+    }
+
+    /**
+    @brief Returns whether the state created by `StateMold` is active in the
+    region of the state machine. Only valid if machine is only made of one
+    region.
+    */
+    template<const auto& StateMold>
+    [[nodiscard]] bool is() const
+    {
+        return impl_.template is<StateMold>();
+    }
+
+#if MAKI_DETAIL_COROUTINES || defined(MAKI_DETAIL_DOXYGEN)
+    /**
+    @brief Returns an awaitable that suspends the awaiting coroutine until the
+    state created by `StateMold` is active (see `is()`).
+
+    If the state is already active, the coroutine isn't suspended. Otherwise,
+    it's resumed by the thread that processes the transition that activates
+    the state, right after the state has been entered and before any
+    completion transition is executed. Waiting doesn't allocate any memory.
+
+    Only available when compiling with C++20 coroutine support.
+    `maki::machine_conf::until_enabled()` must be set to `true` for this
+    function to be available.
+    */
+    template<const auto& StateMold>
+    [[nodiscard]] auto until()
+    {
+        static_assert
+        (
+            impl_of(conf).until_enabled,
+            "`maki::machine_conf::until_enabled()` hasn't been set to `true`"
+        );
+        return detail::state_awaiter<machine>
+        {
+            *this,
+            [](const machine& self)
+            {
+                return self.template is<StateMold>();
+            }
+        };
+    }
+
+    /**
+    @brief Returns an awaitable that suspends the awaiting coroutine until the
+    machine isn't running anymore (see `running()`), either because it has
+    reached a final state or because it has been stopped.
+
+    Works like `until()`.
+    */
+    [[nodiscard]] auto until_completed()
+    {
+        static_assert
+        (
+            impl_of(conf).until_enabled,
+            "`maki::machine_conf::until_enabled()` hasn't been set to `true`"
+        );
+        return detail::state_awaiter<machine>
+        {
+            *this,
+            [](const machine& self)
+            {
+                return !self.running();
+            }
+        };
+    }
+#endif
+
+private:
+    static constexpr auto path = detail::path_impl{};
+    using impl_type =
+        detail::state_impls::composite_no_context
+        <
+            &conf,
+            path,
+            detail::context_storage::plain
+        >
+    ;
+
+    template<const auto&, const auto&, detail::context_storage>
+    friend class detail::region_impl;
+
+    template<class>
+    friend struct detail::trace_decoding;
+
+    template<class>
+    friend struct detail::metrics_export;
+
+    template<class>
+    friend struct detail::runtime_entry;
+
+#if MAKI_DETAIL_COROUTINES
+    friend class detail::state_awaiter<machine>;
+    friend struct detail::async_action_caller;
+#endif
+
+    /*
+    The leaf states of the flattened hierarchy (see
+    `maki::machine_conf::flattened_dispatch()`), if enabled.
+    */
+    using flat_leaf_list = std::conditional_t
+    <
+        impl_of(conf).flattened_dispatch,
+        detail::flat_leaf_list_t<impl_type>,
+        detail::type_list_t<>
+    >;
+
+    using flat_leaf_index_type = detail::smallest_int_t
+    <
+        detail::unknown_flat_leaf_index,
+        detail::tlu::size_v<flat_leaf_list> - 1
+    >;
+
+    using deferrable_event_type_set =
+        typename impl_type::deferrable_event_type_set
+    ;
+
+    static constexpr bool has_deferrable_events =
+        !detail::type_set_empty_v<deferrable_event_type_set>
+    ;
+
+    /*
+    Whether any action of the machine can be asynchronous (see
+    `maki::task`).
+    */
+    static constexpr bool has_async_actions =
+        impl_of(conf).async_actions_enabled ||
+        detail::has_async_actions_v<impl_type, conf>
+    ;
+
+    class executing_operation_guard
+    {
+    public:
+        executing_operation_guard(machine& self):
+            self_(self)
+        {
+            self_.executing_operation_ = true;
+        }
+
+        executing_operation_guard(const executing_operation_guard&) = delete;
+        executing_operation_guard(executing_operation_guard&&) = delete;
+        executing_operation_guard& operator=(const executing_operation_guard&) = delete;
+        executing_operation_guard& operator=(executing_operation_guard&&) = delete;
+
+        ~executing_operation_guard()
+        {
+            self_.executing_operation_ = false;
+        }
+
+    private:
+        machine& self_; //NOLINT(cppcoreguidelines-avoid-const-or-ref-data-members)
+    };
+
+    template<detail::machine_operation Operation>
+    struct any_event_visitor
+    {
+        template<class Event>
+        static bool call(const Event& event, machine& self)
+        {
+            return self.execute_one_operation<Operation>(event);
+        }
+
+        template<class Event>
+        static bool call(const detail::coalesced_event_marker<Event>& /*marker*/, machine& self)
+        {
+            return self.execute_coalesced_event<Event>(self.rtc_coalesced_events_);
+        }
+
+        template<class Event>
+        static bool call(const detail::expiring_event<Event>& event, machine& self)
+        {
+            if(event.expired())
+            {
+                return false;
+            }
+            return self.execute_expiring_event(event);
+        }
+
+        template<class Data>
+        static bool call(const detail::timestamped_event<Data>& data, machine& self)
+        {
+            self.queue_stats_.rtc_queue.on_dispatch(data);
+            return call(data.data, self);
+        }
+
+        //Called when the marker is dropped to make room in a full queue
+        template<class Event>
+        static void drop(const detail::coalesced_event_marker<Event>& /*marker*/, machine& self)
+        {
+            detail::take_coalesced_event<Event>(self.rtc_coalesced_events_);
+        }
+
+        template<class Data>
+        static void drop(const detail::timestamped_event<Data>& data, machine& self)
+        {
+            detail::fun_holder_drop<any_event_visitor, Data, machine&>(data.data, self);
+        }
+    };
+
+    /*
+    The visitor of `event_deferral_queue_`. Deferred events that are still
+    deferred by the active states aren't ready, so that
+    `function_queue::invoke_or_rotate()` can skip them without copying them
+    back into the queue.
+    */
+    struct deferred_event_visitor
+    {
+        template<class Event>
+        static bool call(const Event& event, machine& self)
+        {
+            return self.execute_one_operation<detail::machine_operation::process_event>(event);
+        }
+
+        template<class Event>
+        static bool call(const detail::coalesced_event_marker<Event>& /*marker*/, machine& self)
+        {
+            return self.execute_coalesced_event<Event>(self.deferred_coalesced_events_);
+        }
+
+        template<class Event>
+        static bool call(const detail::expiring_event<Event>& event, machine& self)
+        {
+            if(event.expired())
+            {
+                return false;
+            }
+            return self.execute_expiring_event(event);
+        }
+
+        template<class Data>
+        static bool call(const detail::timestamped_event<Data>& data, machine& self)
+        {
+            self.queue_stats_.event_deferral_queue.on_dispatch(data);
+            return call(data.data, self);
+        }
+
+        template<class Event>
+        static void drop(const detail::coalesced_event_marker<Event>& /*marker*/, machine& self)
+        {
+            detail::take_coalesced_event<Event>(self.deferred_coalesced_events_);
+        }
+
+        template<class Data>
+        static void drop(const detail::timestamped_event<Data>& data, machine& self)
+        {
+            detail::fun_holder_drop<deferred_event_visitor, Data, machine&>(data.data, self);
+        }
+
+        template<class Event>
+        static bool is_ready(const Event& /*event*/, machine& self)
+        {
+            return !self.impl_.template defers_event<Event>();
+        }
+
+        template<class Event>
+        static bool is_ready(const detail::coalesced_event_marker<Event>& /*marker*/, machine& self)
+        {
+            return !self.impl_.template defers_event<Event>();
+        }
+
+        //Expired events are ready to be dropped
+        template<class Event>
+        static bool is_ready(const detail::expiring_event<Event>& event, machine& self)
+        {
+            return event.expired() || !self.impl_.template defers_event<Event>();
+        }
+
+        template<class Data>
+        static bool is_ready(const detail::timestamped_event<Data>& data, machine& self)
+        {
+            return detail::fun_holder_is_ready<deferred_event_visitor, Data, machine&>(data.data, self);
+        }
+    };
+
+    template<class Event, class Callback>
+    struct posted_event_with_callback
+    {
+        Event event;
+        Callback on_processed;
+    };
+
+    struct posted_event_visitor
+    {
+        template<class Event>
+        static void call(const Event& event, machine& self)
+        {
+            self.process_event(event);
+        }
+
+        template<class Event, class Callback>
+        static void call(const posted_event_with_callback<Event, Callback>& posted, machine& self)
+        {
+            self.process_event(posted.event);
+            posted.on_processed();
+        }
+    };
+
+    /*
+    Posts `data` into the inbox. Calls `on_reserved()` once `data` is sure to
+    be posted, before it can be processed (see `maki::runtime`).
+    */
+    template<class Data, class OnReserved>
+    bool post_into_inbox(const Data& data, const OnReserved& on_reserved)
+    {
+        return inbox_.template push<posted_event_visitor>(data, on_reserved);
+    }
+
+    struct real_inbox_holder
+    {
+        template<bool = true> //Dummy template for lazy evaluation
+        using type = detail::mpsc_inbox
+        <
+            machine&,
+            impl_of(conf).small_event_max_size,
+            impl_of(conf).small_event_max_align
+        >;
+    };
+
+    struct empty_inbox_holder
+    {
+        template<bool = true> //Dummy template for lazy evaluation
+        struct type
+        {
+            explicit type(std::size_t /*capacity*/)
+            {
+            }
+        };
+    };
+
+    using inbox_type = typename std::conditional_t
+    <
+        impl_of(conf).post_event_enabled,
+        real_inbox_holder,
+        empty_inbox_holder
+    >::template type<>;
+
+    using large_event_allocator_type = std::decay_t<decltype(impl_of(conf).large_event_allocator)>;
+
+    template<std::size_t LargeEventArenaSize>
+    struct real_function_queue_holder
+    {
+        template<bool = true> //Dummy template for lazy evaluation
+        using type = detail::function_queue
+        <
+            machine&,
+            impl_of(conf).small_event_max_size,
+            impl_of(conf).small_event_max_align,
+            large_event_allocator_type,
+            LargeEventArenaSize,
+            impl_of(conf).queue_statistics
+        >;
+    };
+
+    /*
+    The set of the types of the data stored in the event queues, given the set
+    of the types of the data pushed into them (see `push_into_rtc_queue()`).
+    */
+    template<class DataTypeSet>
+    using queued_data_type_set_t = std::conditional_t
+    <
+        impl_of(conf).queue_statistics,
+        detail::timestamped_event_type_set_t<DataTypeSet>,
+        DataTypeSet
+    >;
+
+    template<class FunHolder, class EventTypeSet, std::size_t LargeEventArenaSize>
+    struct typed_function_queue_holder
+    {
+        template<bool = true> //Dummy template for lazy evaluation
+        using type = detail::typed_function_queue
+        <
+            machine&,
+            detail::typed_function_queue_entry_list_t
+            <
+                FunHolder,
+                queued_data_type_set_t<EventTypeSet>,
+                impl_of(conf).small_event_max_size,
+                impl_of(conf).small_event_max_align
+            >,
+            large_event_allocator_type,
+            LargeEventArenaSize,
+            impl_of(conf).queue_statistics
+        >;
+    };
+
+    /*
+    Note: Only the RTC queue uses the large event arena, as the events of the
+    deferral queue can be kept indefinitely (which would prevent the arena from
+    being reclaimed).
+    */
+    template<class FunHolder, class EventTypeSet, std::size_t LargeEventArenaSize>
+    using function_queue_holder = std::conditional_t
+    <
+        impl_of(conf).typed_event_queues,
+        typed_function_queue_holder<FunHolder, EventTypeSet, LargeEventArenaSize>,
+        real_function_queue_holder<LargeEventArenaSize>
+    >;
+
+    struct empty_holder
+    {
+        template<bool = true> //Dummy template for lazy evaluation
+        struct type
+        {
+            explicit type(const large_event_allocator_type& /*alloc*/)
+            {
+            }
+        };
+    };
+
+    template<class QueueHolder>
+    struct priority_function_queue_holder
+    {
+        template<bool = true> //Dummy template for lazy evaluation
+        using type = detail::priority_function_queue
+        <
+            typename QueueHolder::template type<>,
+            impl_of(conf).event_priority_count
+        >;
+    };
+
+    static constexpr auto event_priority_count = impl_of(conf).event_priority_count;
+
+    static_assert
+    (
+        event_priority_count >= 1,
+        "`maki::machine_conf::event_priority_count()` must be at least 1"
+    );
+
+    template<class Event>
+    static constexpr auto event_priority = detail::event_priority_of<Event>(impl_of(conf).event_priorities);
+
+    static constexpr auto event_coalescings = impl_of(conf).event_coalescings;
+
+    using event_coalescing_mix_type = std::decay_t<decltype(event_coalescings)>;
+
+    template<class Event>
+    static constexpr auto is_coalesced_event = detail::is_coalesced_event_v<Event, event_coalescing_mix_type>;
+
+    using coalesced_event_slot_mix_type = detail::coalesced_event_slot_mix_t<event_coalescing_mix_type>;
+
+    using coalesced_event_marker_type_set = detail::coalesced_event_marker_type_set_t<event_coalescing_mix_type>;
+
+    using rtc_function_queue_holder = function_queue_holder
+    <
+        any_event_visitor<detail::machine_operation::process_event>,
+        detail::type_set_union_t
+        <
+            typename impl_type::event_type_set,
+            coalesced_event_marker_type_set
+        >,
+        impl_of(conf).large_event_arena_size
+    >;
+
+    using rtc_queue_type = typename std::conditional_t
+    <
+        impl_of(conf).run_to_completion,
+        std::conditional_t
+        <
+            (event_priority_count > 1),
+            priority_function_queue_holder<rtc_function_queue_holder>,
+            rtc_function_queue_holder
+        >,
+        empty_holder
+    >::template type<>;
+
+    using event_deferral_queue_type = typename std::conditional_t
+    <
+        has_deferrable_events,
+        function_queue_holder
+        <
+            deferred_event_visitor,
+            detail::type_set_union_t
+            <
+                deferrable_event_type_set,
+                coalesced_event_marker_type_set
+            >,
+            0
+        >,
+        empty_holder
+    >::template type<>;
+
+    void start_now()
+    {
+        execute_operation_now<detail::machine_operation::start>(events::start{});
+    }
+
+    template<class Event>
+    void start_no_catch(const Event& event)
+    {
+        if(!running())
+        {
+            execute_operation<detail::machine_operation::start>(event);
+        }
+    }
+
+    template<class Event>
+    void stop_no_catch(const Event& event)
+    {
+        if(running())
+        {
+            execute_operation<detail::machine_operation::stop>(event);
+        }
+    }
+
+    template<class Event>
+    void process_event_now_no_catch(const Event& event)
+    {
+        static_assert
+        (
+            impl_of(conf).process_event_now_enabled,
+            "`maki::machine_conf::process_event_now_enabled()` hasn't been set to `true`"
+        );
+        execute_operation_now<detail::machine_operation::process_event>(event);
+    }
+
+    template<detail::machine_operation Operation, class Event>
+    void execute_operation(const Event& event)
+    {
+        if constexpr(impl_of(conf).run_to_completion)
+        {
+            if(!executing_operation_ && !operations_suspended()) //If call is not recursive
+            {
+                execute_operation_now<Operation>(event);
+            }
+            else
+            {
+                //Push event to RTC queue in case of recursive call (or
+                //suspended asynchronous action)
+                push_event_impl<Operation>(event);
+            }
+        }
+        else
+        {
+            execute_one_operation<Operation>(event);
+        }
+    }
+
+    template<detail::machine_operation Operation, class Event>
+    void execute_operation_now(const Event& event)
+    {
+        if constexpr(impl_of(conf).run_to_completion)
+        {
+            auto grd = executing_operation_guard{*this};
+
+            if constexpr(impl_of(conf).operation_budget != 0)
+            {
+                /*
+                Don't overtake the operations left pending by a previous call
+                whose budget has been exhausted.
+                */
+                if(has_pending_operations())
+                {
+                    push_event_impl<Operation>(event);
+                    process_pending_operations();
+                    return;
+                }
+            }
+
+            execute_one_operation<Operation>(event);
+
+            process_pending_operations();
+        }
+        else
+        {
+            static_assert
+            (
+                impl_of(conf).operation_budget == 0,
+                "`maki::machine_conf::operation_budget()` requires `maki::machine_conf::run_to_completion()` to be set to `true`"
+            );
+
+            execute_one_operation<Operation>(event);
+
+            try_processing_deferred_operations();
+        }
+    }
+
+    //Calls `process_pending_operations(budget)` with the budget given to
+    //`maki::machine_conf::operation_budget()`, if any.
+    void process_pending_operations()
+    {
+        if constexpr(impl_of(conf).operation_budget != 0)
+        {
+            auto budget = detail::operation_count_budget{impl_of(conf).operation_budget};
+            process_pending_operations(budget);
+        }
+        else
+        {
+            auto budget = detail::unlimited_operation_budget{};
+            process_pending_operations(budget);
+        }
+    }
+
+    /*
+    Process enqueued and deferred events, if any.
+    We guarantee order of processing: At any given state configuration, if
+    several pending events can be processed, they're processed in the same order
+    they've been given to the `machine`.
+    Stops as soon as an asynchronous action is suspended, or as soon as
+    `budget` is exhausted.
+    */
+    template<class Budget>
+    void process_pending_operations(Budget& budget)
+    {
+        if constexpr(impl_of(conf).tracing)
+        {
+            if(trace_.enabled && has_pending_operations())
+            {
+                trace_operation(trace_record_kind::rtc_drain_begin);
+                process_pending_operations_2(budget);
+                trace_operation(trace_record_kind::rtc_drain_end);
+                return;
+            }
+        }
+
+        process_pending_operations_2(budget);
+    }
+
+    template<class Budget>
+    void process_pending_operations_2(Budget& budget)
+    {
+        while(!operations_suspended())
+        {
+            if(!try_processing_deferred_operations(budget))
+            {
+                return;
+            }
+
+            if(operations_suspended() || rtc_queue_.empty() || !budget.consume())
+            {
+                return;
+            }
+
+            rtc_queue_.invoke_and_pop(*this);
+        }
+    }
+
+    template<class Budget>
+    void process_pending_no_catch(Budget& budget)
+    {
+        static_assert
+        (
+            impl_of(conf).run_to_completion,
+            "`maki::machine_conf::run_to_completion()` must be set to `true`"
+        );
+
+        if(executing_operation_ || operations_suspended())
+        {
+            return;
+        }
+
+        auto grd = executing_operation_guard{*this};
+        process_pending_operations(budget);
+    }
+
+    /*
+    Whether an asynchronous action (see `maki::task`) is suspended, in which
+    case no operation must be executed.
+    */
+    [[nodiscard]] bool operations_suspended() const
+    {
+#if MAKI_DETAIL_COROUTINES
+        if constexpr(has_async_actions)
+        {
+            return suspended_async_action_count_ != 0;
+        }
+        else
+#endif
+        {
+            return false;
+        }
+    }
+
+#if MAKI_DETAIL_COROUTINES
+    //Called by `detail::async_action_caller`
+    void on_async_action_suspension()
+    {
+        static_assert
+        (
+            impl_of(conf).run_to_completion,
+            "Asynchronous actions require `maki::machine_conf::run_to_completion()` to be set to `true`"
+        );
+        ++suspended_async_action_count_;
+    }
+
+    //Called by the coroutine of the action, from the thread that resumed it
+    static void on_async_action_completion(void* const pself, const std::exception_ptr& eptr) noexcept
+    {
+        static_cast<machine*>(pself)->on_async_action_completion(eptr);
+    }
+
+    void on_async_action_completion(const std::exception_ptr& eptr) noexcept
+    {
+        --suspended_async_action_count_;
+
+        if(eptr)
+        {
+            MAKI_DETAIL_MAYBE_CATCH(std::rethrow_exception(eptr))
+        }
+
+        /*
+        Resume the processing of the pending events, unless the action has
+        been resumed by an operation of this machine (in which case that
+        operation does it).
+        */
+        if(!executing_operation_ && !operations_suspended())
+        {
+            MAKI_DETAIL_MAYBE_CATCH(resume_pending_operations())
+        }
+    }
+
+    void resume_pending_operations()
+    {
+        auto grd = executing_operation_guard{*this};
+        process_pending_operations();
+    }
+#endif
+
+    template<const auto& StateMold>
+    static constexpr auto metrics_region_of_state()
+    {
+        static_assert
+        (
+            impl_of(conf).metrics,
+            "`maki::machine_conf::metrics()` hasn't been set to `true`"
+        );
+
+        using region_type = typename detail::region_of_state
+        <
+            detail::region_list_t<impl_type>,
+            StateMold
+        >::type;
+
+        static_assert
+        (
+            !std::is_void_v<region_type>,
+            "No region of the machine contains the given state"
+        );
+
+        return detail::type<region_type>;
+    }
+
+    template<const auto& StateMold>
+    using metrics_region_of_state_t = typename decltype(metrics_region_of_state<StateMold>())::type;
+
+    //Called by the regions, after every external transition
+    template<class Region, auto SourceStateId, auto TargetStateId>
+    void record_external_transition_metrics()
+    {
+        metrics_.template of<Region>().template on_external_transition<SourceStateId, TargetStateId>
+        (
+            std::chrono::steady_clock::now()
+        );
+    }
+
+    //Called by the regions, before every external transition
+    template<class Region, auto SourceStateId, auto TargetStateId, class Event>
+    void trace_external_transition() const
+    {
+        if(!trace_.enabled)
+        {
+            return;
+        }
+
+        using event_type_list = detail::trace_event_type_list_t<typename impl_type::event_type_set>;
+
+        auto record = trace_record{};
+        record.timestamp = detail::trace_timestamp();
+        record.machine_id = trace_.id;
+        record.region_index = static_cast<std::uint16_t>(detail::tlu::find_v<detail::region_list_t<impl_type>, Region>);
+        record.event_type_index = detail::trace_event_type_index<event_type_list, Event>();
+        record.source_state_index = detail::trace_state_index<Region, SourceStateId>();
+        record.target_state_index = detail::trace_state_index<Region, TargetStateId>();
+        trace_buffer::this_thread().push(record);
+    }
+
+    [[nodiscard]] std::uint64_t total_large_event_allocation_count() const
+    {
+        auto count = std::uint64_t{0};
+        if constexpr(impl_of(conf).run_to_completion)
+        {
+            count += rtc_queue_.large_data_allocation_count();
+        }
+        if constexpr(has_deferrable_events)
+        {
+            count += event_deferral_queue_.large_data_allocation_count();
+        }
+        return count;
+    }
+
+    //Called before processing every event, and around every drain of the
+    //pending operations
+    void trace_operation
+    (
+        const trace_record_kind kind,
+        const std::uint16_t event_type_index = trace_record::none_index
+    ) const
+    {
+        auto record = trace_record{};
+        record.timestamp = detail::trace_timestamp();
+        record.machine_id = trace_.id;
+        record.region_index = trace_record::none_index;
+        record.event_type_index = event_type_index;
+        record.kind = kind;
+        trace_buffer::this_thread().push(record);
+    }
+
+    template<class Event>
+    MAKI_NOINLINE bool push_event_no_catch(const Event& event)
+    {
+        static_assert(impl_of(conf).run_to_completion);
+        return push_event_impl<detail::machine_operation::process_event>(event);
+    }
+
+    template<class Event>
+    MAKI_NOINLINE bool push_event_no_catch(const Event& event, const int priority)
+    {
+        static_assert(impl_of(conf).run_to_completion);
+        static_assert
+        (
+            event_priority_count > 1,
+            "`maki::machine_conf::event_priority_count()` must be greater than 1"
+        );
+        using visitor_type = any_event_visitor<detail::machine_operation::process_event>;
+
+        if constexpr(is_coalesced_event<Event>)
+        {
+            return detail::push_coalesced_event<event_coalescings>
+            (
+                rtc_coalesced_events_,
+                event,
+                [this, &event, priority](const auto& marker)
+                {
+                    if(!make_room(rtc_queue_, event))
+                    {
+                        return false;
+                    }
+                    push_into_rtc_queue<visitor_type>(marker, priority);
+                    return true;
+                }
+            );
+        }
+        else
+        {
+            if(!make_room(rtc_queue_, event))
+            {
+                return false;
+            }
+            push_into_rtc_queue<visitor_type>(event, priority);
+            return true;
+        }
+    }
+
+    template<class Event>
+    MAKI_NOINLINE bool push_event_no_catch(const Event& event, const std::chrono::steady_clock::time_point deadline)
+    {
+        static_assert(impl_of(conf).run_to_completion);
+        return push_event_impl_2<detail::machine_operation::process_event>
+        (
+            event,
+            detail::expiring_event<Event>{event, deadline}
+        );
+    }
+
+    template<detail::machine_operation Operation, class Event>
+    bool push_event_impl(const Event& event)
+    {
+        if constexpr(Operation == detail::machine_operation::process_event && is_coalesced_event<Event>)
+        {
+            return detail::push_coalesced_event<event_coalescings>
+            (
+                rtc_coalesced_events_,
+                event,
+                [this, &event](const auto& marker)
+                {
+                    return push_event_impl_2<Operation>(event, marker);
+                }
+            );
+        }
+        else
+        {
+            return push_event_impl_2<Operation>(event, event);
+        }
+    }
+
+    /*
+    Pushes `data` (either `event` or its coalescing marker) into the RTC queue.
+    The bound of the queue only applies to the events given to
+    `process_event()` and `push_event()`; starting and stopping the machine is
+    never rejected.
+    */
+    template<detail::machine_operation Operation, class Event, class Data>
+    bool push_event_impl_2(const Event& event, const Data& data)
+    {
+        if constexpr(Operation == detail::machine_operation::process_event)
+        {
+            if(!make_room(rtc_queue_, event))
+            {
+                return false;
+            }
+        }
+
+        if constexpr(event_priority_count > 1)
+        {
+            static_assert
+            (
+                event_priority<Event> >= 0 && event_priority<Event> < event_priority_count,
+                "The priority given to `Event` with `maki::machine_conf::event_priority()` must be lower than `maki::machine_conf::event_priority_count()`"
+            );
+            push_into_rtc_queue<any_event_visitor<Operation>>(data, event_priority<Event>);
+        }
+        else
+        {
+            push_into_rtc_queue<any_event_visitor<Operation>>(data);
+        }
+        return true;
+    }
+
+    /*
+    Pushes `data` into the RTC queue (with the given priority, if the queue has
+    several priorities), along with a timestamp if queue statistics are
+    enabled.
+    */
+    template<class FunHolder, class Data, class... Priority>
+    void push_into_rtc_queue(const Data& data, const Priority... priority)
+    {
+        if constexpr(impl_of(conf).queue_statistics)
+        {
+            rtc_queue_.template push<FunHolder>
+            (
+                detail::timestamped_event<Data>{data, std::chrono::steady_clock::now()},
+                priority...
+            );
+            queue_stats_.rtc_queue.on_push(rtc_queue_.size());
+        }
+        else
+        {
+            rtc_queue_.template push<FunHolder>(data, priority...);
+        }
+    }
+
+    //Like `push_into_rtc_queue()`, for the event deferral queue
+    template<class Data>
+    void push_into_event_deferral_queue(const Data& data)
+    {
+        if constexpr(impl_of(conf).queue_statistics)
+        {
+            event_deferral_queue_.template push<deferred_event_visitor>
+            (
+                detail::timestamped_event<Data>{data, std::chrono::steady_clock::now()}
+            );
+            queue_stats_.event_deferral_queue.on_push(event_deferral_queue_.size());
+        }
+        else
+        {
+            event_deferral_queue_.template push<deferred_event_visitor>(data);
+        }
+    }
+
+    //Pushes `event` into the event deferral queue
+    template<class Event>
+    void defer_event(const Event& event)
+    {
+        if constexpr(is_coalesced_event<Event>)
+        {
+            detail::push_coalesced_event<event_coalescings>
+            (
+                deferred_coalesced_events_,
+                event,
+                [this, &event](const auto& marker)
+                {
+                    if(!make_room(event_deferral_queue_, event))
+                    {
+                        return false;
+                    }
+                    push_into_event_deferral_queue(marker);
+                    return true;
+                }
+            );
+        }
+        else
+        {
+            defer_event(event, event);
+        }
+    }
+
+    //Pushes `data` (either `event` or a wrapper of it) into the event deferral
+    //queue
+    template<class Event, class Data>
+    void defer_event(const Event& event, const Data& data)
+    {
+        if(make_room(event_deferral_queue_, event))
+        {
+            push_into_event_deferral_queue(data);
+        }
+    }
+
+    /*
+    Processes the event of `wrapper`, unless it's deferred by an active
+    state, in which case the whole wrapper is deferred so that its deadline
+    still applies.
+    */
+    template<class Event>
+    bool execute_expiring_event(const detail::expiring_event<Event>& wrapper)
+    {
+        if constexpr(detail::type_set_contains_v<deferrable_event_type_set, Event>)
+        {
+            if(impl_.template defers_event<Event>())
+            {
+                defer_event(wrapper.event, wrapper);
+                return false;
+            }
+        }
+        return execute_one_operation<detail::machine_operation::process_event>(wrapper.event);
+    }
+
+    /*
+    Removes the events of type `Event` for which `pred(event)` returns `true`
+    from `queue`, whatever the form in which they're stored (as is, as
+    coalescing markers or as expiring events).
+    */
+    template<class Event, class FunHolder, class Queue, class Predicate>
+    std::size_t cancel_queued_events
+    (
+        Queue& queue,
+        const coalesced_event_slot_mix_type& coalesced_events,
+        const Predicate& pred
+    )
+    {
+        using pushed_data_type_list = std::conditional_t
+        <
+            is_coalesced_event<Event>,
+            detail::type_list_t
+            <
+                Event,
+                detail::coalesced_event_marker<Event>,
+                detail::expiring_event<Event>
+            >,
+            detail::type_list_t
+            <
+                Event,
+                detail::expiring_event<Event>
+            >
+        >;
+
+        using data_type_list = std::conditional_t
+        <
+            impl_of(conf).queue_statistics,
+            detail::timestamped_event_list_t<pushed_data_type_list>,
+            pushed_data_type_list
+        >;
+
+        return queue.template remove_if<FunHolder, data_type_list>
+        (
+            [&coalesced_events, &pred](const auto& data)
+            {
+                return queued_data_matches<Event>(data, coalesced_events, pred);
+            },
+            *this
+        );
+    }
+
+    //Whether `pred` returns `true` for the event held by `data`
+    template<class Event, class Data, class Predicate>
+    static bool queued_data_matches
+    (
+        const Data& data,
+        const coalesced_event_slot_mix_type& coalesced_events,
+        const Predicate& pred
+    )
+    {
+        if constexpr(std::is_same_v<Data, Event>)
+        {
+            return static_cast<bool>(pred(data));
+        }
+        else if constexpr(std::is_same_v<Data, detail::expiring_event<Event>>)
+        {
+            return static_cast<bool>(pred(data.event));
+        }
+        else
+        {
+            const auto& pending_event = detail::pending_coalesced_event<Event>(coalesced_events);
+            return pending_event.has_value() && pred(*pending_event);
+        }
+    }
+
+    template<class Event, class Data, class Predicate>
+    static bool queued_data_matches
+    (
+        const detail::timestamped_event<Data>& data,
+        const coalesced_event_slot_mix_type& coalesced_events,
+        const Predicate& pred
+    )
+    {
+        return queued_data_matches<Event>(data.data, coalesced_events, pred);
+    }
+
+    /*
+    If `queue` is full (see `maki::machine_conf::event_queue_max_size()`),
+    applies the overflow policy. Returns whether `event` can be pushed into
+    `queue`.
+    */
+    template<class Queue, class Event>
+    bool make_room([[maybe_unused]] Queue& queue, [[maybe_unused]] const Event& event)
+    {
+        constexpr auto max_size = impl_of(conf).event_queue_max_size;
+        constexpr auto policy = impl_of(conf).event_queue_overflow_policy;
+
+        if constexpr(max_size != 0)
+        {
+            if(queue.size() < max_size)
+            {
+                return true;
+            }
+
+            if constexpr(policy == overflow_policy::drop_oldest)
+            {
+                queue.drop_front(*this);
+                return true;
+            }
+            else if constexpr(policy == overflow_policy::call_handler)
+            {
+                static_assert
+                (
+                    !detail::is_null_v<typename option_set_type::event_queue_overflow_handler_type>,
+                    "`maki::machine_conf::event_queue_overflow_handler()` must be called to use `maki::overflow_policy::call_handler`"
+                );
+                impl_of(conf).event_queue_overflow_handler(*this, event);
+                return false;
+            }
+            else
+            {
+                return false;
+            }
+        }
+        else
+        {
+            return true;
+        }
+    }
+
+    /*
+    Processes the pending coalesced event of type `Event`, if any (the copy of
+    the event into `slots` may have failed).
+    */
+    template<class Event>
+    bool execute_coalesced_event(coalesced_event_slot_mix_type& slots)
+    {
+        const auto event = detail::take_coalesced_event<Event>(slots);
+        if(!event.has_value())
+        {
+            return false;
+        }
+        return execute_one_operation<detail::machine_operation::process_event>(*event);
+    }
+
+    void try_processing_deferred_operations()
+    {
+        auto budget = detail::unlimited_operation_budget{};
+        try_processing_deferred_operations(budget);
+    }
+
+    /*
+    Process all previously deferred events that can now be processed.
+    Returns `false` if `budget` has been exhausted in the meantime.
+    */
+    template<class Budget>
+    bool try_processing_deferred_operations([[maybe_unused]] Budget& budget)
+    {
+        if constexpr(has_deferrable_events)
+        {
+            /*
+            The inner loop tries to process every deferred event once. Events
+            that are still deferred by the active states are moved to the back
+            of the queue (thus preserving their order) without being processed.
+
+            The outer loop executes the inner loop as many times as necessary, that
+            is, until no state that defers events has been exited since the last
+            execution of the inner loop (see `deferring_state_exited_`). If no
+            such state has been exited, `event_deferral_queue_` only contains
+            events that are still deferred by any of the currently active
+            states, and there's nothing to do.
+
+            These two levels are necessary, as processing a previously deferred
+            event can change the active states and allow other events of
+            `event_deferral_queue_` to be processed.
+            */
+
+            while(deferring_state_exited_) // Outer loop
+            {
+                deferring_state_exited_ = false;
+                for(auto count = event_deferral_queue_.size(); count != 0; --count) // Inner loop
+                {
+                    if(!budget.consume())
+                    {
+                        /*
+                        Move the events we haven't tried to the back of the
+                        queue, as if they were still deferred, so that the
+                        next call starts over with the original order.
+                        */
+                        for(; count != 0; --count)
+                        {
+                            event_deferral_queue_.rotate();
+                        }
+                        deferring_state_exited_ = true;
+                        return false;
+                    }
+
+                    if constexpr(impl_of(conf).queue_statistics)
+                    {
+                        ++queue_stats_.deferral_retry_count;
+                    }
+
+                    event_deferral_queue_.invoke_or_rotate(*this);
+                }
+            }
+        }
+
+        return true;
+    }
+
+    template<detail::machine_operation Operation, class Event>
+    bool execute_one_operation(const Event& event)
+    {
+        if constexpr(Operation == detail::machine_operation::start)
+        {
+            impl_.enter(*this, context(), event);
+            return true;
+        }
+        else if constexpr(Operation == detail::machine_operation::stop)
+        {
+            impl_.exit_to_finals(*this, context(), event);
+            return true;
         }
         else
         {
@@ -591,11 +2187,24 @@ private:
             {
                 if(impl_.template defers_event<Event>())
                 {
-                    event_deferral_queue_.template push<any_event_visitor<Operation>>(event);
+                    defer_event(event);
                     return false;
                 }
             }
 
+            if constexpr(impl_of(conf).tracing)
+            {
+                if(trace_.enabled)
+                {
+                    using event_type_list = detail::trace_event_type_list_t<typename impl_type::event_type_set>;
+                    trace_operation
+                    (
+                        trace_record_kind::event,
+                        detail::trace_event_type_index<event_type_list, Event>()
+                    );
+                }
+            }
+
             //If running, execute pre-processing hook for `Event`, if any.
             if constexpr(has_matching_pre_processing_hook)
             {
@@ -619,7 +2228,15 @@ private:
             {
                 if(running())
                 {
-                    const auto processed = impl_.template call_internal_action<false>(*this, context(), event);
+                    const auto processed = call_internal_action(event);
+
+                    if constexpr(impl_of(conf).metrics)
+                    {
+                        if(!processed)
+                        {
+                            ++metrics_.unhandled_event_count;
+                        }
+                    }
 
                     detail::call_matching_event_action<post_processing_hook_ptr_constant_list>
                     (
@@ -638,13 +2255,59 @@ private:
                 is stopped.
                 */
 
-                impl_.template call_internal_action<false>(*this, context(), event);
+                if constexpr(impl_of(conf).metrics)
+                {
+                    if(!call_internal_action(event))
+                    {
+                        ++metrics_.unhandled_event_count;
+                    }
+                }
+                else
+                {
+                    call_internal_action(event);
+                }
             }
 
             return true;
         }
     }
 
+    /*
+    Process the event in the active states, either through the flattened
+    dispatch or from the root composite state.
+    */
+    template<class Event>
+    bool call_internal_action(const Event& event)
+    {
+        if constexpr(!detail::tlu::empty_v<flat_leaf_list>)
+        {
+            if(flat_leaf_index_ != detail::unknown_flat_leaf_index)
+            {
+                return detail::tlu::call_at
+                <
+                    flat_leaf_list,
+                    call_internal_action_along_flat_leaf,
+                    bool
+                >(flat_leaf_index_, *this, event);
+            }
+        }
+
+        return impl_.template call_internal_action<false>(*this, context(), event);
+    }
+
+    struct call_internal_action_along_flat_leaf
+    {
+        template<class FlatLeaf, class Event>
+        static bool call(machine& self, const Event& event)
+        {
+            return self.impl_.template call_internal_action_along
+            <
+                false,
+                typename FlatLeaf::state_path
+            >(self, self.context(), event);
+        }
+    };
+
     static constexpr auto pre_processing_hooks = impl_of(conf).pre_processing_hooks;
     static constexpr auto post_processing_hooks = impl_of(conf).post_processing_hooks;
 
@@ -658,10 +2321,55 @@ private:
         impl_of(conf).context_sig
     > ctx_holder_;
 
-    impl_type impl_;
-
+    /*
+    Declared before `impl_` so that it can fill the padding that follows
+    `ctx_holder_` when the context is small.
+    */
     bool executing_operation_ = false;
 
+    /*
+    Whether a state that can defer events has been exited since the last
+    attempt to process the deferred events. Set by the regions.
+    */
+    bool deferring_state_exited_ = false;
+
+    /*
+    The index, in `flat_leaf_list`, of the active leaf state, or
+    `detail::unknown_flat_leaf_index`. Kept up to date by the regions.
+    */
+    flat_leaf_index_type flat_leaf_index_ = detail::unknown_flat_leaf_index;
+
+#if MAKI_DETAIL_COROUTINES
+    /*
+    The number of asynchronous actions (see `maki::task`) that are suspended,
+    if any action can be asynchronous.
+
+    Like the members that follow `ctx_holder_`, this member and the next one
+    are declared before `impl_` so that they fill its padding when they're
+    small or empty.
+    */
+    std::conditional_t
+    <
+        has_async_actions,
+        int,
+        detail::disabled_async_action_count
+    > suspended_async_action_count_{};
+
+    /*
+    The coroutines suspended by `until()` or `until_completed()` (see
+    `maki::machine_conf::until_enabled()`), if enabled. Checked by the regions
+    after every external transition.
+    */
+    std::conditional_t
+    <
+        impl_of(conf).until_enabled,
+        detail::state_waiter_list<machine>,
+        detail::disabled_state_waiter_list
+    > state_waiters_;
+#endif
+
+    impl_type impl_;
+
     /*
     Storage for operations that have been postponed by the run-to-completion
     mechanism.
@@ -673,6 +2381,49 @@ private:
     mechanism.
     */
     event_deferral_queue_type event_deferral_queue_;
+
+    /*
+    Storage for the events that are coalesced (see
+    `maki::machine_conf::coalesce()`) while they're in `rtc_queue_` and in
+    `event_deferral_queue_`, respectively.
+    */
+    coalesced_event_slot_mix_type rtc_coalesced_events_;
+    coalesced_event_slot_mix_type deferred_coalesced_events_;
+
+    /*
+    Storage for the events posted with `post_event()`.
+    */
+    inbox_type inbox_;
+
+    /*
+    The identifier and the runtime switch of the tracing (see
+    `maki::machine_conf::tracing()`), if enabled.
+    */
+    detail::machine_trace_state<impl_of(conf).tracing> trace_;
+
+    /*
+    The metrics of the machine (see `maki::machine_conf::metrics()`), if
+    enabled. Updated by the regions.
+    */
+    detail::machine_metrics_t<impl_of(conf).metrics, impl_type> metrics_;
+
+    /*
+    The latency histograms of the user code (see
+    `maki::machine_conf::latency_profiling()`), if enabled. Updated by the
+    regions.
+    */
+    std::conditional_t
+    <
+        impl_of(conf).latency_profiling,
+        detail::latency_profile,
+        detail::disabled_latency_profile
+    > latency_profile_;
+
+    /*
+    The statistics of the event queues (see
+    `maki::machine_conf::queue_statistics()`), if enabled.
+    */
+    detail::machine_queue_statistics<impl_of(conf).queue_statistics, machine> queue_stats_;
 };
 
 #undef MAKI_DETAIL_MAYBE_CATCH
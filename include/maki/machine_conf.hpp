@@ -14,8 +14,13 @@
 
 #include "event_set.hpp"
 #include "context.hpp"
+#include "dispatch_strategy.hpp"
+#include "coalescing_policy.hpp"
+#include "overflow_policy.hpp"
 #include "action.hpp"
 #include "detail/machine_conf_impl.hpp"
+#include "detail/event_priority.hpp"
+#include "detail/event_coalescing.hpp"
 #include "detail/type_set.hpp"
 #include "detail/type.hpp"
 #include "detail/event_action.hpp"
@@ -57,19 +62,41 @@ public:
     machine_conf& operator=(machine_conf&&) = delete;
 
 #define MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_BEGIN /*NOLINT(cppcoreguidelines-macro-usage)*/ \
+    [[maybe_unused]] const auto MAKI_DETAIL_ARG_async_actions_enabled = impl_.async_actions_enabled; \
     [[maybe_unused]] const auto MAKI_DETAIL_ARG_auto_start = impl_.auto_start; \
     [[maybe_unused]] const auto MAKI_DETAIL_ARG_context_type = detail::type<typename Impl::context_type>; \
     [[maybe_unused]] const auto MAKI_DETAIL_ARG_context_sig = impl_.context_sig; \
+    [[maybe_unused]] const auto MAKI_DETAIL_ARG_dispatch_strat = impl_.dispatch_strat; \
+    [[maybe_unused]] const auto MAKI_DETAIL_ARG_event_coalescings = impl_.event_coalescings; \
+    [[maybe_unused]] const auto MAKI_DETAIL_ARG_event_priorities = impl_.event_priorities; \
+    [[maybe_unused]] const auto MAKI_DETAIL_ARG_event_priority_count = impl_.event_priority_count; \
+    [[maybe_unused]] const auto MAKI_DETAIL_ARG_event_queue_capacity = impl_.event_queue_capacity; \
+    [[maybe_unused]] const auto MAKI_DETAIL_ARG_event_queue_max_size = impl_.event_queue_max_size; \
+    [[maybe_unused]] const auto MAKI_DETAIL_ARG_event_queue_overflow_handler = impl_.event_queue_overflow_handler; \
+    [[maybe_unused]] const auto MAKI_DETAIL_ARG_event_queue_overflow_policy = impl_.event_queue_overflow_policy; \
+    [[maybe_unused]] const auto MAKI_DETAIL_ARG_flattened_dispatch = impl_.flattened_dispatch; \
+    [[maybe_unused]] const auto MAKI_DETAIL_ARG_large_event_allocator = impl_.large_event_allocator; \
+    [[maybe_unused]] const auto MAKI_DETAIL_ARG_large_event_arena_size = impl_.large_event_arena_size; \
+    [[maybe_unused]] const auto MAKI_DETAIL_ARG_latency_profiling = impl_.latency_profiling; \
+    [[maybe_unused]] const auto MAKI_DETAIL_ARG_metrics = impl_.metrics; \
+    [[maybe_unused]] const auto MAKI_DETAIL_ARG_operation_budget = impl_.operation_budget; \
     [[maybe_unused]] const auto MAKI_DETAIL_ARG_pre_processing_hooks = impl_.pre_processing_hooks; \
     [[maybe_unused]] const auto MAKI_DETAIL_ARG_post_external_transition_hook = impl_.post_external_transition_hook; \
     [[maybe_unused]] const auto MAKI_DETAIL_ARG_pre_external_transition_hook = impl_.pre_external_transition_hook; \
     [[maybe_unused]] const auto MAKI_DETAIL_ARG_exception_handler = impl_.exception_handler; \
     [[maybe_unused]] const auto MAKI_DETAIL_ARG_post_processing_hooks = impl_.post_processing_hooks; \
+    [[maybe_unused]] const auto MAKI_DETAIL_ARG_post_event_capacity = impl_.post_event_capacity; \
+    [[maybe_unused]] const auto MAKI_DETAIL_ARG_post_event_enabled = impl_.post_event_enabled; \
     [[maybe_unused]] const auto MAKI_DETAIL_ARG_process_event_now_enabled = impl_.process_event_now_enabled; \
+    [[maybe_unused]] const auto MAKI_DETAIL_ARG_queue_statistics = impl_.queue_statistics; \
     [[maybe_unused]] const auto MAKI_DETAIL_ARG_run_to_completion = impl_.run_to_completion; \
     [[maybe_unused]] const auto MAKI_DETAIL_ARG_small_event_max_align = impl_.small_event_max_align; \
     [[maybe_unused]] const auto MAKI_DETAIL_ARG_small_event_max_size = impl_.small_event_max_size; \
-    [[maybe_unused]] const auto MAKI_DETAIL_ARG_transition_tables = impl_.transition_tables;
+    [[maybe_unused]] const auto MAKI_DETAIL_ARG_timer_service = impl_.timer_service; \
+    [[maybe_unused]] const auto MAKI_DETAIL_ARG_tracing = impl_.tracing; \
+    [[maybe_unused]] const auto MAKI_DETAIL_ARG_transition_tables = impl_.transition_tables; \
+    [[maybe_unused]] const auto MAKI_DETAIL_ARG_typed_event_queues = impl_.typed_event_queues; \
+    [[maybe_unused]] const auto MAKI_DETAIL_ARG_until_enabled = impl_.until_enabled;
 
 #define MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_END /*NOLINT(cppcoreguidelines-macro-usage)*/ \
     return machine_conf \
@@ -82,22 +109,49 @@ public:
             std::decay_t<decltype(MAKI_DETAIL_ARG_pre_external_transition_hook)>, \
             std::decay_t<decltype(MAKI_DETAIL_ARG_post_external_transition_hook)>, \
             std::decay_t<decltype(MAKI_DETAIL_ARG_post_processing_hooks)>, \
-            std::decay_t<decltype(MAKI_DETAIL_ARG_transition_tables)> \
+            std::decay_t<decltype(MAKI_DETAIL_ARG_transition_tables)>, \
+            std::decay_t<decltype(MAKI_DETAIL_ARG_large_event_allocator)>, \
+            std::decay_t<decltype(MAKI_DETAIL_ARG_timer_service)>, \
+            std::decay_t<decltype(MAKI_DETAIL_ARG_event_priorities)>, \
+            std::decay_t<decltype(MAKI_DETAIL_ARG_event_coalescings)>, \
+            std::decay_t<decltype(MAKI_DETAIL_ARG_event_queue_overflow_handler)> \
         > \
     > \
     { \
+        MAKI_DETAIL_ARG_async_actions_enabled, \
         MAKI_DETAIL_ARG_auto_start, \
         MAKI_DETAIL_ARG_context_sig, \
+        MAKI_DETAIL_ARG_dispatch_strat, \
+        MAKI_DETAIL_ARG_event_coalescings, \
+        MAKI_DETAIL_ARG_event_priorities, \
+        MAKI_DETAIL_ARG_event_priority_count, \
+        MAKI_DETAIL_ARG_event_queue_capacity, \
+        MAKI_DETAIL_ARG_event_queue_max_size, \
+        MAKI_DETAIL_ARG_event_queue_overflow_handler, \
+        MAKI_DETAIL_ARG_event_queue_overflow_policy, \
+        MAKI_DETAIL_ARG_flattened_dispatch, \
+        MAKI_DETAIL_ARG_large_event_allocator, \
+        MAKI_DETAIL_ARG_large_event_arena_size, \
+        MAKI_DETAIL_ARG_latency_profiling, \
+        MAKI_DETAIL_ARG_metrics, \
+        MAKI_DETAIL_ARG_operation_budget, \
         MAKI_DETAIL_ARG_pre_processing_hooks, \
         MAKI_DETAIL_ARG_post_external_transition_hook, \
         MAKI_DETAIL_ARG_pre_external_transition_hook, \
         MAKI_DETAIL_ARG_exception_handler, \
         MAKI_DETAIL_ARG_post_processing_hooks, \
+        MAKI_DETAIL_ARG_post_event_capacity, \
+        MAKI_DETAIL_ARG_post_event_enabled, \
         MAKI_DETAIL_ARG_process_event_now_enabled, \
+        MAKI_DETAIL_ARG_queue_statistics, \
         MAKI_DETAIL_ARG_run_to_completion, \
         MAKI_DETAIL_ARG_small_event_max_align, \
         MAKI_DETAIL_ARG_small_event_max_size, \
-        MAKI_DETAIL_ARG_transition_tables \
+        MAKI_DETAIL_ARG_timer_service, \
+        MAKI_DETAIL_ARG_tracing, \
+        MAKI_DETAIL_ARG_transition_tables, \
+        MAKI_DETAIL_ARG_typed_event_queues, \
+        MAKI_DETAIL_ARG_until_enabled \
     };
 
 #define MAKI_DETAIL_X(signature) /*NOLINT(cppcoreguidelines-macro-usage)*/ \
@@ -157,6 +211,26 @@ public:
 #undef MAKI_DETAIL_ARG_post_external_transition_hook
     }
 
+    /**
+    @brief Specifies whether actions can be asynchronous even if no action is
+    known to be (see `maki::task`).
+
+    The machine only holds the state needed by asynchronous actions (and only
+    checks it before executing any operation) if any of its actions is
+    asynchronous. This is determined at compile time from the declared return
+    type of the actions. The return type of generic callables (e.g. lambdas
+    taking an `auto&` parameter) can't be known without instantiating them,
+    though. If such a callable returns a `maki::task`, this option must be set
+    to `true` (a `static_assert` reminds you of it).
+    */
+    [[nodiscard]] constexpr MAKI_DETAIL_MACHINE_CONF_RETURN_TYPE async_actions_enabled(const bool value) const
+    {
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_BEGIN
+#define MAKI_DETAIL_ARG_async_actions_enabled value
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_END
+#undef MAKI_DETAIL_ARG_async_actions_enabled
+    }
+
     /**
     @brief Specifies whether the constructor of `maki::machine` must call
     `maki::machine::start()`.
@@ -169,6 +243,346 @@ public:
 #undef MAKI_DETAIL_ARG_auto_start
     }
 
+    /**
+    @brief Specifies how regions find their active state whenever they have to
+    forward a call to it (see `maki::dispatch_strategy`).
+
+    The default strategy, `maki::dispatch_strategy::linear`, is the fastest one
+    for regions made of a few states. For regions made of many states (say, a
+    dozen or more), `maki::dispatch_strategy::jump_table` is likely to be
+    faster.
+    */
+    [[nodiscard]] constexpr MAKI_DETAIL_MACHINE_CONF_RETURN_TYPE dispatch_strategy(const maki::dispatch_strategy value) const
+    {
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_BEGIN
+#define MAKI_DETAIL_ARG_dispatch_strat value
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_END
+#undef MAKI_DETAIL_ARG_dispatch_strat
+    }
+
+    /**
+    @brief Makes the machine coalesce the pending events of type `Event`,
+    according to the given policy.
+
+    An event is pending when it's in the run-to-completion event queue (see
+    `maki::machine::push_event()`) or in the event deferral queue (see
+    `maki::state_mold::defer()`). When an event of type `Event` is queued while
+    another one is already pending in the same queue, no new entry is added to
+    the queue: the new event either replaces the pending one, at the same
+    position in the queue (`maki::coalescing_policy::keep_latest`), or is
+    dropped (`maki::coalescing_policy::keep_oldest`).
+
+    `Event` must be copy-constructible, move-constructible and
+    copy-assignable.
+    */
+    template<class Event>
+    [[nodiscard]] constexpr MAKI_DETAIL_MACHINE_CONF_RETURN_TYPE coalesce(const coalescing_policy policy) const
+    {
+        return coalesce<Event>(detail::coalescing_policy_merge{policy});
+    }
+
+    /**
+    @brief Like `coalesce(policy)`, but merges the new event into the pending
+    one by calling `merge(pending_event, new_event)`.
+
+    `merge` must be callable with a `Event&` and a `const Event&`.
+    */
+    template<class Event, class Merge>
+    [[nodiscard]] constexpr MAKI_DETAIL_MACHINE_CONF_RETURN_TYPE coalesce(const Merge& merge) const
+    {
+        const auto new_event_coalescings = append
+        (
+            impl_.event_coalescings,
+            detail::event_coalescing<Event, Merge>{merge}
+        );
+
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_BEGIN
+#define MAKI_DETAIL_ARG_event_coalescings new_event_coalescings
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_END
+#undef MAKI_DETAIL_ARG_event_coalescings
+    }
+
+    /**
+    @brief Sets the priority of the events of type `Event` in the
+    run-to-completion event queue.
+
+    When the machine has several pending events (see
+    `event_priority_count()`), it processes the ones with the highest priority
+    first. `priority` must be lower than the number of priorities. The default
+    priority is 0.
+
+    The events given to `maki::machine::start()` and
+    `maki::machine::stop()` (`maki::events::start` and `maki::events::stop` by
+    default) are subject to priorities as well.
+    */
+    template<class Event>
+    [[nodiscard]] constexpr MAKI_DETAIL_MACHINE_CONF_RETURN_TYPE event_priority(const int priority) const
+    {
+        const auto new_event_priorities = append
+        (
+            impl_.event_priorities,
+            detail::event_priority<Event>{priority}
+        );
+
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_BEGIN
+#define MAKI_DETAIL_ARG_event_priorities new_event_priorities
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_END
+#undef MAKI_DETAIL_ARG_event_priorities
+    }
+
+    /**
+    @brief Specifies the number of priorities of the run-to-completion event
+    queue.
+
+    The queue is made of one FIFO per priority. Among the events that are
+    pending when the machine is done with an event, the machine processes the
+    oldest event of the highest priority. The priority of an event is given
+    either by the type of the event (see `event_priority()`) or by the caller
+    of `maki::machine::push_event()`.
+
+    The event deferral queue doesn't use priorities: deferred events are always
+    processed in the order they've been deferred.
+
+    The default number is 1, meaning the queue is a single FIFO.
+    */
+    [[nodiscard]] constexpr MAKI_DETAIL_MACHINE_CONF_RETURN_TYPE event_priority_count(const int value) const
+    {
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_BEGIN
+#define MAKI_DETAIL_ARG_event_priority_count value
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_END
+#undef MAKI_DETAIL_ARG_event_priority_count
+    }
+
+    /**
+    @brief Specifies the number of events the run-to-completion event queue
+    and the event deferral queue can hold without allocating any memory.
+
+    These queues are ring buffers that grow (by doubling their capacity) when
+    they're full, but never shrink. The given capacity is reserved once and for
+    all at construction of the machine, so that, as long as the queues never
+    hold more events than that, no recursive call to
+    `maki::machine::process_event()` or `maki::machine::push_event()` and no
+    event deferral ever allocates memory (except for events that are too large
+    for the small object optimization; see `small_event_max_size()` and
+    `small_event_max_align()`).
+
+    If several event priorities are used (see `event_priority_count()`), the
+    capacity is reserved for each priority.
+
+    The default capacity is 0, meaning memory is allocated on the first push.
+    */
+    [[nodiscard]] constexpr MAKI_DETAIL_MACHINE_CONF_RETURN_TYPE event_queue_capacity(const std::size_t value) const
+    {
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_BEGIN
+#define MAKI_DETAIL_ARG_event_queue_capacity value
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_END
+#undef MAKI_DETAIL_ARG_event_queue_capacity
+    }
+
+    /**
+    @brief Specifies the maximum number of events the run-to-completion event
+    queue and the event deferral queue can hold, each.
+
+    When an event must be queued into a full queue, the overflow policy is
+    applied (see `event_queue_overflow_policy()`). Use
+    `maki::machine::would_block()` to know beforehand whether the
+    run-to-completion event queue is full. Coalesced events (see `coalesce()`)
+    that are merged into a pending event don't take any room.
+
+    Combined with `event_queue_capacity()`, this bounds the memory used by the
+    queues of the machine.
+
+    The default maximum size is 0, meaning the queues are unbounded.
+    */
+    [[nodiscard]] constexpr MAKI_DETAIL_MACHINE_CONF_RETURN_TYPE event_queue_max_size(const std::size_t value) const
+    {
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_BEGIN
+#define MAKI_DETAIL_ARG_event_queue_max_size value
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_END
+#undef MAKI_DETAIL_ARG_event_queue_max_size
+    }
+
+    /**
+    @brief Sets the handler to be called when an event must be queued into a
+    full queue, and sets the overflow policy to
+    `maki::overflow_policy::call_handler`.
+
+    The handler is called as `handler(mach, event)`, where `mach` is the
+    machine and `event` is the event that doesn't fit.
+    */
+    template<class Handler>
+    [[nodiscard]] constexpr MAKI_DETAIL_MACHINE_CONF_RETURN_TYPE event_queue_overflow_handler(const Handler& handler) const
+    {
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_BEGIN
+#define MAKI_DETAIL_ARG_event_queue_overflow_handler handler
+#define MAKI_DETAIL_ARG_event_queue_overflow_policy overflow_policy::call_handler
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_END
+#undef MAKI_DETAIL_ARG_event_queue_overflow_policy
+#undef MAKI_DETAIL_ARG_event_queue_overflow_handler
+    }
+
+    /**
+    @brief Sets what the machine does when an event must be queued into a full
+    queue (see `event_queue_max_size()`).
+
+    The default policy is `maki::overflow_policy::reject`.
+    */
+    [[nodiscard]] constexpr MAKI_DETAIL_MACHINE_CONF_RETURN_TYPE event_queue_overflow_policy(const overflow_policy value) const
+    {
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_BEGIN
+#define MAKI_DETAIL_ARG_event_queue_overflow_policy value
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_END
+#undef MAKI_DETAIL_ARG_event_queue_overflow_policy
+    }
+
+    /**
+    @brief Specifies whether the machine must keep track of its active leaf
+    state, so that events can be dispatched without searching the active state
+    of every region, from the top of the hierarchy down to the leaf.
+
+    When enabled, the machine stores an index that identifies the active leaf
+    state, that is the deepest active state that is reachable through composite
+    states made of a single region. When an event is processed, this index
+    selects (through a single table lookup) a function that goes straight down
+    to the leaf state, giving every composite state of the way the same
+    opportunity to process the event as usual. If the leaf state doesn't
+    consume the event, the transition tables of the enclosing regions are
+    tried, from the innermost to the outermost one, as usual.
+
+    This is mostly useful for machines made of deeply nested composite states.
+    This has no effect if the machine is made of several regions, and
+    composite states made of several regions are handled as leaf states.
+    */
+    [[nodiscard]] constexpr MAKI_DETAIL_MACHINE_CONF_RETURN_TYPE flattened_dispatch(const bool value) const
+    {
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_BEGIN
+#define MAKI_DETAIL_ARG_flattened_dispatch value
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_END
+#undef MAKI_DETAIL_ARG_flattened_dispatch
+    }
+
+    /**
+    @brief Specifies the allocator of the events that are too large for the
+    small object optimization of the run-to-completion event queue and of the
+    event deferral queue (see `small_event_max_size()` and
+    `small_event_max_align()`).
+
+    `alloc` must be either:
+    - a pointer to an object that has the same `allocate()` and `deallocate()`
+    member functions as `std::pmr::memory_resource` (typically, a pointer to a
+    `std::pmr::memory_resource` with static storage duration);
+    - an object that has such `allocate()` and `deallocate()` member
+    functions, callable on a `const` object.
+
+    By default, these events are allocated with a plain `new`.
+    */
+    template<class Allocator>
+    [[nodiscard]] constexpr MAKI_DETAIL_MACHINE_CONF_RETURN_TYPE large_event_allocator(const Allocator& alloc) const
+    {
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_BEGIN
+#define MAKI_DETAIL_ARG_large_event_allocator alloc
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_END
+#undef MAKI_DETAIL_ARG_large_event_allocator
+    }
+
+    /**
+    @brief Specifies the size, in bytes, of an arena from which the events
+    that are too large for the small object optimization of the
+    run-to-completion event queue are allocated.
+
+    Allocating an event from the arena costs a pointer bump, and freeing it
+    costs nothing. The whole arena is reclaimed once the run-to-completion
+    event queue is drained. Events that don't fit into the remaining space of
+    the arena are allocated as if there were no arena (see
+    `large_event_allocator()`). The arena itself is allocated on first use and
+    kept for the lifetime of the machine.
+
+    The default size is 0, meaning no arena is used.
+    */
+    [[nodiscard]] constexpr MAKI_DETAIL_MACHINE_CONF_RETURN_TYPE large_event_arena_size(const std::size_t value) const
+    {
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_BEGIN
+#define MAKI_DETAIL_ARG_large_event_arena_size value
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_END
+#undef MAKI_DETAIL_ARG_large_event_arena_size
+    }
+
+    /**
+    @brief Specifies whether `maki::machine` measures how long the user code
+    it calls during transitions takes.
+
+    The durations of the guards, of the exit actions, of the transition actions
+    and of the entry actions are measured with `std::chrono::steady_clock` and
+    accumulated into one `maki::latency_histogram` per piece of code. Guards
+    and transition actions are identified by the region and by the source and
+    target states of their transition; entry and exit actions are identified by
+    the region and by their state. The exit and entry actions of composite
+    states include the time spent exiting or entering their substates.
+
+    Use `maki::machine::top_latency_offenders()` to find the pieces of code
+    that take the most time. When this option is disabled, profiling costs
+    nothing.
+    */
+    [[nodiscard]] constexpr MAKI_DETAIL_MACHINE_CONF_RETURN_TYPE latency_profiling(const bool value) const
+    {
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_BEGIN
+#define MAKI_DETAIL_ARG_latency_profiling value
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_END
+#undef MAKI_DETAIL_ARG_latency_profiling
+    }
+
+    /**
+    @brief Specifies whether `maki::machine` collects metrics about its
+    activity.
+
+    The collected metrics are:
+    - the number of times each state has been entered;
+    - the cumulative time spent in each state;
+    - the number of times each external transition has been executed, for each
+    pair of source and target states;
+    - the number of events that no state or transition has handled.
+
+    They're stored in fixed-size arrays, indexed by state indices that are
+    computed at compile time. Use `maki::machine::state_entry_count()` and
+    similar functions to read them, or a `maki::metrics_registry` to export the
+    metrics of several machines. When this option is disabled, metrics cost
+    nothing.
+    */
+    [[nodiscard]] constexpr MAKI_DETAIL_MACHINE_CONF_RETURN_TYPE metrics(const bool value) const
+    {
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_BEGIN
+#define MAKI_DETAIL_ARG_metrics value
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_END
+#undef MAKI_DETAIL_ARG_metrics
+    }
+
+    /**
+    @brief Specifies the maximum number of queued operations (i.e. events
+    queued into the run-to-completion queue and attempts to process deferred
+    events) that a call to `maki::machine::process_event()` (or to any other
+    function that processes events) executes after having processed the event
+    it's given.
+
+    This caps the duration of a call, which is useful when processing events
+    from a loop that has a time budget (e.g. a real-time loop). The operations
+    that aren't executed are left in the queues, to be executed by
+    `maki::machine::process_pending()` (or by
+    `maki::machine::process_pending_until()`). In the meantime, events given
+    to `maki::machine::process_event()` are queued behind them, so that the
+    order of processing doesn't change.
+
+    Each event is still processed to completion.
+
+    The default budget is 0, meaning unlimited.
+    */
+    [[nodiscard]] constexpr MAKI_DETAIL_MACHINE_CONF_RETURN_TYPE operation_budget(const std::size_t value) const
+    {
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_BEGIN
+#define MAKI_DETAIL_ARG_operation_budget value
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_END
+#undef MAKI_DETAIL_ARG_operation_budget
+    }
+
     /**
     @brief Specifies a hook to be called before any external transition.
 
@@ -206,6 +620,47 @@ public:
 #undef MAKI_DETAIL_ARG_run_to_completion
     }
 
+    /**
+    @brief Specifies the number of events the inbox of the machine (see
+    `post_event_enabled()`) can hold.
+
+    The inbox is a ring buffer allocated once and for all at construction of
+    the machine. The capacity is rounded up to the next power of two. Once the
+    inbox is full, `maki::machine::post_event()` fails until the owner of the
+    machine calls `maki::machine::process_posted_events()`.
+
+    Posted events (along with their callback, if any) are stored in place, and
+    must therefore fit in `small_event_max_size()` and
+    `small_event_max_align()`.
+
+    The default capacity is 256.
+    */
+    [[nodiscard]] constexpr MAKI_DETAIL_MACHINE_CONF_RETURN_TYPE post_event_capacity(const std::size_t value) const
+    {
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_BEGIN
+#define MAKI_DETAIL_ARG_post_event_capacity value
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_END
+#undef MAKI_DETAIL_ARG_post_event_capacity
+    }
+
+    /**
+    @brief Specifies whether `maki::machine::post_event()` and
+    `maki::machine::process_posted_events()` can be called.
+
+    When enabled, the machine holds a bounded, lock-free, multiple-producer,
+    single-consumer inbox (see `post_event_capacity()`). Any thread can post
+    events to this inbox without ever allocating memory, blocking or taking a
+    lock, while the thread that owns the machine processes them by calling
+    `maki::machine::process_posted_events()`.
+    */
+    [[nodiscard]] constexpr MAKI_DETAIL_MACHINE_CONF_RETURN_TYPE post_event_enabled(const bool value) const
+    {
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_BEGIN
+#define MAKI_DETAIL_ARG_post_event_enabled value
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_END
+#undef MAKI_DETAIL_ARG_post_event_enabled
+    }
+
     /**
     @brief Specifies whether the unsafe function
     `maki::machine::process_event_now()` can be called.
@@ -218,6 +673,33 @@ public:
 #undef MAKI_DETAIL_ARG_process_event_now_enabled
     }
 
+    /**
+    @brief Specifies whether `maki::machine` keeps statistics about its
+    run-to-completion queue and its event deferral queue.
+
+    The statistics are:
+    - the high-water mark of the size of each queue (see
+    `maki::machine::rtc_queue_high_water_mark()`);
+    - the number of events that couldn't be stored in place by the queues and
+    have been allocated (see `maki::machine::large_event_allocation_count()`);
+    - the number of times deferred events have been retried (see
+    `maki::machine::deferral_retry_count()`);
+    - for each event type, a `maki::latency_histogram` of the time events spend
+    in each queue, from their enqueuing to their dispatch (see
+    `maki::machine::rtc_queue_latency()`).
+
+    To measure the latencies, the queues store a timestamp along with every
+    event, which counts toward the size given to `small_event_max_size()`.
+    When this option is disabled, queue statistics cost nothing.
+    */
+    [[nodiscard]] constexpr MAKI_DETAIL_MACHINE_CONF_RETURN_TYPE queue_statistics(const bool value) const
+    {
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_BEGIN
+#define MAKI_DETAIL_ARG_queue_statistics value
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_END
+#undef MAKI_DETAIL_ARG_queue_statistics
+    }
+
     /**
     @brief Sets up a `try`/`catch(...)` block at the top-level of every
     non-`const` member function of `maki::machine` and invokes `callable` from
@@ -369,6 +851,55 @@ public:
         return *this;
     }
 
+    /**
+    @brief Specifies how to get the `maki::timer_service` that arms the
+    timeouts of the states (see `maki::state_mold::timeout()`).
+
+    `getter` is called with the machine as argument, and must return a
+    reference to a `maki::timer_service`. Typically, the service is a member of
+    the context:
+
+    @code
+    .timer_service([](auto& mach) -> maki::timer_service&
+    {
+        return mach.context().timers;
+    })
+    @endcode
+
+    Required if any state has a timeout.
+    */
+    template<class Getter>
+    [[nodiscard]] constexpr MAKI_DETAIL_MACHINE_CONF_RETURN_TYPE timer_service(const Getter& getter) const
+    {
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_BEGIN
+#define MAKI_DETAIL_ARG_timer_service getter
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_END
+#undef MAKI_DETAIL_ARG_timer_service
+    }
+
+    /**
+    @brief Specifies whether `maki::machine` records its activity (i.e. its
+    external transitions, the events it processes and the drains of its
+    run-to-completion queue) into the `maki::trace_buffer` of the calling
+    thread.
+
+    Each record (see `maki::trace_record`) is a small binary structure that
+    only holds indices, so that recording is cheap enough to be left enabled in
+    production. Use a `maki::trace_decoder` to turn records into text, or
+    `maki::write_chrome_trace()` to turn them into a timeline.
+
+    Recording can then be paused and resumed at runtime (see
+    `maki::machine::set_tracing_enabled()`). When this option is disabled,
+    tracing costs nothing.
+    */
+    [[nodiscard]] constexpr MAKI_DETAIL_MACHINE_CONF_RETURN_TYPE tracing(const bool value) const
+    {
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_BEGIN
+#define MAKI_DETAIL_ARG_tracing value
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_END
+#undef MAKI_DETAIL_ARG_tracing
+    }
+
     /**
     @brief Specifies the list of transition tables. One region per transition
     table is created.
@@ -383,6 +914,45 @@ public:
 #undef MAKI_DETAIL_ARG_transition_tables
     }
 
+    /**
+    @brief Specifies whether the run-to-completion event queue and the event
+    deferral queue store events as the alternatives of a tagged union.
+
+    When enabled, every event type that the machine handles (and that suits the
+    small object optimization; see `small_event_max_size()` and
+    `small_event_max_align()`) is stored in place, without type erasure, and
+    dequeued events are dispatched to the machine through a compile-time
+    generated sequence of tag comparisons instead of an indirect call. Queue
+    entries are also made no larger than the largest of these event types.
+
+    Other events (e.g. events that no state handles) are allocated on the heap.
+    This is mostly useful for machines that are given a known and limited set
+    of event types.
+    */
+    [[nodiscard]] constexpr MAKI_DETAIL_MACHINE_CONF_RETURN_TYPE typed_event_queues(const bool value) const
+    {
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_BEGIN
+#define MAKI_DETAIL_ARG_typed_event_queues value
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_END
+#undef MAKI_DETAIL_ARG_typed_event_queues
+    }
+
+    /**
+    @brief Specifies whether `maki::machine::until()` and
+    `maki::machine::until_completed()` can be called.
+
+    When enabled, the machine holds the list of the coroutines that wait for a
+    state, and checks it after every external transition. Only available when
+    compiling with C++20 coroutine support.
+    */
+    [[nodiscard]] constexpr MAKI_DETAIL_MACHINE_CONF_RETURN_TYPE until_enabled(const bool value) const
+    {
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_BEGIN
+#define MAKI_DETAIL_ARG_until_enabled value
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_END
+#undef MAKI_DETAIL_ARG_until_enabled
+    }
+
 private:
     MAKI_DETAIL_FRIENDLY_IMPL
 
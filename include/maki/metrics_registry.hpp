@@ -0,0 +1,181 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+/**
+@file
+@brief Defines the maki::metrics_registry class
+*/
+
+#ifndef MAKI_METRICS_REGISTRY_HPP
+#define MAKI_METRICS_REGISTRY_HPP
+
+#include "detail/metrics.hpp"
+#include <algorithm>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace maki
+{
+
+/**
+@brief Aggregates the metrics (see `maki::machine_conf::metrics()`) of any
+number of machines, and exports them in the OpenMetrics text format.
+
+@code
+auto registry = maki::metrics_registry{};
+registry.add_machine(machine1, "machine1");
+registry.add_machine(machine2, "machine2");
+std::cout << registry.to_openmetrics();
+@endcode
+
+The registry refers to the machines it's given, which must outlive it (or be
+removed with `remove_machine()` before being destructed). Exporting reads the
+metrics of the machines without synchronization, and must therefore be done by
+the thread that owns them, or while they're not processing anything.
+
+The exported metric families are:
+- `maki_state_entries` (counter), labelled by machine, region path and state;
+- `maki_state_dwell_seconds` (counter), labelled by machine, region path and
+state;
+- `maki_transitions` (counter), labelled by machine, region path, source state
+and target state, where `null` stands for the initial pseudostate (as a
+source) or the exit of the region (as a target), and `fin` stands for the
+final state;
+- `maki_unhandled_events` (counter), labelled by machine.
+*/
+class metrics_registry
+{
+public:
+    /**
+    @brief Adds a machine, whose metrics are labelled with `name`.
+    */
+    template<class Machine>
+    metrics_registry& add_machine(const Machine& mach, std::string name)
+    {
+        static_assert
+        (
+            impl_of(Machine::conf).metrics,
+            "`maki::machine_conf::metrics()` hasn't been set to `true`"
+        );
+
+        machines_.push_back
+        (
+            machine_entry
+            {
+                &mach,
+                std::move(name),
+                &detail::metrics_export<Machine>::write
+            }
+        );
+        return *this;
+    }
+
+    /**
+    @brief Removes a machine that has been added with `add_machine()`.
+    */
+    template<class Machine>
+    void remove_machine(const Machine& mach)
+    {
+        machines_.erase
+        (
+            std::remove_if
+            (
+                machines_.begin(),
+                machines_.end(),
+                [&mach](const machine_entry& entry)
+                {
+                    return entry.pmachine == &mach;
+                }
+            ),
+            machines_.end()
+        );
+    }
+
+    /**
+    @brief Writes the metrics of all the machines, in the OpenMetrics text
+    format.
+    */
+    void write_openmetrics(std::ostream& stream) const
+    {
+        write_family
+        (
+            stream,
+            detail::metric_family::state_entries,
+            "maki_state_entries",
+            "Number of times the state has been entered."
+        );
+        write_family
+        (
+            stream,
+            detail::metric_family::state_dwell_seconds,
+            "maki_state_dwell_seconds",
+            "Cumulative time spent in the state."
+        );
+        write_family
+        (
+            stream,
+            detail::metric_family::transitions,
+            "maki_transitions",
+            "Number of times the external transition has been executed."
+        );
+        write_family
+        (
+            stream,
+            detail::metric_family::unhandled_events,
+            "maki_unhandled_events",
+            "Number of events that no state or transition has handled."
+        );
+        stream << "# EOF\n";
+    }
+
+    /**
+    @brief Returns the metrics of all the machines, in the OpenMetrics text
+    format.
+    */
+    [[nodiscard]] std::string to_openmetrics() const
+    {
+        auto stream = std::ostringstream{};
+        write_openmetrics(stream);
+        return stream.str();
+    }
+
+private:
+    struct machine_entry
+    {
+        const void* pmachine;
+        std::string name;
+        void(*write)(std::ostream&, detail::metric_family, const void*, const std::string&);
+    };
+
+    void write_family
+    (
+        std::ostream& stream,
+        const detail::metric_family family,
+        const char* const name,
+        const char* const help
+    ) const
+    {
+        stream << "# TYPE " << name << " counter\n";
+        stream << "# HELP " << name << ' ' << help << '\n';
+        if(family == detail::metric_family::state_dwell_seconds)
+        {
+            stream << "# UNIT " << name << " seconds\n";
+        }
+        for(const auto& entry: machines_)
+        {
+            entry.write(stream, family, entry.pmachine, entry.name);
+        }
+    }
+
+    std::vector<machine_entry> machines_;
+};
+
+} //namespace
+
+#endif
@@ -0,0 +1,48 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+/**
+@file
+@brief Defines the maki::overflow_policy enum
+*/
+
+#ifndef MAKI_OVERFLOW_POLICY_HPP
+#define MAKI_OVERFLOW_POLICY_HPP
+
+namespace maki
+{
+
+/**
+@brief What a machine does with an event that must be queued while the queue
+is full.
+
+@see maki::machine_conf::event_queue_max_size()
+*/
+enum class overflow_policy: char
+{
+    /**
+    The new event is dropped. `maki::machine::push_event()` returns `false`.
+    This is the default.
+    */
+    reject,
+
+    /**
+    The oldest event of the queue (of the lowest priority, if several
+    priorities are used) is dropped to make room for the new event.
+    */
+    drop_oldest,
+
+    /**
+    The new event is given to the handler set with
+    `maki::machine_conf::event_queue_overflow_handler()`, and isn't queued.
+    `maki::machine::push_event()` returns `false`.
+    */
+    call_handler
+};
+
+} //namespace
+
+#endif
@@ -0,0 +1,380 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+/**
+@file
+@brief Defines the maki::runtime class
+*/
+
+#ifndef MAKI_RUNTIME_HPP
+#define MAKI_RUNTIME_HPP
+
+#include "machine.hpp"
+#include "detail/runtime_shard.hpp"
+#include <thread>
+#include <mutex>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <utility>
+#include <cstddef>
+
+namespace maki
+{
+
+/**
+@brief A pool of worker threads that owns many state machines and processes
+the events posted to them.
+
+Every machine is assigned to a worker (in a round-robin fashion) when it's
+added to the runtime. Posting an event to an idle machine puts the machine into
+the run queue of its worker, which processes all the events posted to the
+machine so far. Workers that run out of machines steal machines from the run
+queues of the other workers.
+
+Each machine is guaranteed to be run by at most one worker at a time, and every
+event is processed with `maki::machine::process_event()`, so that the
+run-to-completion semantics of the machine are preserved. The events posted by
+a given thread to a given machine are processed in the order they've been
+posted.
+
+The machines must be configured with
+`maki::machine_conf::post_event_enabled()` set to `true`. Since there is no way
+for the runtime to report an exception, they should also be configured with
+`maki::machine_conf::catch_mx()` (an exception escaping from a worker thread
+calls `std::terminate()`).
+*/
+class runtime
+{
+public:
+    /**
+    @brief A handle to a machine owned by a `maki::runtime`.
+
+    Handles are cheap to copy and can be used from any thread, as long as the
+    runtime is alive.
+    */
+    template<class Machine>
+    class handle
+    {
+    public:
+        /**
+        @brief Posts an event to the machine, for it to be processed by one of
+        the workers of the runtime.
+        @return `false` if the inbox of the machine is full (see
+        `maki::machine_conf::post_event_capacity()`), in which case the event
+        isn't posted
+
+        Like `maki::machine::post_event()`, this function never allocates
+        memory nor blocks, except when the machine is idle, in which case it
+        briefly locks the run queue of the worker of the machine.
+
+        If the copy of the event throws, the exception is propagated and the
+        event isn't processed.
+        */
+        template<class Event>
+        bool post_event(const Event& event) const
+        {
+            return post
+            (
+                [&](bool& was_idle)
+                {
+                    return pentry_->post_event(event, was_idle);
+                }
+            );
+        }
+
+        /**
+        @brief Like `post_event(event)`, but calls `on_processed()` from the
+        worker thread once the event has been processed
+        */
+        template<class Event, class Callback>
+        bool post_event(const Event& event, const Callback& on_processed) const
+        {
+            return post
+            (
+                [&](bool& was_idle)
+                {
+                    return pentry_->post_event(event, on_processed, was_idle);
+                }
+            );
+        }
+
+        /**
+        @brief Returns the machine.
+
+        The machine must not be accessed while the runtime may be processing
+        events for it (typically, call `maki::runtime::wait_idle()` first).
+        */
+        [[nodiscard]] Machine& machine() const
+        {
+            return pentry_->mach;
+        }
+
+    private:
+        friend class runtime;
+
+        handle(runtime& rt, detail::runtime_entry<Machine>& entry):
+            pruntime_(&rt),
+            pentry_(&entry)
+        {
+        }
+
+        /*
+        Even if the copy of the event throws, the event has been counted as
+        pending (see `detail::runtime_entry_base`), so that the machine must
+        be scheduled if it was idle.
+        */
+        template<class PostFun>
+        bool post(const PostFun& post_fun) const
+        {
+            auto was_idle = false;
+            auto posted = false;
+            try
+            {
+                posted = post_fun(was_idle);
+            }
+            catch(...)
+            {
+                if(was_idle)
+                {
+                    pruntime_->schedule(*pentry_);
+                }
+                throw;
+            }
+
+            if(was_idle)
+            {
+                pruntime_->schedule(*pentry_);
+            }
+            return posted;
+        }
+
+        runtime* pruntime_;
+        detail::runtime_entry<Machine>* pentry_;
+    };
+
+    /**
+    @brief The constructor.
+    @param worker_count the number of worker threads to start (at least one)
+    */
+    explicit runtime(std::size_t worker_count = std::thread::hardware_concurrency()):
+        shard_count_(worker_count == 0 ? 1 : worker_count),
+        shards_(std::make_unique<detail::runtime_shard[]>(shard_count_)) //NOLINT(cppcoreguidelines-avoid-c-arrays)
+    {
+        workers_.reserve(shard_count_);
+        try
+        {
+            for(auto i = std::size_t{0}; i < shard_count_; ++i)
+            {
+                workers_.emplace_back([this, i]{ work(i); });
+            }
+        }
+        catch(...)
+        {
+            stop_workers();
+            throw;
+        }
+    }
+
+    runtime(const runtime&) = delete;
+    runtime(runtime&&) = delete;
+    runtime& operator=(const runtime&) = delete;
+    runtime& operator=(runtime&&) = delete;
+
+    /**
+    @brief The destructor.
+
+    Stops the workers once they don't find any machine to run, then destroys
+    the machines. The events that are posted during the destruction may never
+    be processed; call `wait_idle()` beforehand if that matters.
+    */
+    ~runtime()
+    {
+        stop_workers();
+        for(const auto pentry: entries_)
+        {
+            pentry->destroy(pentry);
+        }
+    }
+
+    /**
+    @brief Constructs a machine owned by the runtime.
+    @param ctx_args the arguments to be forwarded to the constructor of the
+    machine
+
+    The machine is constructed (and therefore, unless
+    `maki::machine_conf::auto_start()` is set to `false`, started) by the
+    calling thread. Can be called from any thread.
+    */
+    template<class Machine, class... ContextArgs>
+    handle<Machine> add_machine(ContextArgs&&... ctx_args)
+    {
+        static_assert
+        (
+            impl_of(Machine::conf).post_event_enabled,
+            "`maki::machine_conf::post_event_enabled()` must be set to `true` for a machine to be added to a `maki::runtime`"
+        );
+
+        const auto lock = std::lock_guard<std::mutex>{entries_mutex_};
+
+        auto pentry = std::make_unique<detail::runtime_entry<Machine>>
+        (
+            entries_.size() % shard_count_,
+            std::forward<ContextArgs>(ctx_args)...
+        );
+        entries_.push_back(pentry.get());
+        return handle<Machine>{*this, *pentry.release()};
+    }
+
+    /**
+    @brief Blocks until every event that has been posted so far has been
+    processed.
+
+    Once this function returns, the effects of the processing of these events
+    are visible to the calling thread.
+    */
+    void wait_idle() const
+    {
+        while(busy_machine_count_.load(std::memory_order_acquire) != 0)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    /**
+    @brief Returns the number of worker threads.
+    */
+    [[nodiscard]] std::size_t worker_count() const
+    {
+        return shard_count_;
+    }
+
+private:
+    /*
+    How long an idle worker sleeps before looking for machines to steal again,
+    in case it hasn't been woken up by a new machine.
+    */
+    static constexpr auto steal_period = std::chrono::milliseconds{1};
+
+    void schedule(detail::runtime_entry_base& entry)
+    {
+        busy_machine_count_.fetch_add(1, std::memory_order_relaxed);
+
+        auto& home_shard = shards_[entry.home_shard_index];
+        if(home_shard.push(entry))
+        {
+            home_shard.wake();
+            return;
+        }
+
+        //The worker of the machine is busy. Wake an idle worker up, for it to
+        //steal the machine.
+        for(auto i = std::size_t{0}; i < shard_count_; ++i)
+        {
+            auto& shard = shards_[i];
+            if(shard.sleeping.load(std::memory_order_relaxed))
+            {
+                shard.wake();
+                return;
+            }
+        }
+    }
+
+    void work(const std::size_t shard_index)
+    {
+        auto& own_shard = shards_[shard_index];
+
+        while(true)
+        {
+            auto pentry = own_shard.try_pop();
+
+            if(pentry == nullptr)
+            {
+                pentry = steal(shard_index);
+            }
+
+            if(pentry == nullptr)
+            {
+                pentry = own_shard.wait_and_pop(stopping_, steal_period);
+            }
+
+            if(pentry != nullptr)
+            {
+                const auto count = pentry->process_posted_events(*pentry);
+                if(pentry->remove_pending_events(count))
+                {
+                    /*
+                    If no event has been processed, a producer has counted an
+                    event as pending but hasn't published it yet. Give it a
+                    chance to do so instead of spinning on the machine (which
+                    is put at the back of the run queue anyway).
+                    */
+                    if(count == 0)
+                    {
+                        std::this_thread::yield();
+                    }
+                    own_shard.push(*pentry);
+                }
+                else
+                {
+                    busy_machine_count_.fetch_sub(1, std::memory_order_release);
+                }
+            }
+            else if(stopping_.load(std::memory_order_relaxed))
+            {
+                return;
+            }
+        }
+    }
+
+    detail::runtime_entry_base* steal(const std::size_t thief_index)
+    {
+        for(auto i = std::size_t{1}; i < shard_count_; ++i)
+        {
+            const auto pentry = shards_[(thief_index + i) % shard_count_].try_steal();
+            if(pentry != nullptr)
+            {
+                return pentry;
+            }
+        }
+        return nullptr;
+    }
+
+    void stop_workers()
+    {
+        stopping_.store(true, std::memory_order_relaxed);
+        for(auto i = std::size_t{0}; i < workers_.size(); ++i)
+        {
+            shards_[i].wake();
+        }
+        for(auto& worker: workers_)
+        {
+            worker.join();
+        }
+        workers_.clear();
+    }
+
+    std::size_t shard_count_;
+    std::unique_ptr<detail::runtime_shard[]> shards_; //NOLINT(cppcoreguidelines-avoid-c-arrays)
+    std::vector<std::thread> workers_;
+    std::atomic<bool> stopping_{false};
+
+    /*
+    The number of machines that have events to process. Since a machine can
+    only post an event while it's busy, the machine that receives the event
+    becomes busy before the sender becomes idle. When this count reaches zero,
+    all the posted events have therefore been processed.
+    */
+    alignas(detail::cache_line_size) std::atomic<std::size_t> busy_machine_count_{0};
+
+    std::mutex entries_mutex_;
+    std::vector<detail::runtime_entry_base*> entries_;
+};
+
+} //namespace
+
+#endif
@@ -16,6 +16,7 @@
 #include "context.hpp"
 #include "event_set.hpp"
 #include "detail/state_mold_impl.hpp"
+#include "detail/state_timeout.hpp"
 #include "detail/type_set.hpp"
 #include "detail/type.hpp"
 #include "detail/event_action.hpp"
@@ -65,6 +66,7 @@ public:
     [[maybe_unused]] const auto MAKI_DETAIL_ARG_exit_actions = impl_.exit_actions; \
     [[maybe_unused]] const auto MAKI_DETAIL_ARG_pretty_name_view = impl_.pretty_name; \
     [[maybe_unused]] const auto MAKI_DETAIL_ARG_transition_tables = impl_.transition_tables; \
+    [[maybe_unused]] const auto MAKI_DETAIL_ARG_timeouts = impl_.timeouts; \
     [[maybe_unused]] const auto MAKI_DETAIL_ARG_deferred_event_type_set_type = detail::type<typename Impl::deferred_event_type_set>;
 
 #define MAKI_DETAIL_MAKE_STATE_CONF_COPY_END /*NOLINT(cppcoreguidelines-macro-usage)*/ \
@@ -77,7 +79,8 @@ public:
             std::decay_t<decltype(MAKI_DETAIL_ARG_internal_actions)>, \
             std::decay_t<decltype(MAKI_DETAIL_ARG_exit_actions)>, \
             std::decay_t<decltype(MAKI_DETAIL_ARG_transition_tables)>, \
-            typename std::decay_t<decltype(MAKI_DETAIL_ARG_deferred_event_type_set_type)>::type \
+            typename std::decay_t<decltype(MAKI_DETAIL_ARG_deferred_event_type_set_type)>::type, \
+            std::decay_t<decltype(MAKI_DETAIL_ARG_timeouts)> \
         > \
     > \
     { \
@@ -87,7 +90,8 @@ public:
         MAKI_DETAIL_ARG_internal_actions, \
         MAKI_DETAIL_ARG_exit_actions, \
         MAKI_DETAIL_ARG_pretty_name_view, \
-        MAKI_DETAIL_ARG_transition_tables \
+        MAKI_DETAIL_ARG_transition_tables, \
+        MAKI_DETAIL_ARG_timeouts \
     };
 
 #define MAKI_DETAIL_X(signature) /*NOLINT(cppcoreguidelines-macro-usage)*/ \
@@ -232,6 +236,30 @@ public:
 #undef MAKI_DETAIL_ARG_transition_tables
     }
 
+    /**
+    @brief Makes the machine process `event` once the state has been active
+    for `delay` ticks of the `maki::timer_service` of the machine (see
+    `maki::machine_conf::timer_service()`).
+
+    The timeout is armed right after the state is entered, and cancelled when
+    the state is exited, whatever the reason (including the exit of an
+    enclosing composite state and the stop of the machine). A state can have
+    several timeouts.
+    */
+    template<class Event>
+    [[nodiscard]] constexpr MAKI_DETAIL_STATE_CONF_RETURN_TYPE timeout(const timer_service::tick_count delay, const Event& event) const
+    {
+        const auto new_timeouts = impl_.timeouts.append
+        (
+            detail::state_timeout<Event>{delay, event}
+        );
+
+        MAKI_DETAIL_MAKE_STATE_CONF_COPY_BEGIN
+#define MAKI_DETAIL_ARG_timeouts new_timeouts
+        MAKI_DETAIL_MAKE_STATE_CONF_COPY_END
+#undef MAKI_DETAIL_ARG_timeouts
+    }
+
     /**
     @brief Add `Event` to the set of @ref event-deferral "deferred event" types.
     @note Available since Maki 1.2.0.
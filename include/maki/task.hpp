@@ -0,0 +1,250 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+/**
+@file
+@brief Defines the maki::task class
+*/
+
+#ifndef MAKI_TASK_HPP
+#define MAKI_TASK_HPP
+
+#include "detail/compiler.hpp"
+
+#if MAKI_DETAIL_COROUTINES
+#include <coroutine>
+#include <exception>
+#include <utility>
+#endif
+
+namespace maki
+{
+
+#if MAKI_DETAIL_COROUTINES || defined(MAKI_DETAIL_DOXYGEN)
+
+namespace detail
+{
+    struct async_action_caller;
+}
+
+/**
+@brief The return type of asynchronous actions.
+
+Any action (transition action, entry action, exit action or internal action)
+can be a coroutine that returns a `maki::task`. Such an action starts
+synchronously, like any other action. If it suspends itself (with `co_await`),
+the machine holds the operation it's executing "in flight": the processing of
+the current event goes on, but the machine processes no other event, and
+queues all the events it's given into its run-to-completion queue. Once every
+suspended action has completed, the machine processes the queued events, from
+the thread that resumes the last action.
+
+Note that the state transition itself doesn't wait for the action to complete:
+the active state changes as soon as the action is suspended.
+
+Asynchronous actions require `maki::machine_conf::run_to_completion()` to be
+set to `true` (which is the default). The machine must outlive its suspended
+actions.
+
+An exception that escapes from a suspended action (or from the processing of
+the queued events) is given to the exception handler of the machine (see
+`maki::machine_conf::catch_mx()`); if there is none, `std::terminate()` is
+called.
+
+Only available when compiling with C++20 coroutine support.
+*/
+class task
+{
+private:
+    using listener_type = void(*)(void* pobj, const std::exception_ptr& eptr) noexcept;
+
+    struct final_awaiter
+    {
+        [[nodiscard]] bool await_ready() const noexcept
+        {
+            return false;
+        }
+
+        /*
+        If nobody listens to the completion, the coroutine has completed
+        synchronously, and the `task` object still owns it. Otherwise, the
+        coroutine has been resumed by someone else, and it's up to us to
+        destroy it and notify the listener.
+        */
+        template<class Promise>
+        void await_suspend(const std::coroutine_handle<Promise> handle) const noexcept
+        {
+            auto& promise = handle.promise();
+            const auto listener = promise.listener_;
+            if(listener == nullptr)
+            {
+                return;
+            }
+
+            const auto plistener_obj = promise.plistener_obj_;
+            const auto eptr = std::move(promise.eptr_);
+            handle.destroy();
+            listener(plistener_obj, eptr);
+        }
+
+        void await_resume() const noexcept
+        {
+        }
+    };
+
+public:
+#ifndef MAKI_DETAIL_DOXYGEN
+    class promise_type
+    {
+    public:
+        task get_return_object()
+        {
+            return task{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+
+        [[nodiscard]] std::suspend_never initial_suspend() const noexcept
+        {
+            return {};
+        }
+
+        [[nodiscard]] final_awaiter final_suspend() const noexcept
+        {
+            return {};
+        }
+
+        void return_void()
+        {
+        }
+
+        void unhandled_exception()
+        {
+            eptr_ = std::current_exception();
+        }
+
+    private:
+        friend class task;
+        friend struct final_awaiter;
+
+        listener_type listener_ = nullptr;
+        void* plistener_obj_ = nullptr;
+        std::exception_ptr eptr_;
+    };
+#endif
+
+    task(const task&) = delete;
+
+    task(task&& other) noexcept:
+        handle_(std::exchange(other.handle_, {}))
+    {
+    }
+
+    task& operator=(const task&) = delete;
+    task& operator=(task&&) = delete;
+
+    ~task()
+    {
+        if(handle_)
+        {
+            handle_.destroy();
+        }
+    }
+
+private:
+    friend struct detail::async_action_caller;
+
+    using handle_type = std::coroutine_handle<promise_type>;
+
+    explicit task(const handle_type handle):
+        handle_(handle)
+    {
+    }
+
+    /*
+    If the coroutine has completed, rethrows the exception it has thrown (if
+    any) and returns `false`.
+
+    Otherwise, gives the ownership of the coroutine to the coroutine itself (so
+    that it's destroyed on completion), registers the given listener, and
+    returns `true`.
+    */
+    bool detach(const listener_type listener, void* const plistener_obj)
+    {
+        if(handle_.done())
+        {
+            if(const auto eptr = std::exchange(handle_.promise().eptr_, nullptr))
+            {
+                std::rethrow_exception(eptr);
+            }
+            return false;
+        }
+
+        auto& promise = handle_.promise();
+        promise.listener_ = listener;
+        promise.plistener_obj_ = plistener_obj;
+        handle_ = {};
+        return true;
+    }
+
+    handle_type handle_;
+};
+
+#endif
+
+namespace detail
+{
+    template<class T>
+    constexpr bool is_task_v = false;
+
+#if MAKI_DETAIL_COROUTINES
+    template<>
+    inline constexpr bool is_task_v<task> = true;
+
+    struct disabled_async_action_count
+    {
+    };
+
+    struct async_action_caller
+    {
+        template<class Machine>
+        static void hold(Machine& mach, task&& tsk)
+        {
+            static_assert
+            (
+                Machine::has_async_actions,
+                "This action returns a `maki::task`, but its callable is generic: `maki::machine_conf::async_actions_enabled()` must be set to `true`"
+            );
+
+            if(tsk.detach(&Machine::on_async_action_completion, &mach))
+            {
+                mach.on_async_action_suspension();
+            }
+        }
+    };
+#endif
+
+    /*
+    Calls `fun()`. If it returns a `maki::task`, lets `mach` hold the task
+    until it completes.
+    */
+    template<class Machine, class Fun>
+    void call_maybe_async_action([[maybe_unused]] Machine& mach, const Fun& fun)
+    {
+#if MAKI_DETAIL_COROUTINES
+        if constexpr(is_task_v<decltype(fun())>)
+        {
+            async_action_caller::hold(mach, fun());
+        }
+        else
+#endif
+        {
+            fun();
+        }
+    }
+}
+
+} //namespace
+
+#endif
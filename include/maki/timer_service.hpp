@@ -0,0 +1,343 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+/**
+@file
+@brief Defines the maki::timer_service class
+*/
+
+#ifndef MAKI_TIMER_SERVICE_HPP
+#define MAKI_TIMER_SERVICE_HPP
+
+#include <array>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+namespace maki
+{
+
+class timer_service;
+
+namespace detail
+{
+    /*
+    An intrusive timer, linked into a slot of a `timer_service` while it's
+    armed. The owner of the node (typically a region) must outlive its arming.
+    */
+    struct timer_node
+    {
+        using callback_type = void(*)(timer_node& node);
+
+        timer_node* pnext = nullptr;
+        timer_node** ppprev_next = nullptr; //Null when the timer isn't armed
+        std::uint64_t expiry = 0;
+        std::size_t slot_index = 0;
+        timer_service* pservice = nullptr;
+        callback_type callback = nullptr;
+        void* pobj = nullptr;
+    };
+
+    struct timer_service_access;
+}
+
+/**
+@brief A hierarchical timing wheel that fires the timeouts of the states (see
+`maki::state_mold::timeout()`).
+
+Time is measured in ticks, whose duration is up to the user: the service only
+moves forward when `advance()` is called (typically, periodically from a
+thread that also processes the events of the machines). Every timeout fires
+from `advance()`, by calling `maki::machine::process_event()`.
+
+Arming and cancelling a timeout take constant time, whatever the number of
+armed timeouts. Advancing time costs O(1) per slot of 64 ticks that is
+crossed, plus the cost of firing the expired timeouts and of moving the
+far-off timeouts to finer-grained slots as they get closer (which each timeout
+undergoes at most 5 times, or once every 2<sup>36</sup> ticks for even longer
+delays).
+
+A service is not thread-safe. It must outlive the timeouts it arms (i.e. the
+machines that use it must be stopped or destroyed first), or be destroyed while
+no timeout is armed.
+
+The service is set with `maki::machine_conf::timer_service()`.
+*/
+class timer_service
+{
+public:
+    /**
+    @brief The type of tick counts.
+    */
+    using tick_count = std::uint64_t;
+
+    timer_service() = default;
+
+    timer_service(const timer_service&) = delete;
+    timer_service(timer_service&&) = delete;
+    timer_service& operator=(const timer_service&) = delete;
+    timer_service& operator=(timer_service&&) = delete;
+
+    /**
+    @brief The destructor. The timeouts that are still armed never fire.
+    */
+    ~timer_service()
+    {
+        for(auto& phead: slots_)
+        {
+            while(phead != nullptr)
+            {
+                auto& node = *phead;
+                phead = node.pnext;
+                node.pnext = nullptr;
+                node.ppprev_next = nullptr;
+                node.pservice = nullptr;
+            }
+        }
+    }
+
+    /**
+    @brief Returns the number of ticks elapsed since the construction of the
+    service.
+    */
+    [[nodiscard]] tick_count now() const
+    {
+        return now_;
+    }
+
+    /**
+    @brief Returns the number of timeouts that are armed.
+    */
+    [[nodiscard]] std::size_t armed_count() const
+    {
+        return armed_count_;
+    }
+
+    /**
+    @brief Moves time forward by `count` ticks, and fires the timeouts that
+    expire in the meantime, in order of expiry.
+
+    Must not be called from an action or hook of a machine that uses the
+    service.
+    */
+    void advance(const tick_count count = 1)
+    {
+        const auto target = now_ + count;
+        while(now_ != target)
+        {
+            if(armed_count_ == 0)
+            {
+                now_ = target;
+                return;
+            }
+
+            now_ = std::min(next_busy_tick(), target);
+            process_tick();
+        }
+    }
+
+private:
+    friend struct detail::timer_service_access;
+
+    static constexpr auto level_bit_count = 6;
+    static constexpr auto level_count = 6;
+    static constexpr auto slot_count_per_level = std::size_t{1} << level_bit_count;
+    static constexpr auto slot_mask = tick_count{slot_count_per_level - 1};
+
+    /*
+    Arms `node` to fire `delay` ticks from now (or on the next tick if `delay`
+    is 0). Rearms the node if it's already armed.
+    */
+    void arm(detail::timer_node& node, const tick_count delay)
+    {
+        if(node.ppprev_next != nullptr)
+        {
+            cancel(node);
+        }
+
+        node.expiry = now_ + std::max(delay, tick_count{1});
+        node.pservice = this;
+        link(node);
+        ++armed_count_;
+    }
+
+    static void cancel(detail::timer_node& node)
+    {
+        if(node.ppprev_next == nullptr)
+        {
+            return;
+        }
+
+        auto& self = *node.pservice;
+        self.unlink(node);
+        --self.armed_count_;
+    }
+
+    static tick_count digit(const tick_count value, const int level)
+    {
+        return (value >> (level_bit_count * level)) & slot_mask;
+    }
+
+    /*
+    A timeout is stored at the level of the most significant digit (in base
+    `slot_count_per_level`) by which its expiry differs from now, in the slot
+    given by that digit of its expiry.
+    */
+    [[nodiscard]] std::size_t slot_index_of(const tick_count expiry) const
+    {
+        auto level = 0;
+        while
+        (
+            level < level_count - 1 &&
+            (expiry >> (level_bit_count * (level + 1))) != (now_ >> (level_bit_count * (level + 1)))
+        )
+        {
+            ++level;
+        }
+        return (static_cast<std::size_t>(level) * slot_count_per_level) + digit(expiry, level);
+    }
+
+    void link(detail::timer_node& node)
+    {
+        const auto slot_index = slot_index_of(node.expiry);
+        auto& phead = slots_[slot_index];
+
+        node.pnext = phead;
+        if(phead != nullptr)
+        {
+            phead->ppprev_next = &node.pnext;
+        }
+        phead = &node;
+        node.ppprev_next = &phead;
+        node.slot_index = slot_index;
+
+        if(slot_index < slot_count_per_level)
+        {
+            level_0_occupancy_ |= std::uint64_t{1} << slot_index;
+        }
+    }
+
+    void unlink(detail::timer_node& node)
+    {
+        *node.ppprev_next = node.pnext;
+        if(node.pnext != nullptr)
+        {
+            node.pnext->ppprev_next = node.ppprev_next;
+        }
+        node.pnext = nullptr;
+        node.ppprev_next = nullptr;
+
+        if(node.slot_index < slot_count_per_level && slots_[node.slot_index] == nullptr)
+        {
+            level_0_occupancy_ &= ~(std::uint64_t{1} << node.slot_index);
+        }
+    }
+
+    /*
+    Returns the next tick that has something to do: either firing the timeouts
+    of an occupied slot of level 0, or moving timeouts from upper levels.
+    */
+    [[nodiscard]] tick_count next_busy_tick() const
+    {
+        const auto current_digit = now_ & slot_mask;
+        const auto later_occupancy = current_digit == slot_mask ?
+            std::uint64_t{0} :
+            level_0_occupancy_ & (~std::uint64_t{0} << (current_digit + 1))
+        ;
+
+        if(later_occupancy != 0)
+        {
+            return now_ - current_digit + count_trailing_zeros(later_occupancy);
+        }
+        return (now_ | slot_mask) + 1;
+    }
+
+    static tick_count count_trailing_zeros(const std::uint64_t value)
+    {
+#if defined(__GNUC__)
+        return static_cast<tick_count>(__builtin_ctzll(value));
+#else
+        auto count = tick_count{0};
+        while(((value >> count) & 1) == 0)
+        {
+            ++count;
+        }
+        return count;
+#endif
+    }
+
+    void process_tick()
+    {
+        /*
+        When a digit of now wraps around, move the timeouts of the next slot
+        of the upper level to lower levels, starting from the uppermost level.
+        */
+        auto level = 1;
+        while(level < level_count && digit(now_, level - 1) == 0)
+        {
+            ++level;
+        }
+        for(--level; level > 0; --level)
+        {
+            cascade(level);
+        }
+
+        //Fire the timeouts of the current slot of level 0
+        auto& phead = slots_[digit(now_, 0)];
+        while(phead != nullptr)
+        {
+            auto& node = *phead;
+            unlink(node);
+            --armed_count_;
+            node.callback(node);
+        }
+    }
+
+    void cascade(const int level)
+    {
+        const auto slot_index =
+            (static_cast<std::size_t>(level) * slot_count_per_level) +
+            digit(now_, level)
+        ;
+
+        //Detach the whole list first, as some timeouts can go back to the same
+        //slot (the ones that are more than a full turn of the uppermost level
+        //away).
+        auto pnode = slots_[slot_index];
+        slots_[slot_index] = nullptr;
+        while(pnode != nullptr)
+        {
+            const auto pnext = pnode->pnext;
+            link(*pnode);
+            pnode = pnext;
+        }
+    }
+
+    std::array<detail::timer_node*, level_count * slot_count_per_level> slots_{};
+    std::uint64_t level_0_occupancy_ = 0;
+    tick_count now_ = 0;
+    std::size_t armed_count_ = 0;
+};
+
+namespace detail
+{
+    struct timer_service_access
+    {
+        static void arm(timer_service& service, timer_node& node, const timer_service::tick_count delay)
+        {
+            service.arm(node, delay);
+        }
+
+        static void cancel(timer_node& node)
+        {
+            timer_service::cancel(node);
+        }
+    };
+}
+
+} //namespace
+
+#endif
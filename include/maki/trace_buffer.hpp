@@ -0,0 +1,224 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+/**
+@file
+@brief Defines the maki::trace_record_kind enum, the maki::trace_record struct
+and the maki::trace_buffer class
+*/
+
+#ifndef MAKI_TRACE_BUFFER_HPP
+#define MAKI_TRACE_BUFFER_HPP
+
+#include <atomic>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace maki
+{
+
+/**
+@brief The kinds of `maki::trace_record`.
+*/
+enum class trace_record_kind: std::uint8_t
+{
+    /**
+    @brief An external transition of a region, recorded before the transition
+    is executed.
+    */
+    external_transition,
+
+    /**
+    @brief The processing of an event, recorded before the event is
+    dispatched to the regions.
+    */
+    event,
+
+    /**
+    @brief The start of the processing of the operations pending in the
+    run-to-completion queue of the machine (and of the deferred events).
+    */
+    rtc_drain_begin,
+
+    /**
+    @brief The end of the processing of the operations pending in the
+    run-to-completion queue of the machine (and of the deferred events).
+    */
+    rtc_drain_end
+};
+
+/**
+@brief A compact binary record of the activity of a machine (see
+`maki::trace_record_kind`), written by the machines for which
+`maki::machine_conf::tracing()` is set to `true`.
+
+Records are meant to be turned into text offline, by a
+`maki::trace_decoder`.
+*/
+struct trace_record
+{
+    /**
+    @brief The index used for initial transitions (in
+    `source_state_index`), for transitions that exit the region (in
+    `target_state_index`), and for events the machine doesn't know by type
+    (in `event_type_index`).
+    */
+    static constexpr auto none_index = std::uint16_t{0xFFFF};
+
+    /**
+    @brief The index used (in `target_state_index`) for transitions to the
+    final state.
+    */
+    static constexpr auto final_index = std::uint16_t{0xFFFE};
+
+    /**
+    @brief The number of nanoseconds since the epoch of
+    `std::chrono::steady_clock`.
+    */
+    std::uint64_t timestamp = 0;
+
+    /**
+    @brief The identifier given to the machine with
+    `maki::machine::set_trace_id()`.
+    */
+    std::uint32_t machine_id = 0;
+
+    /**
+    @brief The index of the region, among all the regions of the machine,
+    in depth-first order.
+
+    Only relevant to external transitions.
+    */
+    std::uint16_t region_index = 0;
+
+    /**
+    @brief The index of the type of the event among the types of the events
+    the machine reacts to.
+
+    Not relevant to run-to-completion queue drains.
+    */
+    std::uint16_t event_type_index = none_index;
+
+    /**
+    @brief The index of the source state, in the order of appearance in the
+    transition table of the region.
+
+    Only relevant to external transitions.
+    */
+    std::uint16_t source_state_index = none_index;
+
+    /**
+    @brief The index of the target state, in the order of appearance in the
+    transition table of the region.
+
+    Only relevant to external transitions.
+    */
+    std::uint16_t target_state_index = none_index;
+
+    /**
+    @brief The kind of the record.
+    */
+    trace_record_kind kind = trace_record_kind::external_transition;
+};
+
+/**
+@brief A fixed-capacity ring buffer of `maki::trace_record` objects.
+
+Every thread has its own buffer (see `this_thread()`), into which the machines
+that process events from that thread write. Writing a record takes no lock and
+allocates no memory. Once the buffer is full, the oldest records are
+overwritten.
+*/
+class trace_buffer
+{
+public:
+    /**
+    @brief The maximum number of records a buffer keeps.
+    */
+    static constexpr std::size_t capacity = 4096;
+
+    trace_buffer():
+        records_(capacity)
+    {
+    }
+
+    trace_buffer(const trace_buffer&) = delete;
+    trace_buffer(trace_buffer&&) = delete;
+    trace_buffer& operator=(const trace_buffer&) = delete;
+    trace_buffer& operator=(trace_buffer&&) = delete;
+    ~trace_buffer() = default;
+
+    /**
+    @brief Returns the buffer of the calling thread.
+    */
+    static trace_buffer& this_thread()
+    {
+        thread_local auto buffer = trace_buffer{};
+        return buffer;
+    }
+
+    /**
+    @brief Appends a record, overwriting the oldest one if the buffer is full.
+
+    Must only be called from the thread that owns the buffer.
+    */
+    void push(const trace_record& record) noexcept
+    {
+        const auto count = written_count_.load(std::memory_order_relaxed);
+        records_[static_cast<std::size_t>(count % capacity)] = record;
+        written_count_.store(count + 1, std::memory_order_release);
+    }
+
+    /**
+    @brief Returns the number of records written since the construction of
+    the buffer (or since the last call to `clear()`), including the ones that
+    have been overwritten.
+    */
+    [[nodiscard]] std::uint64_t written_count() const
+    {
+        return written_count_.load(std::memory_order_acquire);
+    }
+
+    /**
+    @brief Returns a copy of the records the buffer keeps, from the oldest to
+    the newest.
+
+    Must be called either from the thread that owns the buffer, or while that
+    thread doesn't write into it.
+    */
+    [[nodiscard]] std::vector<trace_record> dump() const
+    {
+        const auto count = written_count();
+        const auto kept_count = count < capacity ? count : std::uint64_t{capacity};
+
+        auto records = std::vector<trace_record>{};
+        records.reserve(static_cast<std::size_t>(kept_count));
+        for(auto i = count - kept_count; i != count; ++i)
+        {
+            records.push_back(records_[static_cast<std::size_t>(i % capacity)]);
+        }
+        return records;
+    }
+
+    /**
+    @brief Forgets all the records.
+
+    Must be called from the thread that owns the buffer.
+    */
+    void clear()
+    {
+        written_count_.store(0, std::memory_order_release);
+    }
+
+private:
+    std::vector<trace_record> records_;
+    std::atomic<std::uint64_t> written_count_{0};
+};
+
+} //namespace
+
+#endif
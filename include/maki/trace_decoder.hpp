@@ -0,0 +1,176 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+/**
+@file
+@brief Defines the maki::trace_decoder class and the functions that read and
+write trace dumps
+*/
+
+#ifndef MAKI_TRACE_DECODER_HPP
+#define MAKI_TRACE_DECODER_HPP
+
+#include "trace_buffer.hpp"
+#include "detail/trace.hpp"
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace maki
+{
+
+/**
+@brief Turns the `maki::trace_record` objects written by traced machines (see
+`maki::machine_conf::tracing()`) into human-readable text.
+
+A decoder must be told the type and the identifier (see
+`maki::machine::set_trace_id()`) of each machine whose records it decodes:
+
+@code
+auto decoder = maki::trace_decoder{};
+decoder.add_machine<machine_t>(1);
+std::cout << decoder.decode(maki::trace_buffer::this_thread().dump());
+@endcode
+
+Each record is decoded into a line of one of the following forms, depending on
+its kind (see `maki::trace_record_kind`):
+
+@code
+<timestamp> machine#<machine id> <region path>: <source state> -> <target state> (<event type>)
+<timestamp> machine#<machine id> event: <event type>
+<timestamp> machine#<machine id> rtc queue drain begin
+<timestamp> machine#<machine id> rtc queue drain end
+@endcode
+
+where `null` stands for the absence of a source state (i.e. an initial
+transition) or of a target state (i.e. the exit of the region), and `fin`
+stands for the final state.
+
+A decoder can also be given to `maki::write_chrome_trace()`.
+*/
+class trace_decoder
+{
+public:
+    /**
+    @brief Makes the decoder decode the records whose machine identifier is
+    `machine_id` as records of a machine of type `Machine`.
+    */
+    template<class Machine>
+    trace_decoder& add_machine(const std::uint32_t machine_id)
+    {
+        machines_.push_back
+        (
+            machine_entry
+            {
+                machine_id,
+                &detail::trace_decoding<Machine>::names
+            }
+        );
+        return *this;
+    }
+
+    /**
+    @brief Decodes one record, without trailing newline.
+
+    Records of unknown machines are decoded with raw indices.
+    */
+    [[nodiscard]] std::string decode(const trace_record& record) const
+    {
+        return detail::trace_record_to_string(record, names(record));
+    }
+
+    /**
+    @brief Decodes a sequence of records, one line per record.
+    */
+    [[nodiscard]] std::string decode(const std::vector<trace_record>& records) const
+    {
+        auto str = std::string{};
+        for(const auto& record: records)
+        {
+            str += decode(record);
+            str += '\n';
+        }
+        return str;
+    }
+
+private:
+    friend struct detail::chrome_trace_export;
+
+    struct machine_entry
+    {
+        std::uint32_t id;
+        detail::trace_record_names(*names)(const trace_record&);
+    };
+
+    [[nodiscard]] detail::trace_record_names names(const trace_record& record) const
+    {
+        for(const auto& entry: machines_)
+        {
+            if(entry.id == record.machine_id)
+            {
+                return entry.names(record);
+            }
+        }
+        return detail::raw_trace_record_names(record);
+    }
+
+    std::vector<machine_entry> machines_;
+};
+
+/**
+@brief Writes the given records in binary form, so that they can be decoded
+later (possibly by another process, built from the same sources) after having
+been read by `maki::read_trace_dump()`.
+*/
+inline void write_trace_dump(std::ostream& stream, const std::vector<trace_record>& records)
+{
+    const auto count = static_cast<std::uint64_t>(records.size());
+    stream.write(reinterpret_cast<const char*>(&count), sizeof(count)); //NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    if(!records.empty())
+    {
+        stream.write
+        (
+            reinterpret_cast<const char*>(records.data()), //NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+            static_cast<std::streamsize>(records.size() * sizeof(trace_record))
+        );
+    }
+}
+
+/**
+@brief Reads records written by `maki::write_trace_dump()`.
+
+Returns an empty vector if the stream doesn't contain a complete dump.
+*/
+inline std::vector<trace_record> read_trace_dump(std::istream& stream)
+{
+    auto count = std::uint64_t{};
+    if(!stream.read(reinterpret_cast<char*>(&count), sizeof(count))) //NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    {
+        return {};
+    }
+
+    auto records = std::vector<trace_record>(static_cast<std::size_t>(count));
+    if(!records.empty())
+    {
+        stream.read
+        (
+            reinterpret_cast<char*>(records.data()), //NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+            static_cast<std::streamsize>(records.size() * sizeof(trace_record))
+        );
+        if(!stream)
+        {
+            return {};
+        }
+    }
+    return records;
+}
+
+} //namespace
+
+#endif
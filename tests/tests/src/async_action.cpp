@@ -0,0 +1,210 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#ifdef __cpp_impl_coroutine
+
+#include <maki.hpp>
+#include "common.hpp"
+#include <coroutine>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace async_action_ns
+{
+    //Simulates an asynchronous I/O operation, completed by `complete()`
+    struct io_operation
+    {
+        [[nodiscard]] bool await_ready() const
+        {
+            return false;
+        }
+
+        void await_suspend(const std::coroutine_handle<> handle)
+        {
+            pending = handle;
+        }
+
+        void await_resume() const
+        {
+        }
+
+        void complete()
+        {
+            std::exchange(pending, {}).resume();
+        }
+
+        std::coroutine_handle<> pending;
+    };
+
+    struct context
+    {
+        io_operation io;
+        std::string out;
+        int always_zero = 0;
+    };
+
+    namespace events
+    {
+        struct connect{};
+        struct send{};
+        struct ping{};
+        struct fail{};
+        struct sync{};
+    }
+
+    namespace states
+    {
+        EMPTY_STATE(idle)
+        EMPTY_STATE(ready)
+
+        constexpr auto connected = maki::state_mold{}
+            .entry_action_c([](context& ctx) -> maki::task
+            {
+                ctx.out += "connected::entry_begin;";
+                co_await ctx.io;
+                ctx.out += "connected::entry_end;";
+            })
+            .internal_action_c<events::ping>([](context& ctx)
+            {
+                ctx.out += "ping;";
+            })
+            .internal_action_c<events::send>([](context& ctx) -> maki::task
+            {
+                ctx.out += "send_begin;";
+                co_await ctx.io;
+                ctx.out += "send_end;";
+            })
+            .internal_action_c<events::fail>([](context& ctx) -> maki::task
+            {
+                co_await ctx.io;
+                if(ctx.always_zero == 0)
+                {
+                    throw std::runtime_error{"fail"};
+                }
+            })
+            .internal_action_c<events::sync>([](context& ctx) -> maki::task
+            {
+                ctx.out += "sync;";
+                co_return;
+            })
+        ;
+    }
+
+    constexpr auto transition_table = maki::transition_table{}
+        (maki::ini,    states::idle)
+        (states::idle, states::connected, maki::event<events::connect>)
+    ;
+
+    constexpr auto machine_conf = maki::machine_conf{}
+        .transition_tables(transition_table)
+        .context_a<context>()
+        .catch_mx
+        (
+            [](auto& mach, const std::exception_ptr& eptr)
+            {
+                try
+                {
+                    std::rethrow_exception(eptr);
+                }
+                catch(const std::exception& ex)
+                {
+                    mach.context().out += std::string{"on_exception:"} + ex.what() + ";";
+                }
+            }
+        )
+    ;
+
+    using machine_t = maki::machine<machine_conf>;
+
+    //The return type of generic callables can't be known in advance
+    constexpr auto generic_transition_table = maki::transition_table{}
+        (maki::ini,    states::idle)
+        (
+            states::idle,
+            states::ready,
+            maki::event<events::connect>,
+            maki::action_m([](auto& mach) -> maki::task
+            {
+                auto& ctx = mach.context();
+                ctx.out += "connect_begin;";
+                co_await ctx.io;
+                ctx.out += "connect_end;";
+            })
+        )
+        (states::ready, states::idle, maki::event<events::ping>)
+    ;
+
+    constexpr auto generic_machine_conf = maki::machine_conf{}
+        .transition_tables(generic_transition_table)
+        .context_a<context>()
+        .async_actions_enabled(true)
+    ;
+
+    using generic_machine_t = maki::machine<generic_machine_conf>;
+}
+
+TEST_CASE("async_action")
+{
+    using namespace async_action_ns;
+
+    auto machine = machine_t{};
+    auto& ctx = machine.context();
+
+    //Entry action suspended: the events are held
+    machine.process_event(events::connect{});
+    REQUIRE(machine.is<states::connected>());
+    REQUIRE(ctx.out == "connected::entry_begin;");
+
+    machine.process_event(events::ping{});
+    machine.process_event(events::send{});
+    machine.process_event(events::ping{});
+    REQUIRE(ctx.out == "connected::entry_begin;");
+
+    //Completing the entry action processes the first ping, then suspends on
+    //the send action
+    ctx.out.clear();
+    ctx.io.complete();
+    REQUIRE(ctx.out == "connected::entry_end;ping;send_begin;");
+
+    ctx.out.clear();
+    ctx.io.complete();
+    REQUIRE(ctx.out == "send_end;ping;");
+
+    //An action that completes synchronously doesn't hold anything
+    ctx.out.clear();
+    machine.process_event(events::sync{});
+    machine.process_event(events::ping{});
+    REQUIRE(ctx.out == "sync;ping;");
+
+    //The exceptions of the resumed actions go to the exception handler
+    ctx.out.clear();
+    machine.process_event(events::fail{});
+    machine.process_event(events::ping{});
+    REQUIRE(ctx.out.empty());
+    ctx.io.complete();
+    REQUIRE(ctx.out == "on_exception:fail;ping;");
+}
+
+TEST_CASE("async_action: generic callable")
+{
+    using namespace async_action_ns;
+
+    auto machine = generic_machine_t{};
+    auto& ctx = machine.context();
+
+    machine.process_event(events::connect{});
+    machine.process_event(events::ping{});
+    REQUIRE(machine.is<states::ready>());
+    REQUIRE(ctx.out == "connect_begin;");
+
+    //Completing the transition action processes the held ping
+    ctx.io.complete();
+    REQUIRE(machine.is<states::idle>());
+    REQUIRE(ctx.out == "connect_begin;connect_end;");
+}
+
+#endif
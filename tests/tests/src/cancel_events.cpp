@@ -0,0 +1,137 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include <maki.hpp>
+#include "common.hpp"
+#include <chrono>
+#include <string>
+#include <thread>
+
+namespace cancel_events_ns
+{
+    struct context
+    {
+        std::string out;
+    };
+
+    namespace events
+    {
+        struct burst{};
+        struct unlock{};
+        struct lock{};
+
+        struct job
+        {
+            int id = 0;
+        };
+
+        struct progress
+        {
+            int percent = 0;
+        };
+
+        struct request
+        {
+            int id = 0;
+        };
+    }
+
+    namespace states
+    {
+        constexpr auto locked = maki::state_mold{}
+            .defer<events::request>()
+        ;
+
+        constexpr auto unlocked = maki::state_mold{}
+            .internal_action_m<events::burst>([](auto& mach)
+            {
+                for(auto i = 0; i != 5; ++i)
+                {
+                    mach.process_event(events::job{i});
+                }
+                mach.process_event(events::progress{10});
+
+                const auto removed_count = mach.template cancel_events_if<events::job>
+                (
+                    [](const events::job& event)
+                    {
+                        return event.id % 2 != 0;
+                    }
+                );
+                mach.context().out += "removed" + std::to_string(removed_count) + ";";
+
+                mach.context().out += "removed" + std::to_string(mach.template cancel_events<events::progress>()) + ";";
+                mach.process_event(events::progress{20});
+            })
+            .internal_action_ce<events::job>([](context& ctx, const events::job& event)
+            {
+                ctx.out += "job" + std::to_string(event.id) + ";";
+            })
+            .internal_action_ce<events::progress>([](context& ctx, const events::progress& event)
+            {
+                ctx.out += "progress" + std::to_string(event.percent) + ";";
+            })
+            .internal_action_ce<events::request>([](context& ctx, const events::request& event)
+            {
+                ctx.out += "request" + std::to_string(event.id) + ";";
+            })
+        ;
+    }
+
+    constexpr auto transition_table = maki::transition_table{}
+        (maki::ini,        states::locked)
+        (states::locked,   states::unlocked, maki::event<events::unlock>)
+        (states::unlocked, states::locked,   maki::event<events::lock>)
+    ;
+
+    constexpr auto machine_conf = maki::machine_conf{}
+        .transition_tables(transition_table)
+        .context_a<context>()
+        .coalesce<events::progress>(maki::coalescing_policy::keep_latest)
+    ;
+
+    using machine_t = maki::machine<machine_conf>;
+}
+
+TEST_CASE("cancel_events")
+{
+    using namespace cancel_events_ns;
+    using clock = std::chrono::steady_clock;
+
+    auto machine = machine_t{};
+    auto& ctx = machine.context();
+
+    //Cancel deferred events
+    machine.process_event(events::request{0});
+    machine.process_event(events::request{1});
+    REQUIRE(machine.cancel_events<events::request>() == 2);
+    machine.process_event(events::request{2});
+    machine.process_event(events::unlock{});
+    REQUIRE(ctx.out == "request2;");
+
+    //Cancel queued events, including coalesced ones
+    ctx.out.clear();
+    machine.process_event(events::burst{});
+    REQUIRE(ctx.out == "removed2;removed1;job0;job2;job4;progress20;");
+
+    //Expired events are dropped from the run-to-completion queue
+    ctx.out.clear();
+    REQUIRE(machine.push_event(events::job{0}, clock::now() - std::chrono::seconds{1}));
+    REQUIRE(machine.push_event(events::job{1}, clock::now() + std::chrono::hours{1}));
+    machine.process_event(events::job{2});
+    REQUIRE(ctx.out == "job2;job1;");
+
+    //Expired events are dropped from the event deferral queue
+    ctx.out.clear();
+    machine.process_event(events::lock{});
+    REQUIRE(machine.push_event(events::request{0}, clock::now() + std::chrono::milliseconds{20}));
+    REQUIRE(machine.push_event(events::request{1}, clock::now() + std::chrono::hours{1}));
+    machine.process_event(events::lock{}); //Defers the pushed requests
+    REQUIRE(ctx.out.empty());
+    std::this_thread::sleep_for(std::chrono::milliseconds{40});
+    machine.process_event(events::unlock{});
+    REQUIRE(ctx.out == "request1;");
+}
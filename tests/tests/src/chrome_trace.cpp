@@ -0,0 +1,150 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include <maki.hpp>
+#include "common.hpp"
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+
+namespace chrome_trace_ns
+{
+    struct context{};
+
+    namespace events
+    {
+        struct power_button_press{};
+        struct next{};
+    }
+
+    namespace states
+    {
+        constexpr auto off = maki::state_mold{}
+            .pretty_name("off \"standby\"")
+        ;
+
+        constexpr auto red = maki::state_mold{}
+            .pretty_name("red")
+        ;
+
+        constexpr auto green = maki::state_mold{}
+            .pretty_name("green")
+        ;
+
+        constexpr auto on_transition_table = maki::transition_table{}
+            (maki::ini, red)
+            (red,       green, maki::event<events::next>)
+        ;
+
+        constexpr auto on = maki::state_mold{}
+            .transition_tables(on_transition_table)
+            .pretty_name("on")
+        ;
+    }
+
+    constexpr auto emit_next = maki::action_m
+    (
+        [](auto& mach)
+        {
+            mach.process_event(events::next{});
+        }
+    );
+
+    constexpr auto transition_table = maki::transition_table{}
+        (maki::ini,   states::off)
+        (states::off, states::on,  maki::event<events::power_button_press>, emit_next)
+        (states::on,  states::off, maki::event<events::power_button_press>)
+    ;
+
+    constexpr auto machine_conf = maki::machine_conf{}
+        .transition_tables(transition_table)
+        .context_a<context>()
+        .auto_start(false)
+        .tracing(true)
+    ;
+
+    using machine_t = maki::machine<machine_conf>;
+
+    bool contains(const std::string& str, const std::string& substr)
+    {
+        return str.find(substr) != std::string::npos;
+    }
+
+    std::size_t count(const std::string& str, const std::string& substr)
+    {
+        auto n = std::size_t{0};
+        for(auto pos = str.find(substr); pos != std::string::npos; pos = str.find(substr, pos + 1))
+        {
+            ++n;
+        }
+        return n;
+    }
+}
+
+TEST_CASE("chrome_trace")
+{
+    using namespace chrome_trace_ns;
+
+    auto& buffer = maki::trace_buffer::this_thread();
+    buffer.clear();
+
+    auto machine1 = machine_t{};
+    machine1.set_trace_id(1);
+    auto machine2 = machine_t{};
+    machine2.set_trace_id(2);
+
+    machine1.start();
+    machine2.start();
+
+    //Processes `next` from the run-to-completion queue
+    machine1.process_event(events::power_button_press{});
+
+    const auto records = buffer.dump();
+
+    auto decoder = maki::trace_decoder{};
+    decoder
+        .add_machine<machine_t>(1)
+        .add_machine<machine_t>(2)
+    ;
+
+    auto stream = std::ostringstream{};
+    maki::write_chrome_trace(stream, decoder, records);
+    const auto json = stream.str();
+
+    REQUIRE(json.rfind("{\"traceEvents\":[", 0) == 0);
+    REQUIRE(json.substr(json.size() - 4) == "\n]}\n");
+
+    //Tracks
+    REQUIRE(contains(json, R"({"name":"process_name","ph":"M","pid":1,"tid":0,"args":{"name":"machine#1"}})"));
+    REQUIRE(contains(json, R"({"name":"process_name","ph":"M","pid":2,"tid":0,"args":{"name":"machine#2"}})"));
+    REQUIRE(contains(json, R"({"name":"thread_name","ph":"M","pid":1,"tid":0,"args":{"name":"events"}})"));
+    REQUIRE(contains(json, R"({"name":"thread_name","ph":"M","pid":1,"tid":1,"args":{"name":"0"}})"));
+    REQUIRE(contains(json, R"({"name":"thread_name","ph":"M","pid":1,"tid":2,"args":{"name":"0/on/0"}})"));
+
+    //States: off, on, red, green for machine1; off for machine2
+    REQUIRE(count(json, R"("cat":"state","ph":"X")") == 5);
+    REQUIRE(count(json, R"({"name":"off \"standby\"","cat":"state","ph":"X")") == 2);
+    REQUIRE(contains(json, R"("pid":1,"tid":2,"args":{"event":"next"}})"));
+
+    //Events and drains
+    REQUIRE(count(json, R"({"name":"power_button_press","cat":"event","ph":"i","s":"t")") == 1);
+    REQUIRE(count(json, R"({"name":"next","cat":"event","ph":"i","s":"t")") == 1);
+    REQUIRE(count(json, R"({"name":"rtc queue drain","cat":"rtc","ph":"X")") == 1);
+
+    //File
+    const auto file_path = std::string{"chrome_trace_test.json"};
+    REQUIRE(maki::write_chrome_trace_file(file_path, decoder, records));
+    {
+        auto file = std::ifstream{file_path};
+        const auto file_content = std::string{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+        REQUIRE(file_content == json);
+    }
+    std::remove(file_path.c_str());
+
+    buffer.clear();
+}
@@ -0,0 +1,126 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include <maki.hpp>
+#include "common.hpp"
+#include <string>
+
+namespace coalescing_ns
+{
+    struct context
+    {
+        std::string out;
+    };
+
+    namespace events
+    {
+        struct burst{};
+        struct tick{};
+        struct unlock{};
+
+        struct progress
+        {
+            int percent = 0;
+        };
+
+        struct sample
+        {
+            int value = 0;
+        };
+
+        struct request
+        {
+            int id = 0;
+        };
+    }
+
+    namespace states
+    {
+        constexpr auto locked = maki::state_mold{}
+            .defer<events::request>()
+        ;
+
+        constexpr auto unlocked = maki::state_mold{}
+            .internal_action_m<events::burst>([](auto& mach)
+            {
+                mach.process_event(events::progress{10});
+                mach.process_event(events::sample{1});
+                mach.process_event(events::progress{20});
+                mach.process_event(events::tick{});
+                mach.process_event(events::sample{2});
+                mach.process_event(events::tick{});
+                mach.process_event(events::progress{30});
+            })
+            .internal_action_ce<events::progress>([](context& ctx, const events::progress& event)
+            {
+                ctx.out += "progress" + std::to_string(event.percent) + ";";
+            })
+            .internal_action_ce<events::sample>([](context& ctx, const events::sample& event)
+            {
+                ctx.out += "sample" + std::to_string(event.value) + ";";
+            })
+            .internal_action_c<events::tick>([](context& ctx)
+            {
+                ctx.out += "tick;";
+            })
+            .internal_action_ce<events::request>([](context& ctx, const events::request& event)
+            {
+                ctx.out += "request" + std::to_string(event.id) + ";";
+            })
+        ;
+    }
+
+    constexpr auto transition_table = maki::transition_table{}
+        (maki::ini,        states::locked)
+        (states::locked,   states::unlocked, maki::event<events::unlock>)
+    ;
+
+    constexpr auto machine_conf = maki::machine_conf{}
+        .transition_tables(transition_table)
+        .context_a<context>()
+        .coalesce<events::progress>(maki::coalescing_policy::keep_latest)
+        .coalesce<events::tick>(maki::coalescing_policy::keep_oldest)
+        .coalesce<events::sample>([](events::sample& pending_event, const events::sample& new_event)
+        {
+            pending_event.value += new_event.value;
+        })
+        .coalesce<events::request>(maki::coalescing_policy::keep_latest)
+    ;
+
+    using machine_t = maki::machine<machine_conf>;
+}
+
+TEST_CASE("coalescing")
+{
+    using namespace coalescing_ns;
+
+    auto machine = machine_t{};
+    auto& ctx = machine.context();
+
+    //Coalescing in the event deferral queue
+    machine.process_event(events::request{1});
+    machine.process_event(events::request{2});
+    machine.process_event(events::request{3});
+    REQUIRE(ctx.out.empty());
+    machine.process_event(events::unlock{});
+    REQUIRE(ctx.out == "request3;");
+
+    //Coalescing in the run-to-completion queue
+    ctx.out.clear();
+    machine.process_event(events::burst{});
+    REQUIRE(ctx.out == "progress30;sample3;tick;");
+
+    //Events pushed from outside are coalesced as well
+    ctx.out.clear();
+    machine.push_event(events::progress{40});
+    machine.push_event(events::progress{50});
+    machine.process_event(events::tick{});
+    REQUIRE(ctx.out == "tick;progress50;");
+
+    ctx.out.clear();
+    machine.process_event(events::burst{});
+    REQUIRE(ctx.out == "progress30;sample3;tick;");
+}
@@ -0,0 +1,100 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include <maki.hpp>
+#include "common.hpp"
+#include <string>
+
+namespace defer_composite_ns
+{
+    struct context
+    {
+        std::string out;
+    };
+
+    namespace events
+    {
+        struct next{};
+        struct ping{};
+        struct pong{};
+    }
+
+    namespace states
+    {
+        EMPTY_STATE(idle)
+
+        constexpr auto waiting = maki::state_mold{}
+            .defer<events::ping>()
+        ;
+
+        constexpr auto ready = maki::state_mold{}
+            .internal_action_c<events::ping>
+            (
+                [](context& ctx)
+                {
+                    ctx.out += "ping;";
+                }
+            )
+            .internal_action_c<events::pong>
+            (
+                [](context& ctx)
+                {
+                    ctx.out += "pong;";
+                }
+            )
+        ;
+
+        //Defers `ping` through its `waiting` substate, and `pong` by itself.
+        constexpr auto busy = maki::state_mold{}
+            .transition_tables
+            (
+                maki::transition_table{}
+                    (maki::ini, waiting)
+                    (waiting,   maki::fin, maki::event<events::next>)
+            )
+            .defer<events::pong>()
+        ;
+    }
+
+    constexpr auto transition_table = maki::transition_table{}
+        (maki::ini,     states::idle)
+        (states::idle,  states::busy,  maki::event<events::next>)
+        (states::busy,  states::ready)
+    ;
+
+    constexpr auto machine_conf = maki::machine_conf{}
+        .transition_tables(transition_table)
+        .context_a<context>()
+    ;
+
+    using machine_t = maki::machine<machine_conf>;
+}
+
+TEST_CASE("defer_composite")
+{
+    using namespace defer_composite_ns;
+
+    auto machine = machine_t{};
+    auto& ctx = machine.context();
+
+    //Not deferred by `idle`
+    machine.process_event(events::ping{});
+    machine.process_event(events::pong{});
+    REQUIRE(ctx.out.empty());
+
+    machine.process_event(events::next{});
+    REQUIRE(machine.is<states::busy>());
+
+    //Deferred by `busy` and its `waiting` substate
+    machine.process_event(events::pong{});
+    machine.process_event(events::ping{});
+    REQUIRE(ctx.out.empty());
+
+    //`waiting` -> fin, then `busy` -> `ready`
+    machine.process_event(events::next{});
+    REQUIRE(machine.is<states::ready>());
+    REQUIRE(ctx.out == "pong;ping;");
+}
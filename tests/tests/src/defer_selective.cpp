@@ -0,0 +1,100 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include <maki.hpp>
+#include "common.hpp"
+#include <string>
+
+namespace defer_selective_ns
+{
+    struct context
+    {
+        std::string out;
+    };
+
+    namespace events
+    {
+        struct e1
+        {
+            int i = 0;
+        };
+
+        struct e2
+        {
+            int i = 0;
+        };
+
+        struct next{};
+        struct noop{};
+    }
+
+    namespace states
+    {
+        constexpr auto append_e1 = [](context& ctx, const events::e1& event)
+        {
+            ctx.out += "e1_" + std::to_string(event.i) + ";";
+        };
+
+        constexpr auto append_e2 = [](context& ctx, const events::e2& event)
+        {
+            ctx.out += "e2_" + std::to_string(event.i) + ";";
+        };
+
+        constexpr auto a = maki::state_mold{}
+            .defer<events::e1>()
+            .defer<events::e2>()
+            .internal_action_v<events::noop>([]{});
+
+        constexpr auto b = maki::state_mold{}
+            .defer<events::e2>()
+            .internal_action_ce<events::e1>(append_e1);
+
+        constexpr auto c = maki::state_mold{}
+            .internal_action_ce<events::e1>(append_e1)
+            .internal_action_ce<events::e2>(append_e2);
+    }
+
+    constexpr auto transition_table = maki::transition_table{}
+        (maki::ini, states::a)
+        (states::a, states::b, maki::event<events::next>)
+        (states::b, states::c, maki::event<events::next>)
+    ;
+
+    constexpr auto machine_conf = maki::machine_conf{}
+        .transition_tables(transition_table)
+        .context_a<context>()
+    ;
+
+    using machine_t = maki::machine<machine_conf>;
+}
+
+TEST_CASE("defer_selective")
+{
+    using namespace defer_selective_ns;
+
+    auto machine = machine_t{};
+    auto& ctx = machine.context();
+
+    machine.process_event(events::e1{0});
+    machine.process_event(events::e2{0});
+    machine.process_event(events::e1{1});
+    machine.process_event(events::e2{1});
+    machine.process_event(events::noop{});
+    REQUIRE(ctx.out.empty());
+
+    //Only the e1 events aren't deferred anymore
+    machine.process_event(events::next{});
+    REQUIRE(ctx.out == "e1_0;e1_1;");
+
+    machine.process_event(events::e2{2});
+    machine.process_event(events::e1{2});
+    REQUIRE(ctx.out == "e1_0;e1_1;e1_2;");
+
+    //The e2 events are processed in the order they've been given
+    ctx.out.clear();
+    machine.process_event(events::next{});
+    REQUIRE(ctx.out == "e2_0;e2_1;e2_2;");
+}
@@ -0,0 +1,46 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include "../common.hpp"
+#include <maki/detail/bitset.hpp>
+
+namespace
+{
+    template<int Size, int... Indices>
+    constexpr auto make_bitset()
+    {
+        auto bits = maki::detail::bitset<Size>{};
+        (bits.set(Indices), ...);
+        return bits;
+    }
+}
+
+TEST_CASE("detail::bitset")
+{
+    constexpr auto empty = make_bitset<10>();
+    REQUIRE(empty.none());
+    REQUIRE(empty.contiguous());
+
+    constexpr auto range = make_bitset<10, 3, 4, 5>();
+    REQUIRE(!range.none());
+    REQUIRE(!range.test(2));
+    REQUIRE(range.test(3));
+    REQUIRE(range.test(5));
+    REQUIRE(!range.test(6));
+    REQUIRE(range.first() == 3);
+    REQUIRE(range.last() == 5);
+    REQUIRE(range.contiguous());
+
+    constexpr auto holes = make_bitset<130, 0, 64, 129>();
+    REQUIRE(holes.test(0));
+    REQUIRE(!holes.test(1));
+    REQUIRE(!holes.test(63));
+    REQUIRE(holes.test(64));
+    REQUIRE(holes.test(129));
+    REQUIRE(holes.first() == 0);
+    REQUIRE(holes.last() == 129);
+    REQUIRE(!holes.contiguous());
+}
@@ -7,17 +7,46 @@
 #include <maki/detail/function_queue.hpp>
 #include "../common.hpp"
 #include <array>
+#include <string>
 
 namespace
 {
     using big_array_t = std::array<int, 10>;
 
     auto plain_new_call_count = 0;
-    auto destructor_call_count = 0;
+    auto instance_count = 0;
+
+    //Counts the live instances of the struct it's a member of
+    struct instance_counter
+    {
+        instance_counter()
+        {
+            ++instance_count;
+        }
+
+        instance_counter(const instance_counter& /*other*/)
+        {
+            ++instance_count;
+        }
+
+        instance_counter(instance_counter&& /*other*/) noexcept
+        {
+            ++instance_count;
+        }
+
+        instance_counter& operator=(const instance_counter&) = default;
+        instance_counter& operator=(instance_counter&&) = default;
+
+        ~instance_counter()
+        {
+            --instance_count;
+        }
+    };
 
     struct small_struct
     {
         int i = 0;
+        instance_counter counter;
 
         static void* operator new(size_t size)
         {
@@ -35,16 +64,12 @@ namespace
         {
             ::operator delete(ptr);
         }
-
-        ~small_struct()
-        {
-            ++destructor_call_count;
-        }
     };
 
     struct big_struct
     {
         big_array_t numbers;
+        instance_counter counter;
 
         static void* operator new(size_t size)
         {
@@ -56,11 +81,6 @@ namespace
         {
             ::operator delete(ptr);
         }
-
-        ~big_struct()
-        {
-            ++destructor_call_count;
-        }
     };
 
     const auto big_array = big_array_t{{0, 1, 2, 3, 4, 5, 6, 7, 8, 9}};
@@ -87,14 +107,14 @@ namespace
 
 TEST_CASE("detail::function_queue")
 {
-    destructor_call_count = 0;
+    instance_count = 0;
     plain_new_call_count = 0;
 
     {
-        auto psmall = new small_struct{number};
+        auto psmall = new small_struct{number, {}};
         REQUIRE(plain_new_call_count == 1);
 
-        auto pbig = new big_struct{big_array};
+        auto pbig = new big_struct{big_array, {}};
         REQUIRE(plain_new_call_count == 2);
 
         auto small_function_queue = maki::detail::function_queue
@@ -114,25 +134,166 @@ TEST_CASE("detail::function_queue")
         REQUIRE(plain_new_call_count == 3);
 
         delete psmall;
-        REQUIRE(destructor_call_count == 1);
+        REQUIRE(instance_count == 3);
 
         {
             auto i = 0;
             small_function_queue.invoke_and_pop_all(i);
             REQUIRE(i == number);
-            REQUIRE(destructor_call_count == 2);
+            REQUIRE(instance_count == 2);
         }
 
         delete pbig;
-        REQUIRE(destructor_call_count == 3);
+        REQUIRE(instance_count == 1);
 
         {
             auto arr = big_array_t{};
             big_function_queue.invoke_and_pop_all(arr);
             REQUIRE(arr == big_array);
-            REQUIRE(destructor_call_count == 4);
+            REQUIRE(instance_count == 0);
+        }
+    }
+
+    REQUIRE(instance_count == 0);
+}
+
+namespace
+{
+    using ring_queue_t = maki::detail::function_queue<std::string&, sizeof(int)>;
+
+    struct append_and_repush
+    {
+        static bool call(const int& value, std::string& out);
+    };
+
+    ring_queue_t* pqueue = nullptr;
+
+    bool append_and_repush::call(const int& value, std::string& out)
+    {
+        out += std::to_string(value) + ";";
+
+        //Push several functions (which reallocates the buffer) while the
+        //current one is being called
+        if(value < 3)
+        {
+            for(auto i = 0; i < 8; ++i)
+            {
+                pqueue->push<append_and_repush>(value * 10 + 10);
+            }
+        }
+
+        return true;
+    }
+}
+
+TEST_CASE("detail::function_queue: ring buffer")
+{
+    auto queue = ring_queue_t{};
+    pqueue = &queue;
+
+    REQUIRE(queue.capacity() == 0);
+
+    queue.reserve(16);
+    REQUIRE(queue.capacity() == 16);
+
+    //Wrap around without growing
+    auto out = std::string{};
+    for(auto i = 0; i < 40; ++i)
+    {
+        queue.push<append_and_repush>(100 + i);
+        queue.push<append_and_repush>(200 + i);
+        queue.invoke_and_pop(out);
+        queue.invoke_and_pop(out);
+    }
+    REQUIRE(queue.empty());
+    REQUIRE(queue.capacity() == 16);
+
+    //Grow while invoking
+    out.clear();
+    queue.push<append_and_repush>(0);
+    queue.invoke_and_pop_all(out);
+    REQUIRE(out == "0;10;10;10;10;10;10;10;10;");
+    REQUIRE(queue.capacity() == 16);
+
+    out.clear();
+    queue.push<append_and_repush>(1);
+    queue.push<append_and_repush>(2);
+    REQUIRE(queue.invoke_and_pop(out));
+    REQUIRE(queue.invoke_and_pop(out));
+    REQUIRE(queue.size() == 16);
+    REQUIRE(queue.capacity() == 16);
+    queue.push<append_and_repush>(3);
+    REQUIRE(queue.capacity() == 32);
+    queue.invoke_and_pop_all(out);
+    REQUIRE(out == "1;2;20;20;20;20;20;20;20;20;30;30;30;30;30;30;30;30;3;");
+
+    //Never shrink
+    REQUIRE(queue.capacity() == 32);
+}
+
+namespace
+{
+    struct append_or_drop
+    {
+        static bool call(const int& value, std::string& out)
+        {
+            out += std::to_string(value) + ";";
+            return true;
         }
+
+        static void drop(const int& value, std::string& out)
+        {
+            out += "drop" + std::to_string(value) + ";";
+        }
+    };
+}
+
+TEST_CASE("detail::function_queue: drop_front")
+{
+    auto queue = ring_queue_t{};
+    auto out = std::string{};
+
+    queue.push<append_or_drop>(1);
+    queue.push<append_or_drop>(2);
+    queue.push<append_and_repush>(3);
+
+    queue.drop_front(out);
+    REQUIRE(out == "drop1;");
+    REQUIRE(queue.size() == 2);
+
+    //No drop() function
+    queue.invoke_and_pop(out);
+    queue.drop_front(out);
+    REQUIRE(out == "drop1;2;");
+    REQUIRE(queue.empty());
+}
+
+TEST_CASE("detail::function_queue: remove_if")
+{
+    auto queue = ring_queue_t{};
+    auto out = std::string{};
+
+    for(auto i = 0; i < 6; ++i)
+    {
+        queue.push<append_or_drop>(i);
     }
+    queue.push<append_and_repush>(10);
 
-    REQUIRE(destructor_call_count == 4);
+    const auto removed_count = queue.remove_if<append_or_drop, maki::detail::type_list_t<int>>
+    (
+        [](const int value)
+        {
+            return value % 2 == 0;
+        },
+        out
+    );
+    REQUIRE(removed_count == 3);
+    REQUIRE(out == "drop0;drop2;drop4;");
+
+    out.clear();
+    while(!queue.empty())
+    {
+        queue.invoke_and_pop(out);
+    }
+    REQUIRE(out == "1;3;5;10;");
 }
@@ -0,0 +1,73 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include <maki/detail/large_data_storage.hpp>
+#include "../common.hpp"
+#include <array>
+#include <new>
+#include <cstddef>
+
+namespace
+{
+    auto allocation_count = 0;
+    auto deallocation_count = 0;
+
+    struct counting_allocator
+    {
+        [[nodiscard]] void* allocate(const std::size_t size, const std::size_t alignment) const
+        {
+            ++allocation_count;
+            return ::operator new(size, std::align_val_t{alignment});
+        }
+
+        void deallocate(void* const ptr, const std::size_t /*size*/, const std::size_t alignment) const
+        {
+            ++deallocation_count;
+            ::operator delete(ptr, std::align_val_t{alignment});
+        }
+    };
+
+    using data_t = std::array<char, 40>;
+}
+
+TEST_CASE("detail::large_data_storage")
+{
+    allocation_count = 0;
+    deallocation_count = 0;
+
+    {
+        auto storage = maki::detail::large_data_storage<counting_allocator, 100>{};
+
+        //The arena is allocated on first use
+        const auto pdata0 = storage.create(data_t{{'a'}});
+        REQUIRE(allocation_count == 1);
+        REQUIRE((*pdata0)[0] == 'a');
+
+        //The second data still fits into the arena
+        const auto pdata1 = storage.create(data_t{{'b'}});
+        REQUIRE(allocation_count == 1);
+
+        //The third one doesn't
+        const auto pdata2 = storage.create(data_t{{'c'}});
+        REQUIRE(allocation_count == 2);
+
+        storage.destroy(pdata2);
+        REQUIRE(deallocation_count == 1);
+
+        //The arena is reset once all of its data is destroyed
+        storage.destroy(pdata0);
+        storage.destroy(pdata1);
+        const auto pdata3 = storage.create(data_t{{'d'}});
+        REQUIRE(pdata3 == pdata0);
+        REQUIRE(allocation_count == 2);
+        storage.destroy(pdata3);
+
+        REQUIRE(deallocation_count == 1);
+    }
+
+    //The arena is deallocated on destruction
+    REQUIRE(deallocation_count == 2);
+}
@@ -0,0 +1,23 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include "../common.hpp"
+#include <maki/detail/smallest_int.hpp>
+#include <cstdint>
+#include <type_traits>
+
+TEST_CASE("detail::smallest_int")
+{
+    using maki::detail::smallest_int_t;
+
+    REQUIRE(std::is_same_v<smallest_int_t<-1, 0>, std::int8_t>);
+    REQUIRE(std::is_same_v<smallest_int_t<-1, 127>, std::int8_t>);
+    REQUIRE(std::is_same_v<smallest_int_t<-1, 128>, std::int16_t>);
+    REQUIRE(std::is_same_v<smallest_int_t<-129, 0>, std::int16_t>);
+    REQUIRE(std::is_same_v<smallest_int_t<-1, 32767>, std::int16_t>);
+    REQUIRE(std::is_same_v<smallest_int_t<-1, 32768>, std::int32_t>);
+    REQUIRE(std::is_same_v<smallest_int_t<-1, 2147483648LL>, std::int64_t>);
+}
@@ -0,0 +1,172 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include <maki/detail/typed_function_queue.hpp>
+#include "../common.hpp"
+#include <array>
+#include <string>
+
+namespace
+{
+    auto instance_count = 0;
+
+    struct small_struct
+    {
+        small_struct(const int i):
+            i(i)
+        {
+            ++instance_count;
+        }
+
+        small_struct(const small_struct& other):
+            i(other.i)
+        {
+            ++instance_count;
+        }
+
+        small_struct(small_struct&& other) noexcept:
+            i(other.i)
+        {
+            ++instance_count;
+        }
+
+        small_struct& operator=(const small_struct&) = delete;
+        small_struct& operator=(small_struct&&) = delete;
+
+        ~small_struct()
+        {
+            --instance_count;
+        }
+
+        int i = 0;
+    };
+
+    struct big_struct
+    {
+        std::array<int, 32> numbers;
+    };
+
+    struct append_small
+    {
+        static bool call(const small_struct& in, std::string& out)
+        {
+            out += "small" + std::to_string(in.i) + ";";
+            return true;
+        }
+    };
+
+    struct append_big
+    {
+        static bool call(const big_struct& in, std::string& out)
+        {
+            out += "big" + std::to_string(in.numbers[1]) + ";";
+            return false;
+        }
+    };
+
+    //Not part of the entry list
+    struct append_text
+    {
+        static bool call(const std::string& in, std::string& out)
+        {
+            out += in + ";";
+            return true;
+        }
+    };
+
+    using queue_t = maki::detail::typed_function_queue
+    <
+        std::string&,
+        maki::detail::type_list_t
+        <
+            maki::detail::typed_function_queue_entry<append_small, small_struct>,
+            maki::detail::typed_function_queue_entry<append_big, big_struct>
+        >
+    >;
+}
+
+TEST_CASE("detail::typed_function_queue")
+{
+    instance_count = 0;
+
+    {
+        auto queue = queue_t{};
+        auto out = std::string{};
+
+        //Push enough calls to make the buffer grow and wrap around
+        for(auto i = 0; i < 3; ++i)
+        {
+            queue.push<append_small>(small_struct{i});
+            queue.push<append_big>(big_struct{{0, i}});
+            queue.push<append_text>(std::string{"text"} + std::to_string(i));
+        }
+        REQUIRE(instance_count == 3);
+        REQUIRE(queue.size() == 9);
+
+        REQUIRE(queue.invoke_and_pop(out));
+        REQUIRE(!queue.invoke_and_pop(out));
+        REQUIRE(queue.invoke_and_pop(out));
+        REQUIRE(instance_count == 2);
+
+        queue.push<append_small>(small_struct{3});
+        queue.invoke_and_pop_all(out);
+        REQUIRE(queue.empty());
+        REQUIRE(instance_count == 0);
+
+        REQUIRE
+        (
+            out ==
+            "small0;big0;text0;"
+            "small1;big1;text1;"
+            "small2;big2;text2;"
+            "small3;"
+        );
+
+        //Leave some calls in the queue
+        queue.push<append_small>(small_struct{4});
+        queue.push<append_text>(std::string{"text"});
+        REQUIRE(instance_count == 1);
+    }
+
+    REQUIRE(instance_count == 0);
+}
+
+TEST_CASE("detail::typed_function_queue: remove_if")
+{
+    auto queue = queue_t{};
+    auto out = std::string{};
+
+    for(auto i = 0; i < 3; ++i)
+    {
+        queue.push<append_small>(small_struct{i});
+        queue.push<append_text>(std::string{"text"} + std::to_string(i));
+    }
+
+    //Entries of the entry list
+    const auto removed_small_count = queue.remove_if<append_small, maki::detail::type_list_t<small_struct>>
+    (
+        [](const small_struct& data)
+        {
+            return data.i != 1;
+        },
+        out
+    );
+    REQUIRE(removed_small_count == 2);
+
+    //Calls that aren't part of the entry list
+    const auto removed_text_count = queue.remove_if<append_text, maki::detail::type_list_t<std::string>>
+    (
+        [](const std::string& data)
+        {
+            return data == "text2";
+        },
+        out
+    );
+    REQUIRE(removed_text_count == 1);
+
+    queue.invoke_and_pop_all(out);
+    REQUIRE(out == "text0;small1;text1;");
+}
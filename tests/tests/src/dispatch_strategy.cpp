@@ -0,0 +1,228 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include <maki.hpp>
+#include "common.hpp"
+#include <string>
+
+namespace dispatch_strategy_ns
+{
+    struct context
+    {
+        std::string out;
+    };
+
+    namespace events
+    {
+        struct next{};
+        struct ping{};
+        struct reset{};
+    }
+
+    namespace states
+    {
+        constexpr auto s0 = maki::state_mold{}
+            .internal_action_c<events::ping>
+            (
+                [](context& ctx)
+                {
+                    ctx.out += "s0::ping;";
+                }
+            )
+        ;
+
+        constexpr auto s1 = maki::state_mold{}
+            .exit_action_c
+            (
+                [](context& ctx)
+                {
+                    ctx.out += "s1::exit;";
+                }
+            )
+        ;
+
+        constexpr auto s2_0 = maki::state_mold{}
+            .internal_action_c<events::ping>
+            (
+                [](context& ctx)
+                {
+                    ctx.out += "s2_0::ping;";
+                }
+            )
+            .exit_action_c
+            (
+                [](context& ctx)
+                {
+                    ctx.out += "s2_0::exit;";
+                }
+            )
+        ;
+
+        constexpr auto s2_1 = maki::state_mold{}
+            .internal_action_c<events::ping>
+            (
+                [](context& ctx)
+                {
+                    ctx.out += "s2_1::ping;";
+                }
+            )
+        ;
+
+        constexpr auto s2_transition_table = maki::transition_table{}
+            (maki::ini,    states::s2_0)
+            (states::s2_0, states::s2_1, maki::event<events::next>)
+            (states::s2_1, maki::fin,    maki::event<events::next>)
+        ;
+
+        constexpr auto s2 = maki::state_mold{}
+            .transition_tables(s2_transition_table)
+            .exit_action_c
+            (
+                [](context& ctx)
+                {
+                    ctx.out += "s2::exit;";
+                }
+            )
+        ;
+    }
+
+    constexpr auto transition_table = maki::transition_table{}
+        (maki::ini,  states::s0)
+        (states::s0, states::s1, maki::event<events::next>)
+        (states::s1, states::s2, maki::event<events::next>)
+        (states::s2, states::s0, maki::event<events::reset>)
+    ;
+
+    template<maki::dispatch_strategy Strategy>
+    constexpr auto machine_conf = maki::machine_conf{}
+        .transition_tables(transition_table)
+        .context_a<context>()
+        .dispatch_strategy(Strategy)
+    ;
+
+    template<maki::dispatch_strategy Strategy>
+    std::string run()
+    {
+        auto machine = maki::machine<machine_conf<Strategy>>{};
+        auto& ctx = machine.context();
+
+        machine.process_event(events::ping{});
+        machine.process_event(events::next{});
+        machine.process_event(events::ping{}); //Not processed by s1
+        machine.process_event(events::next{});
+        machine.process_event(events::ping{});
+        machine.process_event(events::next{});
+        machine.process_event(events::ping{});
+        machine.process_event(events::next{});
+        machine.process_event(events::ping{}); //Not processed by s2 (completed)
+        machine.process_event(events::reset{});
+        machine.process_event(events::ping{});
+
+        machine.process_event(events::next{});
+        machine.process_event(events::next{});
+        machine.stop();
+
+        return ctx.out;
+    }
+}
+
+TEST_CASE("dispatch_strategy")
+{
+    using namespace dispatch_strategy_ns;
+
+    const auto expected_output = std::string
+    {
+        "s0::ping;"
+        "s1::exit;"
+        "s2_0::ping;"
+        "s2_0::exit;"
+        "s2_1::ping;"
+        "s2::exit;"
+        "s0::ping;"
+        "s1::exit;"
+        "s2_0::exit;"
+        "s2::exit;"
+    };
+
+    REQUIRE(run<maki::dispatch_strategy::linear>() == expected_output);
+    REQUIRE(run<maki::dispatch_strategy::jump_table>() == expected_output);
+}
+
+namespace dispatch_strategy_transitions_ns
+{
+    struct context
+    {
+        bool allow_s2 = false;
+    };
+
+    struct event{};
+
+    namespace states
+    {
+        EMPTY_STATE(s0)
+        EMPTY_STATE(s1)
+        EMPTY_STATE(s2)
+        EMPTY_STATE(s3)
+    }
+
+    constexpr auto allow_s2 = maki::guard_c([](const context& ctx)
+    {
+        return ctx.allow_s2;
+    });
+
+    //Transitions are listed in an order that must be preserved
+    constexpr auto transition_table = maki::transition_table{}
+        (maki::ini,                       states::s0)
+        (states::s0,                      states::s1, maki::event<event>)
+        (states::s1,                      states::s2, maki::event<event>, maki::null, allow_s2)
+        (states::s1 || states::s2,        states::s3, maki::event<event>)
+        (maki::all_states,                states::s0, maki::event<event>)
+    ;
+
+    template<maki::dispatch_strategy Strategy>
+    constexpr auto machine_conf = maki::machine_conf{}
+        .transition_tables(transition_table)
+        .context_a<context>()
+        .dispatch_strategy(Strategy)
+    ;
+
+    template<maki::dispatch_strategy Strategy>
+    void run()
+    {
+        auto machine = maki::machine<machine_conf<Strategy>>{};
+        auto& ctx = machine.context();
+
+        REQUIRE(machine.template is<states::s0>());
+
+        machine.process_event(event{});
+        REQUIRE(machine.template is<states::s1>());
+
+        machine.process_event(event{});
+        REQUIRE(machine.template is<states::s3>());
+
+        machine.process_event(event{});
+        REQUIRE(machine.template is<states::s0>());
+
+        ctx.allow_s2 = true;
+        machine.process_event(event{});
+        machine.process_event(event{});
+        REQUIRE(machine.template is<states::s2>());
+
+        machine.process_event(event{});
+        REQUIRE(machine.template is<states::s3>());
+
+        machine.stop();
+        REQUIRE(!machine.check_event(event{}));
+    }
+}
+
+TEST_CASE("dispatch_strategy: transitions")
+{
+    using namespace dispatch_strategy_transitions_ns;
+
+    run<maki::dispatch_strategy::linear>();
+    run<maki::dispatch_strategy::jump_table>();
+}
@@ -0,0 +1,132 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include <maki.hpp>
+#include "common.hpp"
+#include <string>
+
+namespace event_priority_ns
+{
+    struct context
+    {
+        std::string out;
+    };
+
+    namespace events
+    {
+        struct burst{};
+        struct stop_burst{};
+
+        struct sample
+        {
+            int index = 0;
+        };
+
+        struct abort{};
+        struct resume{};
+    }
+
+    namespace states
+    {
+        constexpr auto working = maki::state_mold{}
+            .internal_action_m<events::burst>([](auto& mach)
+            {
+                mach.process_event(events::sample{0});
+                mach.process_event(events::sample{1});
+                mach.push_event(events::sample{2}, 1);
+                mach.process_event(events::abort{});
+                mach.process_event(events::sample{3});
+            })
+            .internal_action_m<events::stop_burst>([](auto& mach)
+            {
+                mach.process_event(events::sample{0});
+                mach.stop();
+                mach.process_event(events::sample{1});
+            })
+            .internal_action_ce<events::sample>([](context& ctx, const events::sample& event)
+            {
+                ctx.out += "sample" + std::to_string(event.index) + ";";
+            })
+            .exit_action_c([](context& ctx)
+            {
+                ctx.out += "working::exit;";
+            })
+        ;
+
+        constexpr auto aborted = maki::state_mold{}
+            .entry_action_c([](context& ctx)
+            {
+                ctx.out += "aborted::entry;";
+            })
+            .internal_action_ce<events::sample>([](context& ctx, const events::sample& event)
+            {
+                ctx.out += "ignored_sample" + std::to_string(event.index) + ";";
+            })
+        ;
+    }
+
+    constexpr auto transition_table = maki::transition_table{}
+        (maki::ini,       states::working)
+        (states::working, states::aborted, maki::event<events::abort>)
+        (states::aborted, states::working, maki::event<events::resume>)
+    ;
+
+    constexpr auto machine_conf = maki::machine_conf{}
+        .transition_tables(transition_table)
+        .context_a<context>()
+        .event_priority_count(3)
+        .event_priority<events::abort>(2)
+        .event_priority<maki::events::stop>(2)
+    ;
+
+    using machine_t = maki::machine<machine_conf>;
+}
+
+TEST_CASE("event_priority")
+{
+    using namespace event_priority_ns;
+
+    auto machine = machine_t{};
+    auto& ctx = machine.context();
+
+    //Higher priority first, FIFO within a priority
+    machine.process_event(events::burst{});
+    REQUIRE(machine.is<states::aborted>());
+    REQUIRE
+    (
+        ctx.out ==
+        "working::exit;"
+        "aborted::entry;"
+        "ignored_sample2;"
+        "ignored_sample0;"
+        "ignored_sample1;"
+        "ignored_sample3;"
+    );
+
+    //Stop requests are subject to priorities as well
+    machine.process_event(events::resume{});
+    ctx.out.clear();
+    machine.process_event(events::stop_burst{});
+    REQUIRE(!machine.running());
+    REQUIRE(ctx.out == "working::exit;");
+
+    //Events pushed from outside are processed on the next call
+    machine.start();
+    ctx.out.clear();
+    machine.push_event(events::sample{0});
+    machine.push_event(events::sample{1}, 1);
+    machine.push_event(events::abort{});
+    machine.process_event(events::sample{2});
+    REQUIRE
+    (
+        ctx.out ==
+        "sample2;"
+        "working::exit;"
+        "aborted::entry;"
+        "ignored_sample1;"
+        "ignored_sample0;"
+    );
+}
@@ -0,0 +1,88 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include <maki.hpp>
+#include "common.hpp"
+#include <string>
+
+namespace event_queue_capacity_ns
+{
+    struct context
+    {
+        std::string out;
+    };
+
+    namespace events
+    {
+        struct go{};
+        struct value
+        {
+            int i = 0;
+        };
+        struct flush{};
+    }
+
+    namespace states
+    {
+        constexpr auto idle = maki::state_mold{};
+
+        //Defers the events pushed by the transition from `idle`
+        constexpr auto busy = maki::state_mold{}
+            .defer<events::value>();
+
+        constexpr auto ready = maki::state_mold{}
+            .internal_action_ce<events::value>(
+                [](context& ctx, const events::value& event)
+                {
+                    ctx.out += std::to_string(event.i) + ";";
+                });
+    }
+
+    namespace actions
+    {
+        //Push more events than the capacity of the queues
+        constexpr auto emit_values = maki::action_m(
+            [](auto& mach)
+            {
+                for(auto i = 0; i < 10; ++i)
+                {
+                    mach.process_event(events::value{i});
+                }
+                mach.process_event(events::flush{});
+            });
+    }
+
+    constexpr auto transition_table = maki::transition_table{}
+        (maki::ini,     states::idle)
+        (states::idle,  states::busy,  maki::event<events::go>, actions::emit_values)
+        (states::busy,  states::ready, maki::event<events::flush>)
+        (states::ready, states::idle,  maki::event<events::flush>)
+    ;
+
+    constexpr auto machine_conf = maki::machine_conf{}
+        .transition_tables(transition_table)
+        .context_a<context>()
+        .event_queue_capacity(2)
+    ;
+
+    using machine_t = maki::machine<machine_conf>;
+}
+
+TEST_CASE("event_queue_capacity")
+{
+    using namespace event_queue_capacity_ns;
+
+    auto machine = machine_t{};
+
+    for(auto i = 0; i < 2; ++i)
+    {
+        machine.context().out.clear();
+        machine.process_event(events::go{});
+        machine.process_event(events::flush{});
+        REQUIRE(machine.is<states::idle>());
+        REQUIRE(machine.context().out == "0;1;2;3;4;5;6;7;8;9;");
+    }
+}
@@ -0,0 +1,181 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include <maki.hpp>
+#include "common.hpp"
+#include <string>
+#include <type_traits>
+
+namespace event_queue_max_size_ns
+{
+    struct context
+    {
+        std::string out;
+    };
+
+    namespace events
+    {
+        struct burst{};
+        struct unlock{};
+
+        struct job
+        {
+            int id = 0;
+        };
+
+        struct progress
+        {
+            int percent = 0;
+        };
+
+        struct request
+        {
+            int id = 0;
+        };
+    }
+
+    namespace states
+    {
+        constexpr auto locked = maki::state_mold{}
+            .defer<events::request>()
+        ;
+
+        constexpr auto unlocked = maki::state_mold{}
+            .internal_action_m<events::burst>([](auto& mach)
+            {
+                auto& ctx = mach.context();
+                for(auto i = 0; i != 4; ++i)
+                {
+                    if(mach.would_block())
+                    {
+                        ctx.out += "would_block;";
+                    }
+                    if(!mach.push_event(events::job{i}))
+                    {
+                        ctx.out += "rejected" + std::to_string(i) + ";";
+                    }
+                }
+            })
+            .internal_action_ce<events::job>([](context& ctx, const events::job& event)
+            {
+                ctx.out += "job" + std::to_string(event.id) + ";";
+            })
+            .internal_action_ce<events::progress>([](context& ctx, const events::progress& event)
+            {
+                ctx.out += "progress" + std::to_string(event.percent) + ";";
+            })
+            .internal_action_ce<events::request>([](context& ctx, const events::request& event)
+            {
+                ctx.out += "request" + std::to_string(event.id) + ";";
+            })
+        ;
+    }
+
+    constexpr auto transition_table = maki::transition_table{}
+        (maki::ini,        states::locked)
+        (states::locked,   states::unlocked, maki::event<events::unlock>)
+    ;
+
+    constexpr auto machine_conf = maki::machine_conf{}
+        .transition_tables(transition_table)
+        .context_a<context>()
+        .event_queue_max_size(2)
+    ;
+
+    using reject_machine_t = maki::machine<machine_conf>;
+
+    constexpr auto drop_oldest_machine_conf = machine_conf
+        .event_queue_overflow_policy(maki::overflow_policy::drop_oldest)
+        .coalesce<events::progress>(maki::coalescing_policy::keep_latest)
+    ;
+
+    using drop_oldest_machine_t = maki::machine<drop_oldest_machine_conf>;
+
+    constexpr auto call_handler_machine_conf = machine_conf
+        .event_queue_overflow_handler([](auto& mach, const auto& event)
+        {
+            using event_type = std::decay_t<decltype(event)>;
+            if constexpr(std::is_same_v<event_type, events::job>)
+            {
+                mach.context().out += "overflow_job" + std::to_string(event.id) + ";";
+            }
+            else if constexpr(std::is_same_v<event_type, events::request>)
+            {
+                mach.context().out += "overflow_request" + std::to_string(event.id) + ";";
+            }
+        })
+    ;
+
+    using call_handler_machine_t = maki::machine<call_handler_machine_conf>;
+}
+
+TEST_CASE("event_queue_max_size")
+{
+    using namespace event_queue_max_size_ns;
+
+    SECTION("reject")
+    {
+        auto machine = reject_machine_t{};
+        auto& ctx = machine.context();
+
+        //Bounded event deferral queue
+        machine.process_event(events::request{0});
+        machine.process_event(events::request{1});
+        machine.process_event(events::request{2});
+        machine.process_event(events::unlock{});
+        REQUIRE(ctx.out == "request0;request1;");
+
+        //Bounded run-to-completion queue
+        ctx.out.clear();
+        REQUIRE(!machine.would_block());
+        machine.process_event(events::burst{});
+        REQUIRE(ctx.out == "would_block;rejected2;would_block;rejected3;job0;job1;");
+        REQUIRE(!machine.would_block());
+    }
+
+    SECTION("drop_oldest")
+    {
+        auto machine = drop_oldest_machine_t{};
+        auto& ctx = machine.context();
+
+        machine.process_event(events::request{0});
+        machine.process_event(events::request{1});
+        machine.process_event(events::request{2});
+        machine.process_event(events::unlock{});
+        REQUIRE(ctx.out == "request1;request2;");
+
+        ctx.out.clear();
+        machine.process_event(events::burst{});
+        REQUIRE(ctx.out == "would_block;would_block;job2;job3;");
+
+        //A dropped coalesced event doesn't absorb the next events of its type
+        ctx.out.clear();
+        REQUIRE(machine.push_event(events::progress{10}));
+        REQUIRE(machine.push_event(events::job{0}));
+        REQUIRE(machine.push_event(events::job{1}));
+        REQUIRE(machine.push_event(events::progress{20}));
+        REQUIRE(machine.push_event(events::progress{30}));
+        machine.process_event(events::job{2});
+        REQUIRE(ctx.out == "job2;job1;progress30;");
+    }
+
+    SECTION("call_handler")
+    {
+        auto machine = call_handler_machine_t{};
+        auto& ctx = machine.context();
+
+        machine.process_event(events::request{0});
+        machine.process_event(events::request{1});
+        machine.process_event(events::request{2});
+        REQUIRE(ctx.out == "overflow_request2;");
+        machine.process_event(events::unlock{});
+        REQUIRE(ctx.out == "overflow_request2;request0;request1;");
+
+        ctx.out.clear();
+        machine.process_event(events::burst{});
+        REQUIRE(ctx.out == "would_block;overflow_job2;rejected2;would_block;overflow_job3;rejected3;job0;job1;");
+    }
+}
@@ -0,0 +1,223 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include <maki.hpp>
+#include "common.hpp"
+#include <stdexcept>
+#include <string>
+
+namespace flattened_dispatch_ns
+{
+    struct context
+    {
+        int always_zero = 0;
+        std::string out;
+    };
+
+    struct link_context
+    {
+        context& parent;
+        std::string& out = parent.out;
+    };
+
+    namespace events
+    {
+        struct ping{};
+        struct tick{};
+        struct next{};
+        struct boom{};
+        struct go_parallel{};
+        struct reset{};
+    }
+
+#define LEAF_STATE(name) \
+    constexpr auto name = maki::state_mold{} \
+        .internal_action_c<events::ping> \
+        ( \
+            [](auto& ctx) \
+            { \
+                ctx.out += #name "::ping;"; \
+            } \
+        ) \
+        .entry_action_c \
+        ( \
+            [](auto& ctx) \
+            { \
+                ctx.out += #name "::entry;"; \
+            } \
+        ) \
+        .exit_action_c \
+        ( \
+            [](auto& ctx) \
+            { \
+                ctx.out += #name "::exit;"; \
+            } \
+        ) \
+    ;
+
+    namespace states
+    {
+        LEAF_STATE(idle)
+        LEAF_STATE(l0)
+        LEAF_STATE(l1)
+        LEAF_STATE(p0)
+        LEAF_STATE(p1)
+
+        constexpr auto throw_action = maki::action_c([](link_context& ctx)
+        {
+            if(ctx.parent.always_zero == 0) //We need this to avoid "unreachable code" warnings
+            {
+                throw std::runtime_error{"boom"};
+            }
+        });
+
+        constexpr auto link = maki::state_mold{}
+            .context_c<link_context>()
+            .transition_tables
+            (
+                maki::transition_table{}
+                    (maki::ini, l0)
+                    (l0,        l1,        maki::event<events::next>)
+                    (l0,        l1,        maki::event<events::boom>, throw_action)
+                    (l1,        maki::fin, maki::event<events::next>)
+            )
+        ;
+
+        //Has its own internal action for `tick`, which must be called before
+        //the ones of the substates.
+        constexpr auto proto = maki::state_mold{}
+            .transition_tables
+            (
+                maki::transition_table{}
+                    (maki::ini, link)
+                    (link,      maki::fin)
+            )
+            .internal_action_c<events::tick>
+            (
+                [](context& ctx)
+                {
+                    ctx.out += "proto::tick;";
+                }
+            )
+        ;
+
+        constexpr auto parallel = maki::state_mold{}
+            .transition_tables
+            (
+                maki::transition_table{}
+                    (maki::ini, p0),
+                maki::transition_table{}
+                    (maki::ini, p1)
+            )
+        ;
+    }
+
+#undef LEAF_STATE
+
+    constexpr auto transition_table = maki::transition_table{}
+        (maki::ini,         states::idle)
+        (states::idle,      states::proto,    maki::event<events::next>)
+        (states::proto,     states::idle)
+        (states::idle,      states::parallel, maki::event<events::go_parallel>)
+        (maki::all_states,  states::idle,     maki::event<events::reset>)
+    ;
+
+    template<bool Flattened, maki::dispatch_strategy Strategy>
+    constexpr auto machine_conf = maki::machine_conf{}
+        .transition_tables(transition_table)
+        .context_a<context>()
+        .flattened_dispatch(Flattened)
+        .dispatch_strategy(Strategy)
+        .catch_mx
+        (
+            [](auto& mach, const std::exception_ptr& /*eptr*/)
+            {
+                mach.context().out += "on_exception;";
+            }
+        )
+    ;
+
+    template<bool Flattened, maki::dispatch_strategy Strategy = maki::dispatch_strategy::linear>
+    std::string run()
+    {
+        auto machine = maki::machine<machine_conf<Flattened, Strategy>>{};
+        auto& ctx = machine.context();
+
+        machine.process_event(events::ping{});
+        machine.process_event(events::next{}); //idle -> proto/link/l0
+        machine.process_event(events::ping{});
+        machine.process_event(events::tick{});
+        machine.process_event(events::next{}); //l0 -> l1
+        machine.process_event(events::ping{});
+        machine.process_event(events::next{}); //l1 -> fin, then proto -> idle
+        machine.process_event(events::ping{});
+        machine.process_event(events::next{}); //idle -> proto/link/l0
+        machine.process_event(events::boom{}); //l0 -> undefined
+        machine.process_event(events::ping{});
+        machine.process_event(events::tick{});
+        machine.process_event(events::reset{}); //proto -> idle
+        machine.process_event(events::go_parallel{});
+        machine.process_event(events::ping{});
+        machine.process_event(events::reset{});
+        machine.process_event(events::ping{});
+        machine.stop();
+        machine.process_event(events::ping{});
+        machine.start();
+        machine.process_event(events::ping{});
+
+        return ctx.out;
+    }
+}
+
+TEST_CASE("flattened_dispatch")
+{
+    using namespace flattened_dispatch_ns;
+
+    const auto expected_output = std::string
+    {
+        "idle::entry;"
+        "idle::ping;"
+
+        "idle::exit;"
+        "l0::entry;"
+        "l0::ping;"
+        "proto::tick;"
+
+        "l0::exit;"
+        "l1::entry;"
+        "l1::ping;"
+
+        "l1::exit;"
+        "idle::entry;"
+        "idle::ping;"
+
+        "idle::exit;"
+        "l0::entry;"
+        "l0::exit;"
+        "on_exception;"
+        "proto::tick;"
+
+        "idle::entry;"
+        "idle::exit;"
+        "p0::entry;"
+        "p1::entry;"
+        "p0::ping;"
+        "p1::ping;"
+        "p0::exit;"
+        "p1::exit;"
+        "idle::entry;"
+        "idle::ping;"
+
+        "idle::exit;"
+
+        "idle::entry;"
+        "idle::ping;"
+    };
+
+    REQUIRE(run<false>() == expected_output);
+    REQUIRE(run<true>() == expected_output);
+    REQUIRE(run<true, maki::dispatch_strategy::jump_table>() == expected_output);
+}
@@ -36,6 +36,7 @@ namespace is_active_state_set_ns
 
         constexpr auto not_emitting_red = !emitting_red;
         constexpr auto emitting_red_or_green = emitting_red || emitting_green;
+        constexpr auto emitting_red_or_blue = emitting_red || emitting_blue;
 
         constexpr auto on_transition_table = maki::transition_table{}
             (maki::ini,              states::emitting_red)
@@ -78,16 +79,19 @@ TEST_CASE("is_active_state_set")
     REQUIRE(!machine.is<states::emitting_red_or_green>());
     REQUIRE(on_state.is<states::emitting_red>());
     REQUIRE(on_state.is<states::emitting_red_or_green>());
+    REQUIRE(on_state.is<states::emitting_red_or_blue>());
     REQUIRE(!on_state.is<states::not_emitting_red>());
 
     machine.process_event(events::color_button_press{});
     REQUIRE(on_state.is<states::emitting_green>());
     REQUIRE(on_state.is<states::emitting_red_or_green>());
+    REQUIRE(!on_state.is<states::emitting_red_or_blue>());
     REQUIRE(on_state.is<states::not_emitting_red>());
 
     machine.process_event(events::color_button_press{});
     REQUIRE(on_state.is<states::emitting_blue>());
     REQUIRE(!on_state.is<states::emitting_red_or_green>());
+    REQUIRE(on_state.is<states::emitting_red_or_blue>());
     REQUIRE(on_state.is<states::not_emitting_red>());
 
     machine.process_event(events::power_button_press{});
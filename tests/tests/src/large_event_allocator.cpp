@@ -0,0 +1,129 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include <maki.hpp>
+#include "common.hpp"
+#include <array>
+#include <new>
+#include <string>
+#include <cstddef>
+
+namespace large_event_allocator_ns
+{
+    auto allocation_count = 0;
+    auto deallocation_count = 0;
+
+    struct counting_allocator
+    {
+        [[nodiscard]] void* allocate(const std::size_t size, const std::size_t alignment) const
+        {
+            ++allocation_count;
+            return ::operator new(size, std::align_val_t{alignment});
+        }
+
+        void deallocate(void* const ptr, const std::size_t /*size*/, const std::size_t alignment) const
+        {
+            ++deallocation_count;
+            ::operator delete(ptr, std::align_val_t{alignment});
+        }
+    };
+
+    struct context
+    {
+        std::string out;
+    };
+
+    namespace events
+    {
+        struct go{};
+
+        //Too large for the small object optimization
+        struct telemetry
+        {
+            std::array<int, 16> values;
+        };
+    }
+
+    namespace states
+    {
+        constexpr auto idle = maki::state_mold{};
+
+        constexpr auto running = maki::state_mold{}
+            .internal_action_ce<events::telemetry>(
+                [](context& ctx, const events::telemetry& event)
+                {
+                    ctx.out += std::to_string(event.values[0]) + ";";
+                });
+    }
+
+    namespace actions
+    {
+        constexpr auto post_telemetry = maki::action_m(
+            [](auto& mach)
+            {
+                for(auto i = 0; i < 4; ++i)
+                {
+                    mach.process_event(events::telemetry{{i}});
+                }
+            });
+    }
+
+    constexpr auto transition_table = maki::transition_table{}
+        (maki::ini,       states::idle)
+        (states::idle,    states::running, maki::event<events::go>, actions::post_telemetry)
+        (states::running, states::idle,    maki::event<events::go>)
+    ;
+
+    template<std::size_t ArenaSize>
+    constexpr auto machine_conf = maki::machine_conf{}
+        .transition_tables(transition_table)
+        .context_a<context>()
+        .large_event_allocator(counting_allocator{})
+        .large_event_arena_size(ArenaSize)
+    ;
+
+    template<std::size_t ArenaSize>
+    void run()
+    {
+        allocation_count = 0;
+        deallocation_count = 0;
+
+        {
+            auto machine = maki::machine<machine_conf<ArenaSize>>{};
+
+            for(auto i = 0; i < 3; ++i)
+            {
+                machine.context().out.clear();
+                machine.process_event(events::go{});
+                machine.process_event(events::go{});
+                REQUIRE(machine.context().out == "0;1;2;3;");
+            }
+
+            if constexpr(ArenaSize == 0)
+            {
+                //Every posted event is allocated and deallocated
+                REQUIRE(allocation_count == 12);
+                REQUIRE(deallocation_count == 12);
+            }
+            else
+            {
+                //The arena is allocated once and reclaimed after each drain
+                REQUIRE(allocation_count == 1);
+                REQUIRE(deallocation_count == 0);
+            }
+        }
+
+        REQUIRE(allocation_count == deallocation_count);
+    }
+}
+
+TEST_CASE("large_event_allocator")
+{
+    using namespace large_event_allocator_ns;
+
+    run<0>();
+    run<1024>();
+}
@@ -0,0 +1,119 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include <maki.hpp>
+#include "common.hpp"
+#include <algorithm>
+#include <chrono>
+#include <string_view>
+#include <thread>
+
+namespace latency_profiling_ns
+{
+    struct context{};
+
+    void wait_ms(const int duration)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds{duration});
+    }
+
+    namespace events
+    {
+        struct next{};
+        struct ping{};
+    }
+
+    namespace states
+    {
+        constexpr auto idle = maki::state_mold{}
+            .pretty_name("idle")
+            .exit_action_v([]
+            {
+                wait_ms(1);
+            })
+            .internal_action_v<events::ping>([]{})
+        ;
+
+        constexpr auto busy = maki::state_mold{}
+            .pretty_name("busy")
+            .entry_action_v([]
+            {
+                wait_ms(6);
+            })
+        ;
+    }
+
+    constexpr auto slow_guard = maki::guard_v([]
+    {
+        wait_ms(3);
+        return true;
+    });
+
+    constexpr auto transition_table = maki::transition_table{}
+        (maki::ini,    states::idle)
+        (states::idle, states::busy, maki::event<events::next>, maki::null, slow_guard)
+        (states::busy, states::idle, maki::event<events::next>)
+    ;
+
+    constexpr auto machine_conf = maki::machine_conf{}
+        .transition_tables(transition_table)
+        .context_a<context>()
+        .latency_profiling(true)
+    ;
+
+    using machine_t = maki::machine<machine_conf>;
+}
+
+TEST_CASE("latency_profiling")
+{
+    using namespace latency_profiling_ns;
+
+    auto machine = machine_t{};
+    machine.process_event(events::ping{});
+    machine.process_event(events::next{});
+
+    const auto offenders = machine.top_latency_offenders(3);
+    REQUIRE(offenders.size() == 3);
+
+    //The offenders are sorted by total duration. Given the sleep durations,
+    //the order is most likely entry action, guard, exit action, but a
+    //preempted thread can oversleep, so we don't rely on it.
+    REQUIRE(offenders[0].histogram.total_duration >= offenders[1].histogram.total_duration);
+    REQUIRE(offenders[1].histogram.total_duration >= offenders[2].histogram.total_duration);
+
+    const auto find_offender = [&](const std::string_view site) -> const maki::latency_profile_entry&
+    {
+        const auto it = std::find_if
+        (
+            offenders.begin(),
+            offenders.end(),
+            [&](const maki::latency_profile_entry& offender)
+            {
+                return offender.site == site;
+            }
+        );
+        REQUIRE(it != offenders.end());
+        return *it;
+    };
+
+    const auto& entry_action = find_offender("entry action of 0: busy");
+    REQUIRE(entry_action.histogram.count == 1);
+    REQUIRE(entry_action.histogram.total_duration >= std::chrono::milliseconds{6});
+    REQUIRE(entry_action.histogram.max_duration == entry_action.histogram.total_duration);
+    REQUIRE(entry_action.histogram.percentile(0.99) == entry_action.histogram.max_duration);
+
+    const auto& guard = find_offender("guard of 0: idle -> busy");
+    REQUIRE(guard.histogram.total_duration >= std::chrono::milliseconds{3});
+
+    const auto& exit_action = find_offender("exit action of 0: idle");
+    REQUIRE(exit_action.histogram.total_duration >= std::chrono::milliseconds{1});
+
+    machine.process_event(events::next{});
+    REQUIRE(machine.top_latency_offenders(10).size() == 5);
+
+    machine.reset_latency_profile();
+    REQUIRE(machine.top_latency_offenders(10).empty());
+}
@@ -0,0 +1,130 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include <maki.hpp>
+#include "common.hpp"
+#include <chrono>
+#include <string>
+#include <thread>
+
+namespace metrics_ns
+{
+    struct context{};
+
+    namespace events
+    {
+        struct power_button_press{};
+        struct next{};
+        struct ignored{};
+    }
+
+    namespace states
+    {
+        constexpr auto off = maki::state_mold{}
+            .pretty_name("off")
+        ;
+
+        constexpr auto red = maki::state_mold{}
+            .pretty_name("red")
+        ;
+
+        constexpr auto green = maki::state_mold{}
+            .pretty_name("green")
+        ;
+
+        constexpr auto on_transition_table = maki::transition_table{}
+            (maki::ini, red)
+            (red,       green, maki::event<events::next>)
+            (green,     red,   maki::event<events::next>)
+        ;
+
+        constexpr auto on = maki::state_mold{}
+            .transition_tables(on_transition_table)
+            .pretty_name("on")
+        ;
+    }
+
+    constexpr auto transition_table = maki::transition_table{}
+        (maki::ini,   states::off)
+        (states::off, states::on,  maki::event<events::power_button_press>)
+        (states::on,  states::off, maki::event<events::power_button_press>)
+    ;
+
+    constexpr auto machine_conf = maki::machine_conf{}
+        .transition_tables(transition_table)
+        .context_a<context>()
+        .metrics(true)
+    ;
+
+    using machine_t = maki::machine<machine_conf>;
+
+    bool contains(const std::string& str, const std::string& substr)
+    {
+        return str.find(substr) != std::string::npos;
+    }
+}
+
+TEST_CASE("metrics")
+{
+    using namespace metrics_ns;
+
+    auto machine = machine_t{};
+
+    machine.process_event(events::power_button_press{});
+    machine.process_event(events::next{});
+    machine.process_event(events::next{});
+    machine.process_event(events::ignored{});
+    std::this_thread::sleep_for(std::chrono::milliseconds{2});
+    machine.process_event(events::power_button_press{});
+    machine.process_event(events::next{});
+
+    REQUIRE(machine.state_entry_count<states::off>() == 2);
+    REQUIRE(machine.state_entry_count<states::on>() == 1);
+    REQUIRE(machine.state_entry_count<states::red>() == 2);
+    REQUIRE(machine.state_entry_count<states::green>() == 1);
+    REQUIRE(machine.transition_count<states::off, states::on>() == 1);
+    REQUIRE(machine.transition_count<states::red, states::green>() == 1);
+    REQUIRE(machine.transition_count<states::green, states::red>() == 1);
+    REQUIRE(machine.unhandled_event_count() == 2);
+    REQUIRE(machine.state_dwell_time<states::on>() >= std::chrono::milliseconds{2});
+    REQUIRE(machine.state_dwell_time<states::red>() >= std::chrono::milliseconds{2});
+
+    auto other_machine = machine_t{};
+
+    auto registry = maki::metrics_registry{};
+    registry
+        .add_machine(machine, "machine1")
+        .add_machine(other_machine, "machine\"2\"")
+    ;
+    const auto text = registry.to_openmetrics();
+
+    REQUIRE(contains(text, "# TYPE maki_state_entries counter\n"));
+    REQUIRE(contains(text, "maki_state_entries_total{machine=\"machine1\",region=\"0\",state=\"off\"} 2\n"));
+    REQUIRE(contains(text, "maki_state_entries_total{machine=\"machine1\",region=\"0/on/0\",state=\"red\"} 2\n"));
+    REQUIRE(contains(text, "maki_state_entries_total{machine=\"machine\\\"2\\\"\",region=\"0\",state=\"off\"} 1\n"));
+    REQUIRE(contains(text, "maki_state_dwell_seconds_total{machine=\"machine1\",region=\"0\",state=\"on\"} "));
+    REQUIRE(contains(text, "maki_transitions_total{machine=\"machine1\",region=\"0\",source=\"null\",target=\"off\"} 1\n"));
+    REQUIRE(contains(text, "maki_transitions_total{machine=\"machine1\",region=\"0/on/0\",source=\"red\",target=\"null\"} 1\n"));
+    REQUIRE(contains(text, "maki_unhandled_events_total{machine=\"machine1\"} 2\n"));
+    REQUIRE(text.size() >= 6);
+    REQUIRE(text.substr(text.size() - 6) == "# EOF\n");
+
+    registry.remove_machine(other_machine);
+    REQUIRE(!contains(registry.to_openmetrics(), "machine\\\"2\\\""));
+
+    machine.reset_metrics();
+    REQUIRE(machine.state_entry_count<states::off>() == 0);
+    REQUIRE(machine.transition_count<states::off, states::on>() == 0);
+    REQUIRE(machine.unhandled_event_count() == 0);
+
+    machine.process_event(events::power_button_press{});
+    machine.process_event(events::power_button_press{});
+    REQUIRE(machine.state_entry_count<states::off>() == 1);
+    REQUIRE(machine.transition_count<states::on, states::off>() == 1);
+
+    machine.stop();
+    REQUIRE(machine.transition_count<states::off, maki::fin>() == 1);
+}
@@ -0,0 +1,113 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include <maki.hpp>
+#include "common.hpp"
+#include <chrono>
+#include <string>
+
+namespace operation_budget_ns
+{
+    struct context
+    {
+        std::string out;
+    };
+
+    namespace events
+    {
+        struct burst{};
+        struct unlock{};
+
+        struct job
+        {
+            int id = 0;
+        };
+
+        struct request
+        {
+            int id = 0;
+        };
+    }
+
+    namespace states
+    {
+        constexpr auto locked = maki::state_mold{}
+            .defer<events::request>()
+        ;
+
+        constexpr auto unlocked = maki::state_mold{}
+            .internal_action_m<events::burst>([](auto& mach)
+            {
+                mach.context().out += "burst;";
+                for(auto i = 0; i != 5; ++i)
+                {
+                    mach.process_event(events::job{i});
+                }
+            })
+            .internal_action_ce<events::job>([](context& ctx, const events::job& event)
+            {
+                ctx.out += "job" + std::to_string(event.id) + ";";
+            })
+            .internal_action_ce<events::request>([](context& ctx, const events::request& event)
+            {
+                ctx.out += "request" + std::to_string(event.id) + ";";
+            })
+        ;
+    }
+
+    constexpr auto transition_table = maki::transition_table{}
+        (maki::ini,        states::locked)
+        (states::locked,   states::unlocked, maki::event<events::unlock>)
+    ;
+
+    constexpr auto machine_conf = maki::machine_conf{}
+        .transition_tables(transition_table)
+        .context_a<context>()
+        .operation_budget(2)
+    ;
+
+    using machine_t = maki::machine<machine_conf>;
+}
+
+TEST_CASE("operation_budget")
+{
+    using namespace operation_budget_ns;
+
+    auto machine = machine_t{};
+    auto& ctx = machine.context();
+
+    //Deferred events
+    machine.process_event(events::request{0});
+    machine.process_event(events::request{1});
+    machine.process_event(events::request{2});
+    REQUIRE(!machine.has_pending_operations());
+    machine.process_event(events::unlock{});
+    REQUIRE(ctx.out == "request0;request1;");
+    REQUIRE(machine.has_pending_operations());
+    REQUIRE(machine.process_pending(1));
+    REQUIRE(ctx.out == "request0;request1;request2;");
+
+    //Queued events
+    ctx.out.clear();
+    machine.process_event(events::burst{});
+    REQUIRE(ctx.out == "burst;job0;job1;");
+
+    //New events are queued behind the pending ones
+    ctx.out.clear();
+    machine.process_event(events::job{9});
+    REQUIRE(ctx.out == "job2;job3;");
+
+    ctx.out.clear();
+    REQUIRE(!machine.process_pending(1));
+    REQUIRE(ctx.out == "job4;");
+
+    ctx.out.clear();
+    REQUIRE(!machine.process_pending_until(std::chrono::steady_clock::now() - std::chrono::seconds{1}));
+    REQUIRE(ctx.out.empty());
+    REQUIRE(machine.process_pending_until(std::chrono::steady_clock::now() + std::chrono::hours{1}));
+    REQUIRE(ctx.out == "job9;");
+    REQUIRE(!machine.has_pending_operations());
+}
@@ -0,0 +1,185 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include <maki.hpp>
+#include "common.hpp"
+#include <array>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace post_event_ns
+{
+    constexpr auto producer_count = 4;
+    constexpr auto event_count_per_producer = 1000;
+
+    struct context
+    {
+        std::array<int, producer_count> last_values = {-1, -1, -1, -1};
+        int processed_count = 0;
+        bool ordered = true;
+        std::string out;
+    };
+
+    namespace events
+    {
+        struct value
+        {
+            int producer = 0;
+            int i = 0;
+        };
+
+        struct text
+        {
+            std::string str;
+        };
+    }
+
+    namespace states
+    {
+        constexpr auto on = maki::state_mold{}
+            .internal_action_ce<events::value>(
+                [](context& ctx, const events::value& event)
+                {
+                    //Events of a given producer must be processed in order
+                    auto& last_value = ctx.last_values[static_cast<std::size_t>(event.producer)];
+                    if(event.i != last_value + 1)
+                    {
+                        ctx.ordered = false;
+                    }
+                    last_value = event.i;
+                    ++ctx.processed_count;
+                })
+            .internal_action_cme<events::text>(
+                [](context& ctx, auto& mach, const events::text& event)
+                {
+                    ctx.out += event.str + ";";
+
+                    //Recursive call
+                    if(event.str == "a")
+                    {
+                        mach.process_event(events::text{"b"});
+                    }
+                });
+    }
+
+    constexpr auto transition_table = maki::transition_table{}
+        (maki::ini, states::on)
+    ;
+
+    constexpr auto machine_conf = maki::machine_conf{}
+        .transition_tables(transition_table)
+        .context_a<context>()
+        .post_event_enabled(true)
+        .post_event_capacity(64)
+        .small_event_max_size(64)
+    ;
+
+    using machine_t = maki::machine<machine_conf>;
+}
+
+TEST_CASE("post_event")
+{
+    using namespace post_event_ns;
+
+    auto machine = machine_t{};
+    auto& ctx = machine.context();
+
+    SECTION("single thread")
+    {
+        auto callback_count = 0;
+
+        REQUIRE(machine.post_event(events::text{"a"}));
+        REQUIRE
+        (
+            machine.post_event
+            (
+                events::text{"c"},
+                [&]
+                {
+                    ctx.out += "callback;";
+                    ++callback_count;
+                }
+            )
+        );
+        REQUIRE(ctx.out.empty());
+
+        REQUIRE(machine.process_posted_events() == 2);
+        REQUIRE(ctx.out == "a;b;c;callback;");
+        REQUIRE(callback_count == 1);
+
+        REQUIRE(machine.process_posted_events() == 0);
+    }
+
+    SECTION("full inbox")
+    {
+        for(auto i = 0; i < 64; ++i)
+        {
+            REQUIRE(machine.post_event(events::value{0, i}));
+        }
+        REQUIRE(!machine.post_event(events::value{0, 64}));
+
+        REQUIRE(machine.process_posted_events() == 64);
+        REQUIRE(ctx.processed_count == 64);
+
+        //The slots are reused
+        REQUIRE(machine.post_event(events::value{0, 64}));
+        REQUIRE(machine.process_posted_events() == 1);
+        REQUIRE(ctx.processed_count == 65);
+        REQUIRE(ctx.ordered);
+    }
+
+    SECTION("multiple producers")
+    {
+        auto done_count = std::atomic<int>{0};
+
+        auto producers = std::vector<std::thread>{};
+        for(auto producer = 0; producer < producer_count; ++producer)
+        {
+            producers.emplace_back
+            (
+                [&machine, &done_count, producer]
+                {
+                    for(auto i = 0; i < event_count_per_producer; ++i)
+                    {
+                        while(!machine.post_event(events::value{producer, i}))
+                        {
+                            std::this_thread::yield();
+                        }
+                    }
+                    while
+                    (
+                        !machine.post_event
+                        (
+                            events::value{producer, event_count_per_producer},
+                            [&done_count]
+                            {
+                                ++done_count;
+                            }
+                        )
+                    )
+                    {
+                        std::this_thread::yield();
+                    }
+                }
+            );
+        }
+
+        while(done_count.load() != producer_count)
+        {
+            machine.process_posted_events();
+        }
+
+        for(auto& producer: producers)
+        {
+            producer.join();
+        }
+
+        REQUIRE(ctx.processed_count == producer_count * (event_count_per_producer + 1));
+        REQUIRE(ctx.ordered);
+    }
+}
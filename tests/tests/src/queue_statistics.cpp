@@ -0,0 +1,122 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include <maki.hpp>
+#include "common.hpp"
+#include <chrono>
+#include <thread>
+
+namespace queue_statistics_ns
+{
+    struct context
+    {
+        int handled_request_count = 0;
+    };
+
+    namespace events
+    {
+        struct begin{};
+        struct end{};
+        struct ping{};
+        struct request{};
+        struct big_ping
+        {
+            char payload[64] = {};
+        };
+    }
+
+    namespace states
+    {
+        constexpr auto idle = maki::state_mold{}
+            .internal_action_c<events::request>([](context& ctx)
+            {
+                ++ctx.handled_request_count;
+            })
+        ;
+
+        constexpr auto busy = maki::state_mold{}
+            .defer<events::request>()
+        ;
+    }
+
+    constexpr auto emit_pings = maki::action_m
+    (
+        [](auto& mach)
+        {
+            mach.process_event(events::ping{});
+            mach.process_event(events::ping{});
+            mach.process_event(events::ping{});
+            mach.process_event(events::big_ping{});
+        }
+    );
+
+    constexpr auto transition_table = maki::transition_table{}
+        (maki::ini,     states::idle)
+        (states::idle,  states::busy, maki::event<events::begin>, emit_pings)
+        (states::busy,  states::idle, maki::event<events::end>)
+    ;
+
+    constexpr auto machine_conf = maki::machine_conf{}
+        .transition_tables(transition_table)
+        .context_a<context>()
+        .queue_statistics(true)
+    ;
+
+    using machine_t = maki::machine<machine_conf>;
+}
+
+TEST_CASE("queue_statistics")
+{
+    using namespace queue_statistics_ns;
+
+    auto machine = machine_t{};
+
+    REQUIRE(machine.rtc_queue_depth() == 0);
+    REQUIRE(machine.rtc_queue_high_water_mark() == 0);
+
+    //Queue 3 pings and a big ping from an action
+    machine.process_event(events::begin{});
+    REQUIRE(machine.rtc_queue_depth() == 0);
+    REQUIRE(machine.rtc_queue_high_water_mark() == 4);
+    REQUIRE(machine.rtc_queue_latency<events::ping>().count == 3);
+    REQUIRE(machine.rtc_queue_latency<events::big_ping>().count == 1);
+    REQUIRE(machine.rtc_queue_latency<events::request>().count == 0);
+    REQUIRE(machine.large_event_allocation_count() == 1);
+
+    //Defer 3 requests
+    machine.process_event(events::request{});
+    machine.process_event(events::request{});
+    machine.process_event(events::request{});
+    REQUIRE(machine.event_deferral_queue_depth() == 3);
+    REQUIRE(machine.event_deferral_queue_high_water_mark() == 3);
+    REQUIRE(machine.deferral_retry_count() == 0);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds{2});
+
+    //Process the deferred requests
+    machine.process_event(events::end{});
+    REQUIRE(machine.context().handled_request_count == 3);
+    REQUIRE(machine.event_deferral_queue_depth() == 0);
+    REQUIRE(machine.event_deferral_queue_high_water_mark() == 3);
+    REQUIRE(machine.deferral_retry_count() == 3);
+    REQUIRE(machine.event_deferral_queue_latency<events::request>().count == 3);
+    REQUIRE(machine.event_deferral_queue_latency<events::request>().max_duration >= std::chrono::milliseconds{2});
+
+    //Cancel deferred requests
+    machine.process_event(events::begin{});
+    machine.process_event(events::request{});
+    machine.process_event(events::request{});
+    REQUIRE(machine.cancel_events<events::request>() == 2);
+    REQUIRE(machine.event_deferral_queue_depth() == 0);
+
+    machine.reset_queue_statistics();
+    REQUIRE(machine.rtc_queue_high_water_mark() == 0);
+    REQUIRE(machine.event_deferral_queue_high_water_mark() == 0);
+    REQUIRE(machine.deferral_retry_count() == 0);
+    REQUIRE(machine.large_event_allocation_count() == 0);
+    REQUIRE(machine.rtc_queue_latency<events::ping>().count == 0);
+    REQUIRE(machine.event_deferral_queue_latency<events::request>().count == 0);
+}
@@ -0,0 +1,224 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include <maki.hpp>
+#include "common.hpp"
+#include <array>
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace runtime_ns
+{
+    constexpr auto producer_count = 4;
+    constexpr auto machine_count = 32;
+    constexpr auto event_count_per_producer = 4000;
+
+    struct context
+    {
+        std::array<int, producer_count> last_values = {-1, -1, -1, -1};
+        std::atomic<bool> busy{false};
+        int processed_count = 0;
+        int forwarded_count = 0;
+        bool ordered = true;
+        bool concurrent = false;
+    };
+
+    namespace events
+    {
+        struct value
+        {
+            int producer = 0;
+            int i = 0;
+        };
+
+        struct forwarded{};
+
+        struct unpostable
+        {
+            unpostable() = default;
+
+            unpostable(const unpostable& /*other*/)
+            {
+                throw std::runtime_error{"copy"};
+            }
+
+            unpostable(unpostable&&) = delete;
+            unpostable& operator=(const unpostable&) = delete;
+            unpostable& operator=(unpostable&&) = delete;
+            ~unpostable() = default;
+        };
+    }
+
+    //Checks that a machine is never run by two workers at once
+    struct busy_guard
+    {
+        explicit busy_guard(context& ctx):
+            ctx(ctx)
+        {
+            if(ctx.busy.exchange(true))
+            {
+                ctx.concurrent = true;
+            }
+        }
+
+        busy_guard(const busy_guard&) = delete;
+        busy_guard(busy_guard&&) = delete;
+        busy_guard& operator=(const busy_guard&) = delete;
+        busy_guard& operator=(busy_guard&&) = delete;
+
+        ~busy_guard()
+        {
+            ctx.busy.store(false);
+        }
+
+        context& ctx;
+    };
+
+    namespace states
+    {
+        constexpr auto on = maki::state_mold{}
+            .internal_action_ce<events::value>(
+                [](context& ctx, const events::value& event)
+                {
+                    const auto grd = busy_guard{ctx};
+
+                    //Events of a given producer must be processed in order
+                    auto& last_value = ctx.last_values[static_cast<std::size_t>(event.producer)];
+                    if(event.i <= last_value)
+                    {
+                        ctx.ordered = false;
+                    }
+                    last_value = event.i;
+                    ++ctx.processed_count;
+                })
+            .internal_action_c<events::forwarded>(
+                [](context& ctx)
+                {
+                    const auto grd = busy_guard{ctx};
+                    ++ctx.forwarded_count;
+                });
+    }
+
+    constexpr auto transition_table = maki::transition_table{}
+        (maki::ini, states::on)
+    ;
+
+    constexpr auto machine_conf = maki::machine_conf{}
+        .transition_tables(transition_table)
+        .context_a<context>()
+        .post_event_enabled(true)
+    ;
+
+    using machine_t = maki::machine<machine_conf>;
+}
+
+TEST_CASE("runtime")
+{
+    using namespace runtime_ns;
+
+    auto rt = maki::runtime{3};
+    REQUIRE(rt.worker_count() == 3);
+
+    auto handles = std::vector<maki::runtime::handle<machine_t>>{};
+    for(auto i = 0; i < machine_count; ++i)
+    {
+        handles.push_back(rt.add_machine<machine_t>());
+    }
+
+    auto forwarded_count = std::atomic<int>{0};
+
+    auto producers = std::vector<std::thread>{};
+    for(auto producer = 0; producer < producer_count; ++producer)
+    {
+        producers.emplace_back
+        (
+            [&, producer]
+            {
+                for(auto i = 0; i < event_count_per_producer; ++i)
+                {
+                    const auto& hdl = handles[static_cast<std::size_t>((i * 7 + producer) % machine_count)];
+                    while(!hdl.post_event(events::value{producer, i}))
+                    {
+                        std::this_thread::yield();
+                    }
+
+                    if(i % 100 == 0)
+                    {
+                        while
+                        (
+                            !hdl.post_event
+                            (
+                                events::forwarded{},
+                                [&forwarded_count]
+                                {
+                                    ++forwarded_count;
+                                }
+                            )
+                        )
+                        {
+                            std::this_thread::yield();
+                        }
+                    }
+                }
+            }
+        );
+    }
+    for(auto& producer: producers)
+    {
+        producer.join();
+    }
+
+    rt.wait_idle();
+
+    auto processed_count = 0;
+    auto machine_forwarded_count = 0;
+    for(const auto& hdl: handles)
+    {
+        const auto& ctx = hdl.machine().context();
+        REQUIRE(ctx.ordered);
+        REQUIRE(!ctx.concurrent);
+        processed_count += ctx.processed_count;
+        machine_forwarded_count += ctx.forwarded_count;
+    }
+
+    REQUIRE(processed_count == producer_count * event_count_per_producer);
+    REQUIRE(machine_forwarded_count == producer_count * event_count_per_producer / 100);
+    REQUIRE(forwarded_count == machine_forwarded_count);
+}
+
+TEST_CASE("runtime: single worker")
+{
+    using namespace runtime_ns;
+
+    auto rt = maki::runtime{0};
+    REQUIRE(rt.worker_count() == 1);
+
+    const auto hdl = rt.add_machine<machine_t>();
+    for(auto i = 0; i < 10; ++i)
+    {
+        REQUIRE(hdl.post_event(events::value{0, i}));
+    }
+    rt.wait_idle();
+
+    REQUIRE(hdl.machine().context().processed_count == 10);
+    REQUIRE(hdl.machine().context().ordered);
+}
+
+TEST_CASE("runtime: throwing event copy")
+{
+    using namespace runtime_ns;
+
+    auto rt = maki::runtime{1};
+
+    const auto hdl = rt.add_machine<machine_t>();
+    REQUIRE_THROWS_AS(hdl.post_event(events::unpostable{}), std::runtime_error);
+    REQUIRE(hdl.post_event(events::value{0, 0}));
+    rt.wait_idle();
+
+    REQUIRE(hdl.machine().context().processed_count == 1);
+}
@@ -0,0 +1,195 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include <maki.hpp>
+#include "common.hpp"
+#include <optional>
+#include <string>
+
+namespace state_timeout_ns
+{
+    struct context
+    {
+        explicit context(maki::timer_service& tmrs):
+            timers(tmrs)
+        {
+        }
+
+        maki::timer_service& timers; //NOLINT(cppcoreguidelines-avoid-const-or-ref-data-members)
+        std::string out;
+    };
+
+    namespace events
+    {
+        struct connect{};
+        struct connection_success{};
+        struct heartbeat{};
+        struct disconnect{};
+
+        struct connection_timeout{};
+        struct connection_abandonment{};
+        struct heartbeat_loss{};
+
+        struct session_expiry
+        {
+            int code = 0;
+        };
+    }
+
+    namespace states
+    {
+        EMPTY_STATE(idle)
+
+        constexpr auto connecting = maki::state_mold{}
+            .timeout(10, events::connection_timeout{})
+            .timeout(30, events::connection_abandonment{})
+            .internal_action_c<events::connection_timeout>([](context& ctx)
+            {
+                ctx.out += "connection_timeout;";
+            })
+        ;
+
+        EMPTY_STATE(alive)
+
+        constexpr auto waiting_for_heartbeat = maki::state_mold{}
+            .timeout(5, events::heartbeat_loss{})
+        ;
+
+        constexpr auto session_transition_table = maki::transition_table{}
+            (maki::ini,                     waiting_for_heartbeat)
+            (waiting_for_heartbeat, waiting_for_heartbeat, maki::event<events::heartbeat>)
+            (waiting_for_heartbeat, alive,                 maki::event<events::heartbeat_loss>)
+        ;
+
+        constexpr auto session = maki::state_mold{}
+            .transition_tables(session_transition_table)
+            .timeout(100, events::session_expiry{42})
+        ;
+    }
+
+    namespace actions
+    {
+        constexpr auto on_session_expiry = maki::action_ce([](context& ctx, const events::session_expiry& event)
+        {
+            ctx.out += "session_expiry:" + std::to_string(event.code) + ";";
+        });
+    }
+
+    constexpr auto transition_table = maki::transition_table{}
+        (maki::ini,             states::idle)
+        (states::idle,          states::connecting, maki::event<events::connect>)
+        (states::connecting,    states::session,    maki::event<events::connection_success>)
+        (states::connecting,    states::idle,       maki::event<events::connection_abandonment>)
+        (states::session,       states::idle,       maki::event<events::disconnect>)
+        (states::session,       states::idle,       maki::event<events::session_expiry>, actions::on_session_expiry)
+    ;
+
+    constexpr auto machine_conf = maki::machine_conf{}
+        .transition_tables(transition_table)
+        .context_a<context>()
+        .timer_service([](auto& mach) -> maki::timer_service&
+        {
+            return mach.context().timers;
+        })
+    ;
+
+    using machine_t = maki::machine<machine_conf>;
+}
+
+TEST_CASE("state_timeout")
+{
+    using namespace state_timeout_ns;
+
+    auto timers = maki::timer_service{};
+    auto machine = machine_t{timers};
+    auto& ctx = machine.context();
+    const auto& session_state = machine.state<states::session>();
+
+    //Both timeouts are armed on entry
+    machine.process_event(events::connect{});
+    REQUIRE(machine.is<states::connecting>());
+    REQUIRE(timers.armed_count() == 2);
+
+    timers.advance(9);
+    REQUIRE(ctx.out.empty());
+
+    timers.advance();
+    REQUIRE(ctx.out == "connection_timeout;");
+    REQUIRE(timers.armed_count() == 1);
+
+    timers.advance(20);
+    REQUIRE(machine.is<states::idle>());
+    REQUIRE(timers.armed_count() == 0);
+
+    //Exiting the state cancels the remaining timeouts
+    ctx.out.clear();
+    machine.process_event(events::connect{});
+    timers.advance(5);
+    machine.process_event(events::connection_success{});
+    REQUIRE(machine.is<states::session>());
+    REQUIRE(timers.armed_count() == 2);
+    timers.advance(50);
+    REQUIRE(machine.is<states::session>());
+    REQUIRE(ctx.out.empty());
+
+    //Reentering a state rearms its timeouts
+    machine.process_event(events::disconnect{});
+    machine.process_event(events::connect{});
+    machine.process_event(events::connection_success{});
+    timers.advance(4);
+    machine.process_event(events::heartbeat{});
+    timers.advance(4);
+    REQUIRE(session_state.is<states::waiting_for_heartbeat>());
+    timers.advance(1);
+    REQUIRE(session_state.is<states::alive>());
+
+    //Timeouts of composite states
+    timers.advance(90);
+    REQUIRE(ctx.out.empty());
+    timers.advance(1);
+    REQUIRE(ctx.out == "session_expiry:42;");
+    REQUIRE(machine.is<states::idle>());
+    REQUIRE(timers.armed_count() == 0);
+
+    //Exiting a composite state cancels the timeouts of its substates
+    machine.process_event(events::connect{});
+    machine.process_event(events::connection_success{});
+    REQUIRE(timers.armed_count() == 2);
+    machine.process_event(events::disconnect{});
+    REQUIRE(timers.armed_count() == 0);
+
+    //Stopping the machine cancels the timeouts
+    machine.process_event(events::connect{});
+    REQUIRE(timers.armed_count() == 2);
+    machine.stop();
+    REQUIRE(timers.armed_count() == 0);
+}
+
+TEST_CASE("state_timeout: destruction")
+{
+    using namespace state_timeout_ns;
+
+    auto timers = maki::timer_service{};
+
+    //Destroying the machine cancels the timeouts
+    {
+        auto machine = machine_t{timers};
+        machine.process_event(events::connect{});
+        REQUIRE(timers.armed_count() == 2);
+    }
+    REQUIRE(timers.armed_count() == 0);
+    timers.advance(100);
+
+    //The machine can outlive the timer service
+    auto machine = std::optional<machine_t>{};
+    {
+        auto other_timers = maki::timer_service{};
+        machine.emplace(other_timers);
+        machine->process_event(events::connect{});
+    }
+    machine->process_event(events::connection_abandonment{});
+    REQUIRE(machine->is<states::idle>());
+}
@@ -0,0 +1,111 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include <maki.hpp>
+#include "common.hpp"
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace
+{
+    using tick_count = maki::timer_service::tick_count;
+
+    struct fired_timer
+    {
+        std::size_t index;
+        tick_count time;
+    };
+
+    struct timer
+    {
+        maki::detail::timer_node node;
+        std::size_t index = 0;
+        maki::timer_service* pservice = nullptr;
+        std::vector<fired_timer>* pfired_timers = nullptr;
+    };
+
+    void on_timer_expiry(maki::detail::timer_node& node)
+    {
+        const auto& tmr = *static_cast<const timer*>(node.pobj);
+        tmr.pfired_timers->push_back({tmr.index, tmr.pservice->now()});
+    }
+
+    //A linear congruential generator, for reproducible delays
+    struct random_generator
+    {
+        tick_count operator()()
+        {
+            state = (state * 6364136223846793005U) + 1442695040888963407U;
+            return state >> 33U;
+        }
+
+        std::uint64_t state = 0;
+    };
+}
+
+TEST_CASE("timer_service")
+{
+    using access = maki::detail::timer_service_access;
+
+    constexpr auto timer_count = std::size_t{5000};
+
+    auto service = maki::timer_service{};
+    auto fired_timers = std::vector<fired_timer>{};
+    auto timers = std::vector<timer>(timer_count);
+    auto expected_expiries = std::vector<tick_count>(timer_count);
+    auto generate_random = random_generator{};
+
+    //Arm timers with delays spanning several levels of the wheel
+    service.advance(12345);
+    for(auto i = std::size_t{0}; i < timer_count; ++i)
+    {
+        auto& tmr = timers[i];
+        tmr.index = i;
+        tmr.pservice = &service;
+        tmr.pfired_timers = &fired_timers;
+        tmr.node.callback = &on_timer_expiry;
+        tmr.node.pobj = &tmr;
+
+        const auto delay = generate_random() % (tick_count{1} << (3 * (i % 7)));
+        access::arm(service, tmr.node, delay);
+        expected_expiries[i] = service.now() + (delay == 0 ? 1 : delay);
+    }
+    REQUIRE(service.armed_count() == timer_count);
+
+    //Cancel every third timer
+    for(auto i = std::size_t{0}; i < timer_count; i += 3)
+    {
+        access::cancel(timers[i].node);
+    }
+    REQUIRE(service.armed_count() == timer_count - ((timer_count + 2) / 3));
+
+    //Every other timer must fire at its expiry, in order of expiry
+    while(service.armed_count() != 0)
+    {
+        service.advance(generate_random() % 5000);
+    }
+
+    REQUIRE(fired_timers.size() == timer_count - ((timer_count + 2) / 3));
+    auto previous_time = tick_count{0};
+    for(const auto& fired: fired_timers)
+    {
+        REQUIRE(fired.index % 3 != 0);
+        REQUIRE(fired.time == expected_expiries[fired.index]);
+        REQUIRE(fired.time >= previous_time);
+        previous_time = fired.time;
+    }
+
+    //Rearming an armed timer moves it
+    fired_timers.clear();
+    access::arm(service, timers[1].node, 10);
+    access::arm(service, timers[1].node, 20);
+    REQUIRE(service.armed_count() == 1);
+    service.advance(19);
+    REQUIRE(fired_timers.empty());
+    service.advance(1);
+    REQUIRE(fired_timers.size() == 1);
+}
@@ -0,0 +1,148 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include <maki.hpp>
+#include "common.hpp"
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace tracing_ns
+{
+    struct context{};
+
+    namespace events
+    {
+        struct power_button_press{};
+        struct next{};
+    }
+
+    namespace states
+    {
+        constexpr auto off = maki::state_mold{}
+            .pretty_name("off")
+        ;
+
+        constexpr auto red = maki::state_mold{}
+            .pretty_name("red")
+        ;
+
+        constexpr auto green = maki::state_mold{}
+            .pretty_name("green")
+        ;
+
+        constexpr auto on_transition_table = maki::transition_table{}
+            (maki::ini, red)
+            (red,       green, maki::event<events::next>)
+        ;
+
+        constexpr auto on = maki::state_mold{}
+            .transition_tables(on_transition_table)
+            .pretty_name("on")
+        ;
+    }
+
+    constexpr auto transition_table = maki::transition_table{}
+        (maki::ini,   states::off)
+        (states::off, states::on,  maki::event<events::power_button_press>)
+        (states::on,  states::off, maki::event<events::power_button_press>)
+    ;
+
+    constexpr auto machine_conf = maki::machine_conf{}
+        .transition_tables(transition_table)
+        .context_a<context>()
+        .auto_start(false)
+        .tracing(true)
+    ;
+
+    using machine_t = maki::machine<machine_conf>;
+
+    std::string strip_timestamps(const std::string& str)
+    {
+        auto stripped = std::string{};
+        auto at_line_start = true;
+        auto in_timestamp = false;
+        for(const auto c: str)
+        {
+            if(at_line_start)
+            {
+                in_timestamp = true;
+                at_line_start = false;
+            }
+            if(in_timestamp)
+            {
+                if(c == ' ')
+                {
+                    in_timestamp = false;
+                }
+                continue;
+            }
+            stripped += c;
+            at_line_start = c == '\n';
+        }
+        return stripped;
+    }
+}
+
+TEST_CASE("tracing")
+{
+    using namespace tracing_ns;
+
+    auto& buffer = maki::trace_buffer::this_thread();
+    buffer.clear();
+
+    auto machine = machine_t{};
+    machine.set_trace_id(7);
+    machine.start();
+
+    machine.process_event(events::power_button_press{});
+    machine.process_event(events::next{});
+
+    //Runtime toggle
+    REQUIRE(machine.tracing_enabled());
+    machine.set_tracing_enabled(false);
+    machine.process_event(events::power_button_press{});
+    machine.set_tracing_enabled(true);
+    machine.process_event(events::power_button_press{});
+
+    const auto records = buffer.dump();
+    REQUIRE(records.size() == 9);
+    REQUIRE(buffer.written_count() == 9);
+    REQUIRE(records[0].machine_id == 7);
+    REQUIRE(records[0].source_state_index == maki::trace_record::none_index);
+    REQUIRE(records[0].timestamp <= records[8].timestamp);
+    REQUIRE(records[1].kind == maki::trace_record_kind::event);
+
+    auto decoder = maki::trace_decoder{};
+    decoder.add_machine<machine_t>(7);
+
+    const auto expected_output =
+        "machine#7 0: null -> off (start)\n"
+        "machine#7 event: power_button_press\n"
+        "machine#7 0: off -> on (power_button_press)\n"
+        "machine#7 0/on/0: null -> red (power_button_press)\n"
+        "machine#7 event: next\n"
+        "machine#7 0/on/0: red -> green (next)\n"
+        "machine#7 event: power_button_press\n"
+        "machine#7 0: off -> on (power_button_press)\n"
+        "machine#7 0/on/0: null -> red (power_button_press)\n"
+    ;
+    REQUIRE(strip_timestamps(decoder.decode(records)) == expected_output);
+
+    //Unknown machine
+    auto unknown_record = records[2];
+    unknown_record.machine_id = 8;
+    REQUIRE(strip_timestamps(decoder.decode(unknown_record) + "\n") == "machine#8 region#0: state#0 -> state#1 (event#2)\n");
+
+    //Dump round trip
+    auto stream = std::stringstream{};
+    maki::write_trace_dump(stream, records);
+    const auto read_records = maki::read_trace_dump(stream);
+    REQUIRE(decoder.decode(read_records) == decoder.decode(records));
+
+    buffer.clear();
+    REQUIRE(buffer.dump().empty());
+}
@@ -0,0 +1,121 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include <maki.hpp>
+#include "common.hpp"
+#include <array>
+#include <string>
+
+namespace typed_event_queues_ns
+{
+    struct context
+    {
+        std::string out;
+    };
+
+    namespace events
+    {
+        struct go{};
+        struct flush{};
+
+        struct small
+        {
+            int i = 0;
+        };
+
+        //Too large for the small object optimization
+        struct big
+        {
+            std::array<int, 16> numbers;
+        };
+
+        //Not handled by any state
+        struct unknown{};
+    }
+
+    namespace states
+    {
+        constexpr auto idle = maki::state_mold{};
+
+        constexpr auto busy = maki::state_mold{}
+            .defer<events::small>()
+            .defer<events::big>();
+
+        constexpr auto ready = maki::state_mold{}
+            .internal_action_ce<events::small>(
+                [](context& ctx, const events::small& event)
+                {
+                    ctx.out += "small" + std::to_string(event.i) + ";";
+                })
+            .internal_action_ce<events::big>(
+                [](context& ctx, const events::big& event)
+                {
+                    ctx.out += "big" + std::to_string(event.numbers[1]) + ";";
+                });
+    }
+
+    namespace actions
+    {
+        constexpr auto emit = maki::action_m(
+            [](auto& mach)
+            {
+                for(auto i = 0; i < 3; ++i)
+                {
+                    mach.process_event(events::small{i});
+                    mach.process_event(events::unknown{});
+                    mach.process_event(events::big{{0, i}});
+                }
+                mach.process_event(events::flush{});
+            });
+    }
+
+    constexpr auto transition_table = maki::transition_table{}
+        (maki::ini,     states::idle)
+        (states::idle,  states::busy,  maki::event<events::go>, actions::emit)
+        (states::busy,  states::ready, maki::event<events::flush>)
+        (states::ready, states::idle,  maki::event<events::flush>)
+    ;
+
+    template<bool TypedEventQueues>
+    constexpr auto machine_conf = maki::machine_conf{}
+        .transition_tables(transition_table)
+        .context_a<context>()
+        .typed_event_queues(TypedEventQueues)
+        .post_processing_hook_mep<events::unknown>(
+            [](auto& mach, const events::unknown& /*event*/, const bool /*processed*/)
+            {
+                mach.context().out += "unknown;";
+            })
+    ;
+
+    template<bool TypedEventQueues>
+    std::string run()
+    {
+        auto machine = maki::machine<machine_conf<TypedEventQueues>>{};
+        machine.process_event(events::go{});
+        machine.process_event(events::flush{});
+        REQUIRE(machine.template is<states::idle>());
+        return machine.context().out;
+    }
+}
+
+TEST_CASE("typed_event_queues")
+{
+    using namespace typed_event_queues_ns;
+
+    const auto expected_output = std::string
+    {
+        "unknown;"
+        "unknown;"
+        "unknown;"
+        "small0;big0;"
+        "small1;big1;"
+        "small2;big2;"
+    };
+
+    REQUIRE(run<false>() == expected_output);
+    REQUIRE(run<true>() == expected_output);
+}
@@ -0,0 +1,156 @@
+//Copyright Florian Goujeon 2021 - 2026.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#ifdef __cpp_impl_coroutine
+
+#include <maki.hpp>
+#include "common.hpp"
+#include <coroutine>
+#include <exception>
+#include <string>
+
+namespace until_ns
+{
+    struct context
+    {
+        std::string out;
+    };
+
+    namespace events
+    {
+        struct connect{};
+        struct disconnect{};
+        struct quit{};
+    }
+
+    namespace states
+    {
+        EMPTY_STATE(disconnected)
+
+        constexpr auto connected = maki::state_mold{}
+            .entry_action_c([](context& ctx)
+            {
+                ctx.out += "connected::entry;";
+            })
+        ;
+    }
+
+    constexpr auto transition_table = maki::transition_table{}
+        (maki::ini,           states::disconnected)
+        (states::disconnected, states::connected,    maki::event<events::connect>)
+        (states::connected,    states::disconnected, maki::event<events::disconnect>)
+        (states::disconnected, maki::fin,            maki::event<events::quit>)
+    ;
+
+    constexpr auto machine_conf = maki::machine_conf{}
+        .transition_tables(transition_table)
+        .context_a<context>()
+        .until_enabled(true)
+    ;
+
+    using machine_t = maki::machine<machine_conf>;
+
+    //A minimal coroutine type, whose frame is destroyed on completion
+    struct task
+    {
+        struct promise_type
+        {
+            task get_return_object()
+            {
+                return task{std::coroutine_handle<promise_type>::from_promise(*this)};
+            }
+
+            std::suspend_never initial_suspend() noexcept
+            {
+                return {};
+            }
+
+            std::suspend_never final_suspend() noexcept
+            {
+                return {};
+            }
+
+            void return_void()
+            {
+            }
+
+            void unhandled_exception()
+            {
+                std::terminate();
+            }
+        };
+
+        std::coroutine_handle<promise_type> handle;
+    };
+
+    task wait_for_connection(machine_t& mach, std::string& out)
+    {
+        out += "waiting;";
+        co_await mach.until<states::connected>();
+        out += "connected;";
+        co_await mach.until<states::connected>(); //Already connected
+        out += "still_connected;";
+        co_await mach.until<states::disconnected>();
+        out += "disconnected;";
+        co_await mach.until_completed();
+        out += "completed;";
+    }
+
+    task wait_for_completion(machine_t& mach, std::string& out)
+    {
+        co_await mach.until_completed();
+        out += "completed;";
+    }
+}
+
+TEST_CASE("until")
+{
+    using namespace until_ns;
+
+    auto machine = machine_t{};
+    auto& ctx = machine.context();
+
+    auto out = std::string{};
+    wait_for_connection(machine, out);
+    REQUIRE(out == "waiting;");
+
+    machine.process_event(events::connect{});
+    REQUIRE(ctx.out == "connected::entry;");
+    REQUIRE(out == "waiting;connected;still_connected;");
+
+    machine.process_event(events::disconnect{});
+    REQUIRE(out == "waiting;connected;still_connected;disconnected;");
+
+    machine.process_event(events::quit{});
+    REQUIRE(out == "waiting;connected;still_connected;disconnected;completed;");
+}
+
+TEST_CASE("until: stop and destroyed coroutine")
+{
+    using namespace until_ns;
+
+    auto machine = machine_t{};
+
+    //Resumed when the machine is stopped
+    auto out = std::string{};
+    wait_for_completion(machine, out);
+    REQUIRE(out.empty());
+
+    //Destroyed while suspended
+    auto other_out = std::string{};
+    const auto other_task = wait_for_connection(machine, other_out);
+    REQUIRE(other_out == "waiting;");
+    other_task.handle.destroy();
+
+    machine.stop();
+    REQUIRE(out == "completed;");
+
+    machine.start();
+    machine.process_event(events::connect{});
+    REQUIRE(other_out == "waiting;");
+}
+
+#endif